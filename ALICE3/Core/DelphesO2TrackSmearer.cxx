@@ -36,6 +36,11 @@
 
 #include "ALICE3/Core/DelphesO2TrackSmearer.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 namespace o2
 {
 namespace delphes
@@ -43,6 +48,57 @@ namespace delphes
 
 /*****************************************************************/
 
+TrackSmearer::~TrackSmearer()
+{
+  for (unsigned int ipdg = 0; ipdg < nLUTs; ++ipdg) {
+    unloadTable(ipdg);
+  }
+}
+
+/*****************************************************************/
+
+void TrackSmearer::unloadTable(int ipdg)
+{
+  delete mLUTHeader[ipdg];
+  mLUTHeader[ipdg] = nullptr;
+  mLUTEntry[ipdg] = nullptr;
+  std::vector<lutEntry_t>().swap(mLUTStorage[ipdg]);
+  if (mLUTMapping[ipdg]) {
+    munmap(mLUTMapping[ipdg], mLUTMappingSize[ipdg]);
+    mLUTMapping[ipdg] = nullptr;
+    mLUTMappingSize[ipdg] = 0;
+  }
+}
+
+/*****************************************************************/
+
+bool TrackSmearer::mapTable(int ipdg, const char* filename, size_t nEntries)
+{
+  // the entries follow the header in the file, aligned as in memory
+  static_assert(sizeof(lutHeader_t) % alignof(lutEntry_t) == 0, "LUT entries are not aligned after the header");
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat fileStat;
+  const size_t size = sizeof(lutHeader_t) + nEntries * sizeof(lutEntry_t);
+  if (fstat(fd, &fileStat) != 0 || static_cast<size_t>(fileStat.st_size) < size) {
+    close(fd);
+    return false;
+  }
+  void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    return false;
+  }
+  mLUTMapping[ipdg] = mapping;
+  mLUTMappingSize[ipdg] = size;
+  mLUTEntry[ipdg] = reinterpret_cast<const lutEntry_t*>(static_cast<const char*>(mapping) + sizeof(lutHeader_t));
+  return true;
+}
+
+/*****************************************************************/
+
 bool TrackSmearer::loadTable(int pdg, const char* filename, bool forceReload)
 {
   auto ipdg = getIndexPDG(pdg);
@@ -50,57 +106,45 @@ bool TrackSmearer::loadTable(int pdg, const char* filename, bool forceReload)
     std::cout << " --- LUT table for PDG " << pdg << " has been already loaded with index " << ipdg << std::endl;
     return false;
   }
+  unloadTable(ipdg);
   mLUTHeader[ipdg] = new lutHeader_t;
 
   std::ifstream lutFile(filename, std::ifstream::binary);
   if (!lutFile.is_open()) {
     std::cout << " --- cannot open covariance matrix file for PDG " << pdg << ": " << filename << std::endl;
-    delete mLUTHeader[ipdg];
-    mLUTHeader[ipdg] = nullptr;
+    unloadTable(ipdg);
     return false;
   }
   lutFile.read(reinterpret_cast<char*>(mLUTHeader[ipdg]), sizeof(lutHeader_t));
   if (lutFile.gcount() != sizeof(lutHeader_t)) {
     std::cout << " --- troubles reading covariance matrix header for PDG " << pdg << ": " << filename << std::endl;
-    delete mLUTHeader[ipdg];
-    mLUTHeader[ipdg] = nullptr;
+    unloadTable(ipdg);
     return false;
   }
   if (mLUTHeader[ipdg]->version != LUTCOVM_VERSION) {
     std::cout << " --- LUT header version mismatch: expected/detected = " << LUTCOVM_VERSION << "/" << mLUTHeader[ipdg]->version << std::endl;
-    delete mLUTHeader[ipdg];
-    mLUTHeader[ipdg] = nullptr;
+    unloadTable(ipdg);
     return false;
   }
   if (mLUTHeader[ipdg]->pdg != pdg) {
     std::cout << " --- LUT header PDG mismatch: expected/detected = " << pdg << "/" << mLUTHeader[ipdg]->pdg << std::endl;
-    delete mLUTHeader[ipdg];
-    mLUTHeader[ipdg] = nullptr;
+    unloadTable(ipdg);
     return false;
   }
-  const int nnch = mLUTHeader[ipdg]->nchmap.nbins;
-  const int nrad = mLUTHeader[ipdg]->radmap.nbins;
-  const int neta = mLUTHeader[ipdg]->etamap.nbins;
-  const int npt = mLUTHeader[ipdg]->ptmap.nbins;
-  mLUTEntry[ipdg] = new lutEntry_t****[nnch];
-  for (int inch = 0; inch < nnch; ++inch) {
-    mLUTEntry[ipdg][inch] = new lutEntry_t***[nrad];
-    for (int irad = 0; irad < nrad; ++irad) {
-      mLUTEntry[ipdg][inch][irad] = new lutEntry_t**[neta];
-      for (int ieta = 0; ieta < neta; ++ieta) {
-        mLUTEntry[ipdg][inch][irad][ieta] = new lutEntry_t*[npt];
-        for (int ipt = 0; ipt < npt; ++ipt) {
-          mLUTEntry[ipdg][inch][irad][ieta][ipt] = new lutEntry_t;
-          lutFile.read(reinterpret_cast<char*>(mLUTEntry[ipdg][inch][irad][ieta][ipt]), sizeof(lutEntry_t));
-          if (lutFile.gcount() != sizeof(lutEntry_t)) {
-            std::cout << " --- troubles reading covariance matrix entry for PDG " << pdg << ": " << filename << std::endl;
-            return false;
-          }
-        }
-      }
+  const size_t nEntries = static_cast<size_t>(mLUTHeader[ipdg]->nchmap.nbins) * mLUTHeader[ipdg]->radmap.nbins * mLUTHeader[ipdg]->etamap.nbins * mLUTHeader[ipdg]->ptmap.nbins;
+  if (mUseMemoryMapping && mapTable(ipdg, filename, nEntries)) {
+    std::cout << " --- mapped covariance matrix table for PDG " << pdg << ": " << filename << std::endl;
+  } else {
+    mLUTStorage[ipdg].resize(nEntries);
+    lutFile.read(reinterpret_cast<char*>(mLUTStorage[ipdg].data()), nEntries * sizeof(lutEntry_t));
+    if (static_cast<size_t>(lutFile.gcount()) != nEntries * sizeof(lutEntry_t)) {
+      std::cout << " --- troubles reading covariance matrix entry for PDG " << pdg << ": " << filename << std::endl;
+      unloadTable(ipdg);
+      return false;
     }
+    mLUTEntry[ipdg] = mLUTStorage[ipdg].data();
+    std::cout << " --- read covariance matrix table for PDG " << pdg << ": " << filename << std::endl;
   }
-  std::cout << " --- read covariance matrix table for PDG " << pdg << ": " << filename << std::endl;
   mLUTHeader[ipdg]->print();
 
   lutFile.close();
@@ -109,8 +153,8 @@ bool TrackSmearer::loadTable(int pdg, const char* filename, bool forceReload)
 
 /*****************************************************************/
 
-lutEntry_t*
-  TrackSmearer::getLUTEntry(int pdg, float nch, float radius, float eta, float pt, float& interpolatedEff)
+const lutEntry_t*
+  TrackSmearer::getLUTEntry(int pdg, float nch, float radius, float eta, float pt, float& interpolatedEff) const
 {
   auto ipdg = getIndexPDG(pdg);
   if (!mLUTHeader[ipdg])
@@ -119,6 +163,7 @@ lutEntry_t*
   auto irad = mLUTHeader[ipdg]->radmap.find(radius);
   auto ieta = mLUTHeader[ipdg]->etamap.find(eta);
   auto ipt = mLUTHeader[ipdg]->ptmap.find(pt);
+  const lutEntry_t* lutEntry = getEntry(ipdg, inch, irad, ieta, ipt);
 
   // Interpolate if requested
   auto fraction = mLUTHeader[ipdg]->nchmap.fracPositionWithinBin(nch);
@@ -126,47 +171,47 @@ lutEntry_t*
     if (fraction > 0.5) {
       if (mWhatEfficiency == 1) {
         if (inch < mLUTHeader[ipdg]->nchmap.nbins - 1) {
-          interpolatedEff = (1.5f - fraction) * mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff + (-0.5f + fraction) * mLUTEntry[ipdg][inch + 1][irad][ieta][ipt]->eff;
+          interpolatedEff = (1.5f - fraction) * lutEntry->eff + (-0.5f + fraction) * getEntry(ipdg, inch + 1, irad, ieta, ipt)->eff;
         } else {
-          interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff;
+          interpolatedEff = lutEntry->eff;
         }
       }
       if (mWhatEfficiency == 2) {
         if (inch < mLUTHeader[ipdg]->nchmap.nbins - 1) {
-          interpolatedEff = (1.5f - fraction) * mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff2 + (-0.5f + fraction) * mLUTEntry[ipdg][inch + 1][irad][ieta][ipt]->eff2;
+          interpolatedEff = (1.5f - fraction) * lutEntry->eff2 + (-0.5f + fraction) * getEntry(ipdg, inch + 1, irad, ieta, ipt)->eff2;
         } else {
-          interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff2;
+          interpolatedEff = lutEntry->eff2;
         }
       }
     } else {
       float comparisonValue = mLUTHeader[ipdg]->nchmap.log ? log10(nch) : nch;
       if (mWhatEfficiency == 1) {
         if (inch > 0 && comparisonValue < mLUTHeader[ipdg]->nchmap.max) {
-          interpolatedEff = (0.5f + fraction) * mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff + (0.5f - fraction) * mLUTEntry[ipdg][inch - 1][irad][ieta][ipt]->eff;
+          interpolatedEff = (0.5f + fraction) * lutEntry->eff + (0.5f - fraction) * getEntry(ipdg, inch - 1, irad, ieta, ipt)->eff;
         } else {
-          interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff;
+          interpolatedEff = lutEntry->eff;
         }
       }
       if (mWhatEfficiency == 2) {
         if (inch > 0 && comparisonValue < mLUTHeader[ipdg]->nchmap.max) {
-          interpolatedEff = (0.5f + fraction) * mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff2 + (0.5f - fraction) * mLUTEntry[ipdg][inch - 1][irad][ieta][ipt]->eff2;
+          interpolatedEff = (0.5f + fraction) * lutEntry->eff2 + (0.5f - fraction) * getEntry(ipdg, inch - 1, irad, ieta, ipt)->eff2;
         } else {
-          interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff2;
+          interpolatedEff = lutEntry->eff2;
         }
       }
     }
   } else {
     if (mWhatEfficiency == 1)
-      interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff;
+      interpolatedEff = lutEntry->eff;
     if (mWhatEfficiency == 2)
-      interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff2;
+      interpolatedEff = lutEntry->eff2;
   }
-  return mLUTEntry[ipdg][inch][irad][ieta][ipt];
+  return lutEntry;
 } //;
 
 /*****************************************************************/
 
-bool TrackSmearer::smearTrack(O2Track& o2track, lutEntry_t* lutEntry, float interpolatedEff)
+bool TrackSmearer::smearTrack(O2Track& o2track, const lutEntry_t* lutEntry, float interpolatedEff, TRandom& random)
 {
   bool isReconstructed = true;
   // generate efficiency
@@ -178,7 +223,7 @@ bool TrackSmearer::smearTrack(O2Track& o2track, lutEntry_t* lutEntry, float inte
       eff = lutEntry->eff2;
     if (mInterpolateEfficiency)
       eff = interpolatedEff;
-    if (gRandom->Uniform() > eff)
+    if (random.Uniform() > eff)
       isReconstructed = false;
   }
 
@@ -192,7 +237,7 @@ bool TrackSmearer::smearTrack(O2Track& o2track, lutEntry_t* lutEntry, float inte
     double val = 0.;
     for (int j = 0; j < 5; ++j)
       val += lutEntry->eigvec[j][i] * o2track.getParam(j);
-    params_[i] = gRandom->Gaus(val, sqrt(lutEntry->eigval[i]));
+    params_[i] = random.Gaus(val, sqrt(lutEntry->eigval[i]));
   }
   // transform back params vector
   for (int i = 0; i < 5; ++i) {
@@ -213,7 +258,7 @@ bool TrackSmearer::smearTrack(O2Track& o2track, lutEntry_t* lutEntry, float inte
 
 /*****************************************************************/
 
-bool TrackSmearer::smearTrack(O2Track& o2track, int pdg, float nch)
+bool TrackSmearer::smearTrack(O2Track& o2track, int pdg, float nch, TRandom& random)
 {
 
   auto pt = o2track.getPt();
@@ -225,7 +270,19 @@ bool TrackSmearer::smearTrack(O2Track& o2track, int pdg, float nch)
   auto lutEntry = getLUTEntry(pdg, nch, 0., eta, pt, interpolatedEff);
   if (!lutEntry || !lutEntry->valid)
     return false;
-  return smearTrack(o2track, lutEntry, interpolatedEff);
+  return smearTrack(o2track, lutEntry, interpolatedEff, random);
+}
+
+/*****************************************************************/
+
+int TrackSmearer::smearTracks(std::span<O2Track> tracks, std::span<const int> pdgs, float nch, std::span<uint8_t> isReconstructed, TRandom& random)
+{
+  int nReconstructed = 0;
+  for (size_t i = 0; i < tracks.size(); ++i) {
+    isReconstructed[i] = smearTrack(tracks[i], pdgs[i], nch, random);
+    nReconstructed += isReconstructed[i];
+  }
+  return nReconstructed;
 }
 
 /*****************************************************************/
@@ -27,6 +27,8 @@
 #include <map>
 #include <iostream>
 #include <fstream>
+#include <span>
+#include <vector>
 
 #include "TRandom.h"
 #include "ReconstructionDataFormats/Track.h"
@@ -168,24 +170,35 @@ namespace o2
 namespace delphes
 {
 
+/// The entries of a LUT are stored contiguously, in the order of the LUT file (nch, radius, eta, pt).
+/// The LUT files being the header followed by the entries, they are memory-mapped read-only by default,
+/// such that the entries are only read from disk when used and are shared by all the processes using them.
 class TrackSmearer
 {
 
  public:
   TrackSmearer() = default;
-  ~TrackSmearer() = default;
+  ~TrackSmearer();
+  TrackSmearer(const TrackSmearer&) = delete;
+  TrackSmearer& operator=(const TrackSmearer&) = delete;
 
   /** LUT methods **/
   bool loadTable(int pdg, const char* filename, bool forceReload = false);
+  void useMemoryMapping(bool val) { mUseMemoryMapping = val; }                //;
   void useEfficiency(bool val) { mUseEfficiency = val; }                      //;
   void interpolateEfficiency(bool val) { mInterpolateEfficiency = val; }      //;
   void skipUnreconstructed(bool val) { mSkipUnreconstructed = val; }          //;
   void setWhatEfficiency(int val) { mWhatEfficiency = val; }                  //;
   lutHeader_t* getLUTHeader(int pdg) { return mLUTHeader[getIndexPDG(pdg)]; } //;
-  lutEntry_t* getLUTEntry(int pdg, float nch, float radius, float eta, float pt, float& interpolatedEff);
+  const lutEntry_t* getLUTEntry(int pdg, float nch, float radius, float eta, float pt, float& interpolatedEff) const;
 
-  bool smearTrack(O2Track& o2track, lutEntry_t* lutEntry, float interpolatedEff);
-  bool smearTrack(O2Track& o2track, int pdg, float nch);
+  bool smearTrack(O2Track& o2track, const lutEntry_t* lutEntry, float interpolatedEff, TRandom& random);
+  bool smearTrack(O2Track& o2track, const lutEntry_t* lutEntry, float interpolatedEff) { return smearTrack(o2track, lutEntry, interpolatedEff, *gRandom); }
+  bool smearTrack(O2Track& o2track, int pdg, float nch, TRandom& random);
+  bool smearTrack(O2Track& o2track, int pdg, float nch) { return smearTrack(o2track, pdg, nch, *gRandom); }
+  /// Smears tracks[i] with the LUT of pdgs[i], as smearTrack(tracks[i], pdgs[i], nch, random) in the order of the tracks.
+  /// isReconstructed[i] is set to the return value, the number of reconstructed tracks is returned.
+  int smearTracks(std::span<O2Track> tracks, std::span<const int> pdgs, float nch, std::span<uint8_t> isReconstructed, TRandom& random);
   // bool smearTrack(Track& track, bool atDCA = true); // Only in DelphesO2
   double getPtRes(int pdg, float nch, float eta, float pt);
   double getEtaRes(int pdg, float nch, float eta, float pt);
@@ -193,7 +206,7 @@ class TrackSmearer
   double getAbsEtaRes(int pdg, float nch, float eta, float pt);
   double getEfficiency(int pdg, float nch, float eta, float pt);
 
-  int getIndexPDG(int pdg)
+  int getIndexPDG(int pdg) const
   {
     switch (abs(pdg)) {
       case 11:
@@ -222,12 +235,24 @@ class TrackSmearer
  protected:
   static constexpr unsigned int nLUTs = 8; // Number of LUT available
   lutHeader_t* mLUTHeader[nLUTs] = {nullptr};
-  lutEntry_t***** mLUTEntry[nLUTs] = {nullptr};
+  const lutEntry_t* mLUTEntry[nLUTs] = {nullptr}; // first entry, in mLUTStorage or in the mapped file
+  std::vector<lutEntry_t> mLUTStorage[nLUTs];     // entries read from the file
+  void* mLUTMapping[nLUTs] = {nullptr};           // mapped file
+  size_t mLUTMappingSize[nLUTs] = {0};
+  bool mUseMemoryMapping = true;
   bool mUseEfficiency = true;
   bool mInterpolateEfficiency = false;
   bool mSkipUnreconstructed = true; // don't smear tracks that are not reco'ed
   int mWhatEfficiency = 1;
   float mdNdEta = 1600.;
+
+  const lutEntry_t* getEntry(int ipdg, int inch, int irad, int ieta, int ipt) const
+  {
+    const lutHeader_t* header = mLUTHeader[ipdg];
+    return &mLUTEntry[ipdg][((inch * header->radmap.nbins + irad) * header->etamap.nbins + ieta) * header->ptmap.nbins + ipt];
+  }
+  bool mapTable(int ipdg, const char* filename, size_t nEntries);
+  void unloadTable(int ipdg);
 };
 
 } // namespace delphes
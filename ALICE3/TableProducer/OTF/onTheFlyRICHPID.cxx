@@ -13,8 +13,12 @@
 // Task to add a table of track parameters propagated to the primary vertex
 //
 
+#include <algorithm>
+#include <array>
 #include <utility>
 #include <cmath>
+#include <limits>
+#include <vector>
 
 #include <TPDGCode.h>
 
@@ -130,6 +134,20 @@ struct OnTheFlyRichPid {
   std::vector<float> theta_min;
   std::vector<float> theta_max;
 
+  // Response tables of the current configuration, filled by updateResponseTables()
+  static constexpr int kNHypotheses = 5;
+  static constexpr int kHypothesisPdg[kNHypotheses] = {kElectron, kMuonMinus, kPiPlus, kKPlus, kProton};
+  std::array<float, kNHypotheses> hypothesisMass2;       // squared mass of the hypotheses
+  std::array<float, kNHypotheses> hypothesisMinMomentum; // momentum above which the ring of the hypothesis is reconstructed
+  float mRefractiveIndex = 1.f;
+  std::vector<float> sectorEtaMin; // eta range of the sectors, sorted by increasing eta
+  std::vector<float> sectorEtaMax;
+  std::vector<float> sectorRadiusR; // radiator center of the sectors
+  std::vector<float> sectorRadiusZ;
+  std::vector<float> resolutionEta; // sampling of the ring angular resolution versus eta
+  std::vector<float> resolutionValue;
+  std::vector<float> resolutionSlope;
+
   // Update projective geometry
   void updateProjectiveParameters()
   {
@@ -208,6 +226,63 @@ struct OnTheFlyRichPid {
     }
   }
 
+  /// returns momentum above which a particle of given mass gives a reconstructed ring (see CherenkovAngle)
+  /// \param mass the mass of the particle
+  float minimumMomentum(float mass)
+  {
+    // Cherenkov threshold, then at least 3 detected photons on average: sin^2(angle) > 3 / (230 * thickness)
+    float cos2AngleMax = 1.f - 3.f / (230.f * bRichRadiatorThickness);
+    float n2 = mRefractiveIndex * mRefractiveIndex;
+    if (n2 * cos2AngleMax <= 1.f) {
+      return std::numeric_limits<float>::infinity();
+    }
+    return std::max(mass / std::sqrt(n2 - 1.f), mass / std::sqrt(n2 * cos2AngleMax - 1.f));
+  }
+
+  /// Update the per-configuration tables used in the track loop: eta ranges and radiator positions of
+  /// the sectors, ring angular resolution versus eta and minimum momentum of each mass hypothesis
+  void updateResponseTables()
+  {
+    mRefractiveIndex = bRichRefractiveIndex;
+    for (int i = 0; i < kNHypotheses; i++) {
+      float mass = pdg->GetParticle(kHypothesisPdg[i])->Mass();
+      hypothesisMass2[i] = mass * mass;
+      hypothesisMinMomentum[i] = minimumMomentum(mass);
+    }
+
+    // Sectors: polar range converted to eta (cot(polar) = sinh(eta)), empty sectors are skipped
+    std::vector<int> sectors;
+    for (int i = 0; i < mNumberSectors; i++) {
+      if (theta_min[i] > theta_max[i]) {
+        sectors.push_back(i);
+      }
+    }
+    auto polarToEta = [](float polar) { return -std::log(std::tan(0.5f * polar)); };
+    std::sort(sectors.begin(), sectors.end(), [&](int a, int b) { return theta_min[a] > theta_min[b]; });
+    sectorEtaMin.clear();
+    sectorEtaMax.clear();
+    sectorRadiusR.clear();
+    sectorRadiusZ.clear();
+    for (auto i : sectors) {
+      sectorEtaMin.push_back(polarToEta(theta_min[i]));
+      sectorEtaMax.push_back(polarToEta(theta_max[i]));
+      sectorRadiusR.push_back(rad_centers[i].X());
+      sectorRadiusZ.push_back(rad_centers[i].Z());
+    }
+
+    // Angular resolution (USE ANALYTICAL EXTRAPOLATION FOR BETTER RESULTS)
+    resolutionEta = {-2.000000, -1.909740, -1.731184, -1.552999, -1.375325, -1.198342, -1.022276, -0.847390, -0.673976, -0.502324, -0.332683, -0.165221, 0.000000, 0.165221, 0.332683, 0.502324, 0.673976, 0.847390, 1.022276, 1.198342, 1.375325, 1.552999, 1.731184, 1.909740, 2.000000};
+    if (bRichFlagAbsorbingWalls) {
+      resolutionValue = {0.0009165, 0.000977, 0.001098, 0.001198, 0.001301, 0.001370, 0.001465, 0.001492, 0.001498, 0.001480, 0.001406, 0.001315, 0.001241, 0.001325, 0.001424, 0.001474, 0.001480, 0.001487, 0.001484, 0.001404, 0.001273, 0.001197, 0.001062, 0.000965, 0.0009165};
+    } else {
+      resolutionValue = {0.0009165, 0.000977, 0.001095, 0.001198, 0.001300, 0.001369, 0.001468, 0.001523, 0.001501, 0.001426, 0.001299, 0.001167, 0.001092, 0.001179, 0.001308, 0.001407, 0.001491, 0.001508, 0.001488, 0.001404, 0.001273, 0.001196, 0.001061, 0.000965, 0.0009165};
+    }
+    resolutionSlope.resize(resolutionEta.size() - 1);
+    for (size_t i = 0; i < resolutionSlope.size(); i++) {
+      resolutionSlope[i] = (resolutionValue[i + 1] - resolutionValue[i]) / (resolutionEta[i + 1] - resolutionEta[i]);
+    }
+  }
+
   void init(o2::framework::InitContext& initContext)
   {
     pRandomNumberGenerator.SetSeed(0); // fully randomize
@@ -269,8 +344,15 @@ struct OnTheFlyRichPid {
       }
     }
 
-    // Update projective parameters
+    // Update projective parameters with the configured geometry
+    mNumberSectors = bRichNumberOfSectors;
+    mTileLength = bRichPhotodetectorOtherModuleLength;
+    mTileLengthCentral = bRichPhotodetectorCentralModuleHalfLength;
+    mProjectiveLengthInner = mTileLengthCentral;
+    mRadiusProjIn = bRichRadiatorInnerRadius;
+    mRadiusProjOut = bRichPhotodetectorOuterRadius;
     updateProjectiveParameters();
+    updateResponseTables();
   }
 
   /// Function to convert a McParticle into a perfect Track
@@ -305,7 +387,7 @@ struct OnTheFlyRichPid {
   /// \param track the input track
   /// \param radius the radius of the layer you're calculating the length to
   /// \param magneticField the magnetic field to use when propagating
-  bool checkMagfieldLimit(o2::track::TrackParCov track, float radius, float magneticField)
+  bool checkMagfieldLimit(o2::track::TrackParCov const& track, float radius, float magneticField)
   {
     o2::math_utils::CircleXYf_t trcCircle;
     float sna, csa;
@@ -326,19 +408,12 @@ struct OnTheFlyRichPid {
   /// \param eta the pseudorapidity of the tarck (assuming primary vertex at origin)
   float radiusRipple(float eta)
   {
-    float polar = 2.0 * std::atan(std::exp(-eta));
-    float i_sector = 0;
-    bool flag_sector = false;
-    for (int j_sec = 0; j_sec < mNumberSectors; j_sec++) {
-      if (polar > theta_max[j_sec] && polar < theta_min[j_sec]) {
-        flag_sector = true;
-        i_sector = j_sec;
-      }
-    }
-    if (flag_sector) {
-      float R_sec_rich = rad_centers[i_sector].X();
-      float z_sec_rich = rad_centers[i_sector].Z();
-      return (std::pow(R_sec_rich, 2) + std::pow(z_sec_rich, 2)) / (R_sec_rich + z_sec_rich / std::tan(polar));
+    // first sector ending above eta
+    int i_sector = std::upper_bound(sectorEtaMax.begin(), sectorEtaMax.end(), eta) - sectorEtaMax.begin();
+    if (i_sector < static_cast<int>(sectorEtaMax.size()) && eta > sectorEtaMin[i_sector]) {
+      float R_sec_rich = sectorRadiusR[i_sector];
+      float z_sec_rich = sectorRadiusZ[i_sector];
+      return (R_sec_rich * R_sec_rich + z_sec_rich * z_sec_rich) / (R_sec_rich + z_sec_rich * std::sinh(eta));
     } else {
       return error_value;
     }
@@ -368,64 +443,55 @@ struct OnTheFlyRichPid {
     }
   }
 
-  /// returns linear interpolation
-  /// \param x the eta we want the resolution for
-  /// \param x0 the closest smaller available eta
-  /// \param x1 the closest larger available eta
-  /// \param y0 the resolution corresponding to x0
-  /// \param y1 the resolution corresponding to x1
-  float interpolate(double x, double x0, double x1, double y0, double y1)
-  {
-    float y = y0 + ((y1 - y0) / (x1 - x0)) * (x - x0);
-    return y;
-  }
-
   /// returns angular resolution for considered track eta
   /// \param eta the pseudorapidity of the tarck (assuming primary vertex at origin)
   float AngularResolution(float eta)
   {
-    // Vectors for sampling (USE ANALYTICAL EXTRAPOLATION FOR BETTER RESULTS)
-    float eta_sampling[] = {-2.000000, -1.909740, -1.731184, -1.552999, -1.375325, -1.198342, -1.022276, -0.847390, -0.673976, -0.502324, -0.332683, -0.165221, 0.000000, 0.165221, 0.332683, 0.502324, 0.673976, 0.847390, 1.022276, 1.198342, 1.375325, 1.552999, 1.731184, 1.909740, 2.000000};
-    float res_ring_sampling_with_abs_walls[] = {0.0009165, 0.000977, 0.001098, 0.001198, 0.001301, 0.001370, 0.001465, 0.001492, 0.001498, 0.001480, 0.001406, 0.001315, 0.001241, 0.001325, 0.001424, 0.001474, 0.001480, 0.001487, 0.001484, 0.001404, 0.001273, 0.001197, 0.001062, 0.000965, 0.0009165};
-    float res_ring_sampling_without_abs_walls[] = {0.0009165, 0.000977, 0.001095, 0.001198, 0.001300, 0.001369, 0.001468, 0.001523, 0.001501, 0.001426, 0.001299, 0.001167, 0.001092, 0.001179, 0.001308, 0.001407, 0.001491, 0.001508, 0.001488, 0.001404, 0.001273, 0.001196, 0.001061, 0.000965, 0.0009165};
-    int size_res_vector = sizeof(eta_sampling) / sizeof(eta_sampling[0]);
-    // Use binary search to find the lower and upper indices
-    int lowerIndex = std::lower_bound(eta_sampling, eta_sampling + size_res_vector, eta) - eta_sampling - 1;
-    int upperIndex = lowerIndex + 1;
-    if (lowerIndex >= 0 && upperIndex < size_res_vector) {
-      // Resolution interpolation
-      if (bRichFlagAbsorbingWalls) {
-        float interpolatedResRing = interpolate(eta, eta_sampling[lowerIndex], eta_sampling[upperIndex], res_ring_sampling_with_abs_walls[lowerIndex], res_ring_sampling_with_abs_walls[upperIndex]);
-        // std::cout << "Interpolated y value: " << interpolatedY << std::endl;
-        return interpolatedResRing;
-      } else {
-        float interpolatedResRing = interpolate(eta, eta_sampling[lowerIndex], eta_sampling[upperIndex], res_ring_sampling_without_abs_walls[lowerIndex], res_ring_sampling_without_abs_walls[upperIndex]);
-        // std::cout << "Interpolated y value: " << interpolatedY << std::endl;
-        return interpolatedResRing;
-      }
+    // Use binary search to find the upper sampling point, then interpolate linearly
+    int upperIndex = std::lower_bound(resolutionEta.begin(), resolutionEta.end(), eta) - resolutionEta.begin();
+    if (upperIndex >= 1 && upperIndex < static_cast<int>(resolutionEta.size())) {
+      int lowerIndex = upperIndex - 1;
+      return resolutionValue[lowerIndex] + resolutionSlope[lowerIndex] * (eta - resolutionEta[lowerIndex]);
     } else {
-      // std::cout << "Unable to interpolate. Target x value is outside the range of available data." << std::endl;
+      // Unable to interpolate. Target eta value is outside the range of available data.
       return error_value;
     }
   }
 
-  /// returns track angular resolution
-  /// \param pt the transverse momentum of the tarck
-  /// \param eta the pseudorapidity of the tarck
-  /// \param track_pt_resolution the absolute resolution on pt
-  /// \param track_pt_resolution the absolute resolution on eta
-  /// \param mass the mass of the particle
-  /// \param refractive_index the refractive index of the radiator
-  double calculate_track_time_resolution_advanced(float pt, float eta, float track_pt_resolution, float track_eta_resolution, float mass, float refractive_index)
+  /// computes the expected angles and the Nsigmas of all mass hypotheses for one track
+  /// The loop over the hypotheses has no branches and uses the per-configuration tables only, so that it can be vectorised.
+  /// The track angular resolution follows from error propagation of the pt and eta resolutions on the Cherenkov angle.
+  /// \param momentum the momentum of the track
+  /// \param eta the pseudorapidity of the track
+  /// \param measuredAngle the measured Cherenkov angle
+  /// \param ringAngularResolution the angular resolution of the ring
+  /// \param ptResolutions the absolute resolution on pt, per hypothesis
+  /// \param etaResolutions the absolute resolution on eta, per hypothesis
+  /// \param expectedAngles the expected angles (error_value below threshold)
+  /// \param trackAngularResolutions the track angular resolutions
+  /// \param nSigmas the Nsigmas (error_value below threshold)
+  void computeNSigmas(float momentum, float eta, float measuredAngle, float ringAngularResolution, bool includeTrackAngularRes,
+                      const float* ptResolutions, const float* etaResolutions, float* expectedAngles, float* trackAngularResolutions, float* nSigmas)
   {
-    // Compute tracking contribution to timing using the error propagation formula
-    // Uses light speed in m/ps, magnetic field in T (*0.1 for conversion kGauss -> T)
-    double a0 = mass * mass;
-    double a1 = refractive_index;
-    double dtheta_on_dpt = a0 / (pt * std::sqrt(a0 + std::pow(pt * std::cosh(eta), 2)) * std::sqrt(std::pow(pt * std::cosh(eta), 2) * (std::pow(a1, 2) - 1.0) - a0));
-    double dtheta_on_deta = (a0 * std::tanh(eta)) / (std::sqrt(a0 + std::pow(pt * std::cosh(eta), 2)) * std::sqrt(std::pow(pt * std::cosh(eta), 2) * (std::pow(a1, 2) - 1.0) - a0));
-    double track_angular_resolution = std::hypot(std::fabs(dtheta_on_dpt) * track_pt_resolution, std::fabs(dtheta_on_deta) * track_eta_resolution);
-    return track_angular_resolution;
+    const float p2 = momentum * momentum;
+    const float inversePt = std::cosh(eta) / momentum;
+    const float tanhEta = std::tanh(eta);
+    const float n2Minus1 = mRefractiveIndex * mRefractiveIndex - 1.f;
+    const float ringVariance = ringAngularResolution * ringAngularResolution;
+    for (int i = 0; i < kNHypotheses; i++) {
+      const float energy = std::sqrt(p2 + hypothesisMass2[i]);
+      const bool aboveThreshold = momentum > hypothesisMinMomentum[i];
+      const float angle = std::acos(std::min(energy / (momentum * mRefractiveIndex), 1.f));
+      // d(angle)/d(pt) = m^2 / (pt * D), d(angle)/d(eta) = m^2 * tanh(eta) / D
+      const float denominator = energy * std::sqrt(std::max(p2 * n2Minus1 - hypothesisMass2[i], 0.f));
+      const float dPt = ptResolutions[i] * inversePt;
+      const float dEta = etaResolutions[i] * tanhEta;
+      const float trackAngularRes = hypothesisMass2[i] / denominator * std::sqrt(dPt * dPt + dEta * dEta);
+      const float totalAngularRes = includeTrackAngularRes ? std::sqrt(ringVariance + trackAngularRes * trackAngularRes) : ringAngularResolution;
+      expectedAngles[i] = aboveThreshold ? angle : error_value;
+      trackAngularResolutions[i] = trackAngularRes;
+      nSigmas[i] = aboveThreshold ? (angle - measuredAngle) / totalAngularRes : error_value;
+    }
   }
 
   void process(soa::Join<aod::Collisions, aod::McCollisionLabels>::iterator const& collision, soa::Join<aod::Tracks, aod::TracksCov, aod::McTrackLabels> const& tracks, aod::McParticles const&, aod::McCollisions const&)
@@ -510,52 +576,33 @@ struct OnTheFlyRichPid {
       }
 
       // Straight to Nsigma
-      float deltaThetaBarrelRich[5], nSigmaBarrelRich[5];
-      int lpdg_array[5] = {kElectron, kMuonMinus, kPiPlus, kKPlus, kProton};
-      float masses[5];
-
-      for (int ii = 0; ii < 5; ii++) {
-        nSigmaBarrelRich[ii] = error_value;
+      float expectedAngleBarrelRich[kNHypotheses], barrelTrackAngularReso[kNHypotheses], nSigmaBarrelRich[kNHypotheses];
+      std::fill(std::begin(nSigmaBarrelRich), std::end(nSigmaBarrelRich), error_value);
+      bool flagRingReconstructed = measuredAngleBarrelRich > error_value + 1. && barrelRICHAngularResolution > error_value + 1. && flagReachesRadiator;
+
+      // index of the true species among the hypotheses, -1 for other particles
+      int trueSpecies = -1;
+      for (int ii = 0; ii < kNHypotheses; ii++) {
+        if (std::abs(mcParticle.pdgCode()) == kHypothesisPdg[ii]) {
+          trueSpecies = ii;
+        }
+      }
 
-        auto pdgInfoThis = pdg->GetParticle(lpdg_array[ii]);
-        masses[ii] = pdgInfoThis->Mass();
-        float hypothesisAngleBarrelRich = CherenkovAngle(recoTrack.getP(), masses[ii]);
+      if (flagRingReconstructed) {
+        float momentum = recoTrack.getP();
+        float pseudorapidity = recoTrack.getEta();
+        float transverse_momentum = momentum / std::cosh(pseudorapidity);
 
-        // Evaluate total sigma (layer + tracking resolution)
-        float barrelTotalAngularReso = barrelRICHAngularResolution;
+        // Tracking resolutions (from the LUTs if requested, otherwise from the track covariance)
+        float pt_resolution[kNHypotheses] = {0.f}, eta_resolution[kNHypotheses] = {0.f};
         if (flagIncludeTrackAngularRes) {
-          double pt_resolution = std::pow(recoTrack.getP() / std::cosh(recoTrack.getEta()), 2) * std::sqrt(recoTrack.getSigma1Pt2());
-          double eta_resolution = std::fabs(std::sin(2.0 * std::atan(std::exp(-recoTrack.getEta())))) * std::sqrt(recoTrack.getSigmaTgl2());
-          if (flagRICHLoadDelphesLUTs) {
-            pt_resolution = mSmearer.getAbsPtRes(pdgInfoThis->PdgCode(), dNdEta, recoTrack.getEta(), recoTrack.getP() / std::cosh(recoTrack.getEta()));
-            eta_resolution = mSmearer.getAbsEtaRes(pdgInfoThis->PdgCode(), dNdEta, recoTrack.getEta(), recoTrack.getP() / std::cosh(recoTrack.getEta()));
-          }
-          // cout << endl <<  "Pt resolution: " << pt_resolution << ", Eta resolution: " << eta_resolution << endl << endl;
-          float barrelTrackAngularReso = calculate_track_time_resolution_advanced(recoTrack.getP() / std::cosh(recoTrack.getEta()), recoTrack.getEta(), pt_resolution, eta_resolution, masses[ii], bRichRefractiveIndex);
-          barrelTotalAngularReso = std::hypot(barrelRICHAngularResolution, barrelTrackAngularReso);
-          if (doQAplots && hypothesisAngleBarrelRich > error_value + 1. && measuredAngleBarrelRich > error_value + 1. && barrelRICHAngularResolution > error_value + 1. && flagReachesRadiator) {
-            float momentum = recoTrack.getP();
-            // float pseudorapidity = recoTrack.getEta();
-            // float transverse_momentum = momentum / std::cosh(pseudorapidity);
-            if (ii == 0 && std::fabs(mcParticle.pdgCode()) == pdg->GetParticle(lpdg_array[0])->PdgCode()) {
-              histos.fill(HIST("h2dBarrelAngularResTrackElecVsP"), momentum, 1000.0 * barrelTrackAngularReso);
-              histos.fill(HIST("h2dBarrelAngularResTotalElecVsP"), momentum, 1000.0 * barrelTotalAngularReso);
-            }
-            if (ii == 1 && std::fabs(mcParticle.pdgCode()) == pdg->GetParticle(lpdg_array[1])->PdgCode()) {
-              histos.fill(HIST("h2dBarrelAngularResTrackMuonVsP"), momentum, 1000.0 * barrelTrackAngularReso);
-              histos.fill(HIST("h2dBarrelAngularResTotalMuonVsP"), momentum, 1000.0 * barrelTotalAngularReso);
-            }
-            if (ii == 2 && std::fabs(mcParticle.pdgCode()) == pdg->GetParticle(lpdg_array[2])->PdgCode()) {
-              histos.fill(HIST("h2dBarrelAngularResTrackPionVsP"), momentum, 1000.0 * barrelTrackAngularReso);
-              histos.fill(HIST("h2dBarrelAngularResTotalPionVsP"), momentum, 1000.0 * barrelTotalAngularReso);
-            }
-            if (ii == 3 && std::fabs(mcParticle.pdgCode()) == pdg->GetParticle(lpdg_array[3])->PdgCode()) {
-              histos.fill(HIST("h2dBarrelAngularResTrackKaonVsP"), momentum, 1000.0 * barrelTrackAngularReso);
-              histos.fill(HIST("h2dBarrelAngularResTotalKaonVsP"), momentum, 1000.0 * barrelTotalAngularReso);
-            }
-            if (ii == 4 && std::fabs(mcParticle.pdgCode()) == pdg->GetParticle(lpdg_array[4])->PdgCode()) {
-              histos.fill(HIST("h2dBarrelAngularResTrackProtVsP"), momentum, 1000.0 * barrelTrackAngularReso);
-              histos.fill(HIST("h2dBarrelAngularResTotalProtVsP"), momentum, 1000.0 * barrelTotalAngularReso);
+          for (int ii = 0; ii < kNHypotheses; ii++) {
+            if (flagRICHLoadDelphesLUTs) {
+              pt_resolution[ii] = mSmearer.getAbsPtRes(kHypothesisPdg[ii], dNdEta, pseudorapidity, transverse_momentum);
+              eta_resolution[ii] = mSmearer.getAbsEtaRes(kHypothesisPdg[ii], dNdEta, pseudorapidity, transverse_momentum);
+            } else {
+              pt_resolution[ii] = transverse_momentum * transverse_momentum * std::sqrt(recoTrack.getSigma1Pt2());
+              eta_resolution[ii] = std::sqrt(recoTrack.getSigmaTgl2()) / std::cosh(pseudorapidity);
             }
           }
         }
@@ -563,9 +610,32 @@ struct OnTheFlyRichPid {
         /// DISCLAIMER: here tracking is accounted only for momentum value, but not for track parameters at impact point on the
         ///             RICH radiator, since exact resolution would require photon generation and transport to photodetector.
         ///             Effects are expected to be negligible (a few tenths of a milliradian) but further studies are required !
-        if (hypothesisAngleBarrelRich > error_value + 1. && measuredAngleBarrelRich > error_value + 1. && barrelRICHAngularResolution > error_value + 1. && flagReachesRadiator) {
-          deltaThetaBarrelRich[ii] = hypothesisAngleBarrelRich - measuredAngleBarrelRich;
-          nSigmaBarrelRich[ii] = deltaThetaBarrelRich[ii] / barrelTotalAngularReso;
+        computeNSigmas(momentum, pseudorapidity, measuredAngleBarrelRich, barrelRICHAngularResolution, flagIncludeTrackAngularRes,
+                       pt_resolution, eta_resolution, expectedAngleBarrelRich, barrelTrackAngularReso, nSigmaBarrelRich);
+
+        if (doQAplots && flagIncludeTrackAngularRes && trueSpecies >= 0 && expectedAngleBarrelRich[trueSpecies] > error_value + 1.) {
+          float trackAngularReso = barrelTrackAngularReso[trueSpecies];
+          float totalAngularReso = std::hypot(barrelRICHAngularResolution, trackAngularReso);
+          if (trueSpecies == 0) {
+            histos.fill(HIST("h2dBarrelAngularResTrackElecVsP"), momentum, 1000.0 * trackAngularReso);
+            histos.fill(HIST("h2dBarrelAngularResTotalElecVsP"), momentum, 1000.0 * totalAngularReso);
+          }
+          if (trueSpecies == 1) {
+            histos.fill(HIST("h2dBarrelAngularResTrackMuonVsP"), momentum, 1000.0 * trackAngularReso);
+            histos.fill(HIST("h2dBarrelAngularResTotalMuonVsP"), momentum, 1000.0 * totalAngularReso);
+          }
+          if (trueSpecies == 2) {
+            histos.fill(HIST("h2dBarrelAngularResTrackPionVsP"), momentum, 1000.0 * trackAngularReso);
+            histos.fill(HIST("h2dBarrelAngularResTotalPionVsP"), momentum, 1000.0 * totalAngularReso);
+          }
+          if (trueSpecies == 3) {
+            histos.fill(HIST("h2dBarrelAngularResTrackKaonVsP"), momentum, 1000.0 * trackAngularReso);
+            histos.fill(HIST("h2dBarrelAngularResTotalKaonVsP"), momentum, 1000.0 * totalAngularReso);
+          }
+          if (trueSpecies == 4) {
+            histos.fill(HIST("h2dBarrelAngularResTrackProtVsP"), momentum, 1000.0 * trackAngularReso);
+            histos.fill(HIST("h2dBarrelAngularResTotalProtVsP"), momentum, 1000.0 * totalAngularReso);
+          }
         }
       }
 
@@ -574,38 +644,38 @@ struct OnTheFlyRichPid {
         float momentum = recoTrack.getP();
         float barrelRichTheta = measuredAngleBarrelRich;
 
-        if (barrelRichTheta > error_value + 1. && barrelRICHAngularResolution > error_value + 1. && flagReachesRadiator) {
+        if (flagRingReconstructed) {
           histos.fill(HIST("h2dAngleVsMomentumBarrelRICH"), momentum, barrelRichTheta);
 
-          if (std::fabs(mcParticle.pdgCode()) == pdg->GetParticle(lpdg_array[0])->PdgCode()) {
+          if (trueSpecies == 0) {
             histos.fill(HIST("h2dBarrelNsigmaTrueElecVsElecHypothesis"), momentum, nSigmaBarrelRich[0]);
             histos.fill(HIST("h2dBarrelNsigmaTrueElecVsMuonHypothesis"), momentum, nSigmaBarrelRich[1]);
             histos.fill(HIST("h2dBarrelNsigmaTrueElecVsPionHypothesis"), momentum, nSigmaBarrelRich[2]);
             histos.fill(HIST("h2dBarrelNsigmaTrueElecVsKaonHypothesis"), momentum, nSigmaBarrelRich[3]);
             histos.fill(HIST("h2dBarrelNsigmaTrueElecVsProtHypothesis"), momentum, nSigmaBarrelRich[4]);
           }
-          if (std::fabs(mcParticle.pdgCode()) == pdg->GetParticle(lpdg_array[1])->PdgCode()) {
+          if (trueSpecies == 1) {
             histos.fill(HIST("h2dBarrelNsigmaTrueMuonVsElecHypothesis"), momentum, nSigmaBarrelRich[0]);
             histos.fill(HIST("h2dBarrelNsigmaTrueMuonVsMuonHypothesis"), momentum, nSigmaBarrelRich[1]);
             histos.fill(HIST("h2dBarrelNsigmaTrueMuonVsPionHypothesis"), momentum, nSigmaBarrelRich[2]);
             histos.fill(HIST("h2dBarrelNsigmaTrueMuonVsKaonHypothesis"), momentum, nSigmaBarrelRich[3]);
             histos.fill(HIST("h2dBarrelNsigmaTrueMuonVsProtHypothesis"), momentum, nSigmaBarrelRich[4]);
           }
-          if (std::fabs(mcParticle.pdgCode()) == pdg->GetParticle(lpdg_array[2])->PdgCode()) {
+          if (trueSpecies == 2) {
             histos.fill(HIST("h2dBarrelNsigmaTruePionVsElecHypothesis"), momentum, nSigmaBarrelRich[0]);
             histos.fill(HIST("h2dBarrelNsigmaTruePionVsMuonHypothesis"), momentum, nSigmaBarrelRich[1]);
             histos.fill(HIST("h2dBarrelNsigmaTruePionVsPionHypothesis"), momentum, nSigmaBarrelRich[2]);
             histos.fill(HIST("h2dBarrelNsigmaTruePionVsKaonHypothesis"), momentum, nSigmaBarrelRich[3]);
             histos.fill(HIST("h2dBarrelNsigmaTruePionVsProtHypothesis"), momentum, nSigmaBarrelRich[4]);
           }
-          if (std::fabs(mcParticle.pdgCode()) == pdg->GetParticle(lpdg_array[3])->PdgCode()) {
+          if (trueSpecies == 3) {
             histos.fill(HIST("h2dBarrelNsigmaTrueKaonVsElecHypothesis"), momentum, nSigmaBarrelRich[0]);
             histos.fill(HIST("h2dBarrelNsigmaTrueKaonVsMuonHypothesis"), momentum, nSigmaBarrelRich[1]);
             histos.fill(HIST("h2dBarrelNsigmaTrueKaonVsPionHypothesis"), momentum, nSigmaBarrelRich[2]);
             histos.fill(HIST("h2dBarrelNsigmaTrueKaonVsKaonHypothesis"), momentum, nSigmaBarrelRich[3]);
             histos.fill(HIST("h2dBarrelNsigmaTrueKaonVsProtHypothesis"), momentum, nSigmaBarrelRich[4]);
           }
-          if (std::fabs(mcParticle.pdgCode()) == pdg->GetParticle(lpdg_array[4])->PdgCode()) {
+          if (trueSpecies == 4) {
             histos.fill(HIST("h2dBarrelNsigmaTrueProtVsElecHypothesis"), momentum, nSigmaBarrelRich[0]);
             histos.fill(HIST("h2dBarrelNsigmaTrueProtVsMuonHypothesis"), momentum, nSigmaBarrelRich[1]);
             histos.fill(HIST("h2dBarrelNsigmaTrueProtVsPionHypothesis"), momentum, nSigmaBarrelRich[2]);
@@ -24,8 +24,10 @@
 ///
 
 #include <utility>
+#include <vector>
 
 #include <TGeoGlobalMagField.h>
+#include <TRandom2.h>
 
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/AnalysisTask.h"
@@ -42,6 +44,7 @@
 #include "SimulationDataFormat/InteractionSampler.h"
 #include "Field/MagneticField.h"
 
+#include "Common/Core/ParallelFor.h"
 #include "ALICE3/Core/DelphesO2TrackSmearer.h"
 #include "ALICE3/DataModel/collisionAlice3.h"
 #include "ALICE3/DataModel/tracksAlice3.h"
@@ -83,6 +86,10 @@ struct OnTheFlyTracker {
   Configurable<bool> doExtraQA{"doExtraQA", false, "do extra 2D QA plots"};
   Configurable<bool> extraQAwithoutDecayDaughters{"extraQAwithoutDecayDaughters", false, "remove decay daughters from qa plots (yes/no)"};
 
+  Configurable<int> nThreads{"nThreads", 1, "number of threads smearing the particles and propagating the tracks, 0 for the hardware concurrency"};
+  Configurable<int> chunkSize{"chunkSize", 256, "number of consecutive particles or tracks handed to a thread at once"};
+  Configurable<int> randomSeed{"randomSeed", 4357, "seed of the random streams of the particles, the output does not depend on the number of threads"};
+
   Configurable<std::string> lutEl{"lutEl", "lutCovm.el.dat", "LUT for electrons"};
   Configurable<std::string> lutMu{"lutMu", "lutCovm.mu.dat", "LUT for muons"};
   Configurable<std::string> lutPi{"lutPi", "lutCovm.pi.dat", "LUT for pions"};
@@ -128,13 +135,46 @@ struct OnTheFlyTracker {
   // Track smearer
   o2::delphes::DelphesO2TrackSmearer mSmearer;
 
-  // For processing and vertexing
+  // Particle to be converted into a track, and the resulting track
+  struct ParticleToTrack {
+    int64_t label;
+    int pdgCode;
+    int charge;
+    float vx, vy, vz;
+    float phi, eta, pt;
+    bool isDecayDaughter;
+    o2::track::TrackParCov track;
+    float simX; // before smearing
+    float time; // in us
+    bool reconstructed;
+  };
+  // DCA of a track to the primary vertex
+  struct TrackDCA {
+    float dcaXY = 1e+10;
+    float dcaZ = 1e+10;
+    float pt; // at the DCA
+    float x;  // at the DCA
+  };
+
+  // For processing and vertexing, reused for all the collisions
+  std::vector<ParticleToTrack> particlesToTrack;
   std::vector<TrackAlice3> tracksAlice3;
   std::vector<TrackAlice3> ghostTracksAlice3;
+  std::vector<TrackDCA> tracksDCAAlice3;
+  std::vector<TrackDCA> ghostTracksDCAAlice3;
   std::vector<o2::InteractionRecord> bcData;
+  std::vector<o2::MCCompLabel> lblTracks;
+  std::vector<o2::vertexing::PVertex> vertices;
+  std::vector<o2::vertexing::GIndex> vertexTrackIDs;
+  std::vector<o2::vertexing::V2TRef> v2tRefs;
+  std::vector<o2::MCEventLabel> lblVtx;
+  std::vector<o2::dataformats::GlobalTrackID> idxVec;
   o2::steer::InteractionSampler irSampler;
   o2::vertexing::PVertexer vertexer;
 
+  // one random generator per thread, seeded for each particle
+  std::vector<TRandom2> randomGenerators;
+
   void init(o2::framework::InitContext& initContext)
   {
     if (enableLUT) {
@@ -235,32 +275,119 @@ struct OnTheFlyTracker {
     vertexer.setValidateWithIR(kFALSE);
     vertexer.setBunchFilling(irSampler.getBunchFilling());
     vertexer.init();
+
+    randomGenerators.resize(o2::analysis::getNThreads(nThreads));
+    LOGF(info, "Particles will be smeared on %d thread(s)", static_cast<int>(randomGenerators.size()));
   }
 
   /// Function to convert a McParticle into a perfect Track
-  /// \param particle the particle to convert (mcParticle)
+  /// \param vx, vy, vz, phi, eta, pt, charge the kinematics of the particle (mcParticle)
   /// \param o2track the address of the resulting TrackParCov
-  template <typename McParticleType>
-  void convertMCParticleToO2Track(McParticleType& particle, o2::track::TrackParCov& o2track)
+  static void convertToO2Track(float vx, float vy, float vz, float phi, float eta, float pt, int charge, o2::track::TrackParCov& o2track)
   {
-    auto pdgInfo = pdgDB->GetParticle(particle.pdgCode());
-    int charge = 0;
-    if (pdgInfo != nullptr) {
-      charge = pdgInfo->Charge() / 3;
-    }
     std::array<float, 5> params;
     std::array<float, 15> covm = {0.};
     float s, c, x;
-    o2::math_utils::sincos(particle.phi(), s, c);
-    o2::math_utils::rotateZInv(particle.vx(), particle.vy(), x, params[0], s, c);
-    params[1] = particle.vz();
+    o2::math_utils::sincos(phi, s, c);
+    o2::math_utils::rotateZInv(vx, vy, x, params[0], s, c);
+    params[1] = vz;
     params[2] = 0.; // since alpha = phi
-    auto theta = 2. * std::atan(std::exp(-particle.eta()));
+    auto theta = 2. * std::atan(std::exp(-eta));
     params[3] = 1. / std::tan(theta);
-    params[4] = charge / particle.pt();
+    params[4] = charge / pt;
 
     // Initialize TrackParCov in-place
-    new (&o2track)(o2::track::TrackParCov)(x, particle.phi(), params, covm);
+    new (&o2track)(o2::track::TrackParCov)(x, phi, params, covm);
+  }
+
+  /// Seed of the random stream of a particle, such that the output does not depend on the threads
+  uint64_t getParticleSeed(int64_t mcCollisionIndex, int64_t particleIndex) const
+  {
+    // splitmix64 finaliser
+    uint64_t z = static_cast<uint64_t>(randomSeed.value) * 0x9e3779b97f4a7c15ULL + (static_cast<uint64_t>(mcCollisionIndex) << 32) + static_cast<uint64_t>(particleIndex);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z = z ^ (z >> 31);
+    return z | 1; // a zero seed would be drawn from the clock
+  }
+
+  /// Converts the particles into tracks and smears them, on the worker threads
+  void smearParticles(int64_t mcCollisionIndex, double collisionTimeNS)
+  {
+    o2::analysis::parallelForChunks(particlesToTrack.size(), nThreads, chunkSize, [&](int first, int last, int iThread) {
+      TRandom2& random = randomGenerators[iThread];
+      for (int i = first; i < last; i++) {
+        auto& particle = particlesToTrack[i];
+        random.SetSeed(getParticleSeed(mcCollisionIndex, particle.label));
+        convertToO2Track(particle.vx, particle.vy, particle.vz, particle.phi, particle.eta, particle.pt, particle.charge, particle.track);
+        particle.simX = particle.track.getX();
+        particle.reconstructed = mSmearer.smearTrack(particle.track, particle.pdgCode, dNdEta, random);
+        particle.time = (collisionTimeNS + random.Gaus(0., 100.)) * 1e-3;
+      }
+    });
+  }
+
+  /// Primary vertex of the reconstructed tracks
+  bool reconstructPrimaryVertex(aod::McCollision const& mcCollision, o2::vertexing::PVertex& primaryVertex)
+  {
+    lblTracks.clear();
+    vertices.clear();
+    vertexTrackIDs.clear();
+    v2tRefs.clear();
+    lblVtx.clear();
+    idxVec.clear();
+    lblVtx.emplace_back(mcCollision.globalIndex(), 1);
+
+    idxVec.reserve(tracksAlice3.size());
+    for (unsigned i = 0; i < tracksAlice3.size(); i++) {
+      lblTracks.emplace_back(tracksAlice3[i].mcLabel, mcCollision.globalIndex(), 1, false);
+      idxVec.emplace_back(i, o2::dataformats::GlobalTrackID::ITS); // let's say ITS
+    }
+
+    // Calculate vertices
+    const int n_vertices = vertexer.process(tracksAlice3, // track array
+                                            idxVec,
+                                            gsl::span<o2::InteractionRecord>{bcData},
+                                            vertices,
+                                            vertexTrackIDs,
+                                            v2tRefs,
+                                            gsl::span<const o2::MCCompLabel>{lblTracks},
+                                            lblVtx);
+
+    if (n_vertices < 1) {
+      return false; // primary vertex not reconstructed
+    }
+
+    // Find largest vertex
+    int largestVertex = 0;
+    for (Int_t iv = 1; iv < n_vertices; iv++) {
+      if (vertices[iv].getNContributors() > vertices[largestVertex].getNContributors()) {
+        largestVertex = iv;
+      }
+    }
+    primaryVertex = vertices[largestVertex];
+    if (doExtraQA) {
+      histos.fill(HIST("h2dVerticesVsContributors"), primaryVertex.getNContributors(), n_vertices);
+    }
+    return true;
+  }
+
+  /// DCAs of the tracks to the primary vertex, on the worker threads
+  void propagateToPrimaryVertex(std::vector<TrackAlice3> const& tracks, std::vector<TrackDCA>& dcas, o2::vertexing::PVertex const& primaryVertex)
+  {
+    dcas.assign(tracks.size(), TrackDCA{});
+    o2::analysis::parallelForChunks(tracks.size(), nThreads, chunkSize, [&](int first, int last, int) {
+      o2::dataformats::DCA dcaInfo;
+      for (int i = first; i < last; i++) {
+        o2::track::TrackParCov trackParametrization(tracks[i]);
+        if (trackParametrization.propagateToDCA(primaryVertex, magneticField, &dcaInfo)) {
+          dcas[i].dcaXY = dcaInfo.getY();
+          dcas[i].dcaZ = dcaInfo.getZ();
+        }
+        dcas[i].pt = trackParametrization.getPt();
+        dcas[i].x = trackParametrization.getX();
+      }
+    });
   }
 
   float dNdEta = 0.f; // Charged particle multiplicity to use in the efficiency evaluation
@@ -269,9 +396,7 @@ struct OnTheFlyTracker {
     tracksAlice3.clear();
     ghostTracksAlice3.clear();
     bcData.clear();
-
-    o2::dataformats::DCA dcaInfo;
-    o2::dataformats::VertexBase vtx;
+    particlesToTrack.clear();
 
     // generate collision time
     auto ir = irSampler.generateCollisionTime();
@@ -304,6 +429,8 @@ struct OnTheFlyTracker {
     uint32_t multiplicityCounter = 0;
     histos.fill(HIST("hLUTMultiplicity"), dNdEta);
 
+    // *+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*
+    // Select the particles to convert into tracks
     for (const auto& mcParticle : mcParticles) {
       if (!mcParticle.isPhysicalPrimary()) {
         continue;
@@ -335,15 +462,31 @@ struct OnTheFlyTracker {
         isDecayDaughter = true;
 
       multiplicityCounter++;
-      o2::track::TrackParCov trackParCov;
-      convertMCParticleToO2Track(mcParticle, trackParCov);
+      auto pdgInfo = pdgDB->GetParticle(mcParticle.pdgCode());
+      auto& particle = particlesToTrack.emplace_back();
+      particle.label = mcParticle.globalIndex();
+      particle.pdgCode = mcParticle.pdgCode();
+      particle.charge = pdgInfo != nullptr ? pdgInfo->Charge() / 3 : 0;
+      particle.vx = mcParticle.vx();
+      particle.vy = mcParticle.vy();
+      particle.vz = mcParticle.vz();
+      particle.phi = mcParticle.phi();
+      particle.eta = mcParticle.eta();
+      particle.pt = mcParticle.pt();
+      particle.isDecayDaughter = isDecayDaughter;
+    }
+
+    // *+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*
+    // Convert the particles into tracks and smear them
+    smearParticles(mcCollision.globalIndex(), ir.timeInBCNS);
 
+    for (const auto& particle : particlesToTrack) {
+      const auto& trackParCov = particle.track;
       if (doExtraQA) {
-        histos.fill(HIST("hSimTrackX"), trackParCov.getX());
+        histos.fill(HIST("hSimTrackX"), particle.simX);
       }
 
-      bool reconstructed = mSmearer.smearTrack(trackParCov, mcParticle.pdgCode(), dNdEta);
-      if (!reconstructed && !processUnreconstructedTracks) {
+      if (!particle.reconstructed && !processUnreconstructedTracks) {
         continue;
       }
       if (TMath::IsNaN(trackParCov.getZ())) {
@@ -353,76 +496,42 @@ struct OnTheFlyTracker {
 
       // Base QA (note: reco pT here)
       histos.fill(HIST("hPtReconstructed"), trackParCov.getPt());
-      if (TMath::Abs(mcParticle.pdgCode()) == 11)
-        histos.fill(HIST("hPtReconstructedEl"), mcParticle.pt());
-      if (TMath::Abs(mcParticle.pdgCode()) == 211)
-        histos.fill(HIST("hPtReconstructedPi"), mcParticle.pt());
-      if (TMath::Abs(mcParticle.pdgCode()) == 321)
-        histos.fill(HIST("hPtReconstructedKa"), mcParticle.pt());
-      if (TMath::Abs(mcParticle.pdgCode()) == 2212)
-        histos.fill(HIST("hPtReconstructedPr"), mcParticle.pt());
+      if (TMath::Abs(particle.pdgCode) == 11)
+        histos.fill(HIST("hPtReconstructedEl"), particle.pt);
+      if (TMath::Abs(particle.pdgCode) == 211)
+        histos.fill(HIST("hPtReconstructedPi"), particle.pt);
+      if (TMath::Abs(particle.pdgCode) == 321)
+        histos.fill(HIST("hPtReconstructedKa"), particle.pt);
+      if (TMath::Abs(particle.pdgCode) == 2212)
+        histos.fill(HIST("hPtReconstructedPr"), particle.pt);
 
       if (doExtraQA) {
         histos.fill(HIST("hRecoTrackX"), trackParCov.getX());
       }
 
       // populate vector with track if we reco-ed it
-      const float t = (ir.timeInBCNS + gRandom->Gaus(0., 100.)) * 1e-3;
-      if (reconstructed) {
-        tracksAlice3.push_back(TrackAlice3{trackParCov, mcParticle.globalIndex(), t, 100.f * 1e-3, isDecayDaughter});
+      if (particle.reconstructed) {
+        tracksAlice3.push_back(TrackAlice3{trackParCov, particle.label, particle.time, 100.f * 1e-3, particle.isDecayDaughter});
       } else {
-        ghostTracksAlice3.push_back(TrackAlice3{trackParCov, mcParticle.globalIndex(), t, 100.f * 1e-3, isDecayDaughter});
+        ghostTracksAlice3.push_back(TrackAlice3{trackParCov, particle.label, particle.time, 100.f * 1e-3, particle.isDecayDaughter});
       }
     }
 
     // *+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*
     // Calculate primary vertex with tracks from this collision
-    // data preparation
     o2::vertexing::PVertex primaryVertex;
 
     if (enablePrimaryVertexing) {
-      std::vector<o2::MCCompLabel> lblTracks;
-      std::vector<o2::vertexing::PVertex> vertices;
-      std::vector<o2::vertexing::GIndex> vertexTrackIDs;
-      std::vector<o2::vertexing::V2TRef> v2tRefs;
-      std::vector<o2::MCEventLabel> lblVtx;
-      lblVtx.emplace_back(mcCollision.globalIndex(), 1);
-      std::vector<o2::dataformats::GlobalTrackID> idxVec; // store IDs
-
-      idxVec.reserve(tracksAlice3.size());
-      for (unsigned i = 0; i < tracksAlice3.size(); i++) {
-        lblTracks.emplace_back(tracksAlice3[i].mcLabel, mcCollision.globalIndex(), 1, false);
-        idxVec.emplace_back(i, o2::dataformats::GlobalTrackID::ITS); // let's say ITS
-      }
-
-      // Calculate vertices
-      const int n_vertices = vertexer.process(tracksAlice3, // track array
-                                              idxVec,
-                                              gsl::span<o2::InteractionRecord>{bcData},
-                                              vertices,
-                                              vertexTrackIDs,
-                                              v2tRefs,
-                                              gsl::span<const o2::MCCompLabel>{lblTracks},
-                                              lblVtx);
-
-      if (n_vertices < 1) {
+      if (!reconstructPrimaryVertex(mcCollision, primaryVertex)) {
         return; // primary vertex not reconstructed
       }
-
-      // Find largest vertex
-      int largestVertex = 0;
-      for (Int_t iv = 1; iv < n_vertices; iv++) {
-        if (vertices[iv].getNContributors() > vertices[largestVertex].getNContributors()) {
-          largestVertex = iv;
-        }
-      }
-      primaryVertex = vertices[largestVertex];
-      if (doExtraQA) {
-        histos.fill(HIST("h2dVerticesVsContributors"), primaryVertex.getNContributors(), n_vertices);
-      }
     } else {
       primaryVertex.setXYZ(mcCollision.posX(), mcCollision.posY(), mcCollision.posZ());
     }
+    if (populateTracksDCA) {
+      propagateToPrimaryVertex(tracksAlice3, tracksDCAAlice3, primaryVertex);
+      propagateToPrimaryVertex(ghostTracksAlice3, ghostTracksDCAAlice3, primaryVertex);
+    }
     // *+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*
 
     // debug / informational
@@ -448,22 +557,18 @@ struct OnTheFlyTracker {
 
     // *+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*
     // populate tracks
-    for (const auto& trackParCov : tracksAlice3) {
+    for (size_t iTrack = 0; iTrack < tracksAlice3.size(); iTrack++) {
+      const auto& trackParCov = tracksAlice3[iTrack];
       // Fixme: collision index could be changeable
       aod::track::TrackTypeEnum trackType = aod::track::Track;
 
       if (populateTracksDCA) {
-        float dcaXY = 1e+10, dcaZ = 1e+10;
-        o2::track::TrackParCov trackParametrization(trackParCov);
-        if (trackParametrization.propagateToDCA(primaryVertex, magneticField, &dcaInfo)) {
-          dcaXY = dcaInfo.getY();
-          dcaZ = dcaInfo.getZ();
-        }
+        const auto& dca = tracksDCAAlice3[iTrack];
         if (doExtraQA && (!extraQAwithoutDecayDaughters || (extraQAwithoutDecayDaughters && !trackParCov.isDecayDau))) {
-          histos.fill(HIST("h2dDCAxy"), trackParametrization.getPt(), dcaXY * 1e+4); // in microns, please
-          histos.fill(HIST("hTrackXatDCA"), trackParametrization.getX());
+          histos.fill(HIST("h2dDCAxy"), dca.pt, dca.dcaXY * 1e+4); // in microns, please
+          histos.fill(HIST("hTrackXatDCA"), dca.x);
         }
-        tracksDCA(dcaXY, dcaZ);
+        tracksDCA(dca.dcaXY, dca.dcaZ);
       }
 
       tracksPar(collisions.lastIndex(), trackType, trackParCov.getX(), trackParCov.getAlpha(), trackParCov.getY(), trackParCov.getZ(), trackParCov.getSnp(), trackParCov.getTgl(), trackParCov.getQ2Pt());
@@ -492,22 +597,18 @@ struct OnTheFlyTracker {
       TracksAlice3(true);
     }
     // populate ghost tracks
-    for (const auto& trackParCov : ghostTracksAlice3) {
+    for (size_t iTrack = 0; iTrack < ghostTracksAlice3.size(); iTrack++) {
+      const auto& trackParCov = ghostTracksAlice3[iTrack];
       // Fixme: collision index could be changeable
       aod::track::TrackTypeEnum trackType = aod::track::Track;
 
       if (populateTracksDCA) {
-        float dcaXY = 1e+10, dcaZ = 1e+10;
-        o2::track::TrackParCov trackParametrization(trackParCov);
-        if (trackParametrization.propagateToDCA(primaryVertex, magneticField, &dcaInfo)) {
-          dcaXY = dcaInfo.getY();
-          dcaZ = dcaInfo.getZ();
-        }
+        const auto& dca = ghostTracksDCAAlice3[iTrack];
         if (doExtraQA && (!extraQAwithoutDecayDaughters || (extraQAwithoutDecayDaughters && !trackParCov.isDecayDau))) {
-          histos.fill(HIST("h2dDCAxy"), trackParametrization.getPt(), dcaXY * 1e+4); // in microns, please
-          histos.fill(HIST("hTrackXatDCA"), trackParametrization.getX());
+          histos.fill(HIST("h2dDCAxy"), dca.pt, dca.dcaXY * 1e+4); // in microns, please
+          histos.fill(HIST("hTrackXatDCA"), dca.x);
         }
-        tracksDCA(dcaXY, dcaZ);
+        tracksDCA(dca.dcaXY, dca.dcaZ);
       }
 
       tracksPar(collisions.lastIndex(), trackType, trackParCov.getX(), trackParCov.getAlpha(), trackParCov.getY(), trackParCov.getZ(), trackParCov.getSnp(), trackParCov.getTgl(), trackParCov.getQ2Pt());
@@ -20,8 +20,9 @@
 #ifndef COMMON_CORE_COLLISIONASSOCIATION_H_
 #define COMMON_CORE_COLLISIONASSOCIATION_H_
 
+#include <algorithm>
+#include <cstdint>
 #include <vector>
-#include <memory>
 #include <utility>
 
 #include "CommonConstants/LHCConstants.h"
@@ -125,172 +126,185 @@ class CollisionAssociation
                         Assoc& association,
                         RevIndices& reverseIndices)
   {
-    // cache globalBC and track time in BC for optimization
-    std::vector<int64_t> globalBC;
-    std::vector<int64_t> trackBCCache;
-    std::vector<std::pair<typename TTracks::iterator, typename TTracks::iterator>> trackIterationWindows; // continous regions in which we can count on increasing globalBC numbers
-    globalBC.reserve(tracks.size());
-    trackBCCache.reserve(tracks.size());
-    auto trackBegin = tracks.begin();
-    int lastCollisionId = 0;
-    if (tracks.size() > 0) {
-      lastCollisionId = trackBegin.collisionId();
+    // BC of the unassigned tracks, from the first ambiguous track entry pointing to them (-2: no entry)
+    std::vector<int64_t> ambiguousTrackBC;
+    if (mIncludeUnassigned) {
+      ambiguousTrackBC.assign(tracksUnfiltered.size(), -2);
+      for (const auto& ambTrack : ambiguousTracks) {
+        int64_t trackId = -1;
+        if constexpr (isCentralBarrel) { // FIXME: to be removed as soon as it is possible to use getId<Table>() for joined tables
+          trackId = ambTrack.trackId();
+        } else {
+          trackId = ambTrack.template getId<TTracks>();
+        }
+        if (trackId < 0 || trackId >= static_cast<int64_t>(ambiguousTrackBC.size()) || ambiguousTrackBC[trackId] != -2) {
+          continue;
+        }
+        if constexpr (isCentralBarrel) {
+          ambiguousTrackBC[trackId] = (!ambTrack.has_bc() || ambTrack.bc().size() == 0) ? -1 : static_cast<int64_t>(ambTrack.bc().begin().globalBC());
+        } else {
+          ambiguousTrackBC[trackId] = ambTrack.bc().begin().globalBC();
+        }
+      }
     }
-    auto track = trackBegin;
-    for (; track != tracks.end(); ++track) {
+
+    // cache the time information of the tracks with a BC in flat arrays, sorted by the BC of the track time
+    const int64_t bcOffsetMax = mBcWindowForOneSigma * mNumSigmaForTimeCompat + mTimeMargin / o2::constants::lhc::LHCBunchSpacingNS;
+    std::vector<TrackTimeInfo> trackInfos;
+    trackInfos.reserve(tracks.size());
+    for (const auto& track : tracks) {
       int64_t trackBC = -1;
       if (track.has_collision()) {
         trackBC = track.collision().bc().globalBC();
-      } else if (mIncludeUnassigned) {
-        for (const auto& ambTrack : ambiguousTracks) {
-          if constexpr (isCentralBarrel) { // FIXME: to be removed as soon as it is possible to use getId<Table>() for joined tables
-            if (ambTrack.trackId() == track.globalIndex()) {
-              if (!ambTrack.has_bc() || ambTrack.bc().size() == 0) {
-                break;
-              }
-              trackBC = ambTrack.bc().begin().globalBC();
-              break;
-            }
-          } else {
-            if (ambTrack.template getId<TTracks>() == track.globalIndex()) {
-              trackBC = ambTrack.bc().begin().globalBC();
-              break;
-            }
-          }
-        }
+      } else if (mIncludeUnassigned && track.globalIndex() < static_cast<int64_t>(ambiguousTrackBC.size())) {
+        trackBC = std::max<int64_t>(ambiguousTrackBC[track.globalIndex()], -1);
       }
-      globalBC.push_back(trackBC);
-      trackBCCache.push_back(trackBC + track.trackTime() / o2::constants::lhc::LHCBunchSpacingNS);
-      // find uniform blocks
-      if ((track.collisionId() < lastCollisionId) || (lastCollisionId < 0 && track.collisionId() >= 0)) {
-        if (lastCollisionId >= 0 || mIncludeUnassigned) {
-          LOGP(debug, "Found track block from {} to {}, current id {}, last id {}", trackBegin.filteredIndex(), track.filteredIndex() - 1, track.collisionId(), lastCollisionId);
-          trackIterationWindows.push_back(std::make_pair(trackBegin, track));
+      if (trackBC < 0) {
+        continue;
+      }
+
+      TrackTimeInfo info;
+      info.bcForWindow = static_cast<int64_t>(trackBC + track.trackTime() / o2::constants::lhc::LHCBunchSpacingNS);
+      info.bc = trackBC;
+      info.filteredIndex = track.filteredIndex();
+      info.globalIndex = track.globalIndex();
+      info.time = track.trackTime();
+      info.timeRes = track.trackTimeRes();
+      if constexpr (isCentralBarrel) {
+        if (mUsePvAssociation && track.isPVContributor()) {
+          info.time = track.collision().collisionTime();        // if PV contributor, we assume the time to be the one of the collision
+          info.timeRes = o2::constants::lhc::LHCBunchSpacingNS; // 1 BC
+          info.resolution = TimeResolution::Fixed;
+        } else if (TESTBIT(track.flags(), o2::aod::track::TrackTimeResIsRange)) {
+          // the track time resolution is a range, not a gaussian resolution
+          info.resolution = TimeResolution::Range;
+        } else {
+          info.resolution = TimeResolution::Gaussian;
+        }
+      } else {
+        // the track is not a central track
+        if constexpr (TTracks::template contains<o2::aod::MFTTracks>()) {
+          // then the track is an MFT track, or an MFT track with additionnal joined info
+          // in this case TrackTimeResIsRange
+          info.resolution = TimeResolution::Range;
+        } else if constexpr (TTracks::template contains<o2::aod::FwdTracks>()) {
+          // the track is a fwd track, with a gaussian time resolution
+          info.resolution = TimeResolution::Gaussian;
         }
-        trackBegin = track;
       }
-      lastCollisionId = track.collisionId();
-    }
-    // trackIterationWindows.push_back(std::make_pair(trackBegin, tracks.end()));
-    if (lastCollisionId >= 0 || mIncludeUnassigned) {
-      LOGP(debug, "Found track block from {} to {}", trackBegin.filteredIndex(), tracks.size() - 1);
-      trackIterationWindows.push_back(std::make_pair(trackBegin, track));
+      trackInfos.push_back(info);
     }
+    std::sort(trackInfos.begin(), trackInfos.end(), [](const TrackTimeInfo& a, const TrackTimeInfo& b) {
+      return a.bcForWindow < b.bcForWindow || (a.bcForWindow == b.bcForWindow && a.filteredIndex < b.filteredIndex);
+    });
+    LOGP(debug, "{} out of {} tracks with a BC for the time association", trackInfos.size(), tracks.size());
 
-    // define vector of vectors to store indices of compatible collisions per track
-    std::vector<std::unique_ptr<std::vector<int>>> collsPerTrack(tracksUnfiltered.size());
+    // compatible pairs, kept in the order of the association table to build the reverse index
+    std::vector<std::pair<int, int>> compatiblePairs;
+    // tracks compatible with the current collision, as (filtered index, global index)
+    std::vector<std::pair<int64_t, int64_t>> compatibleTracks;
 
-    // loop over collisions to find time-compatible tracks
-    int64_t bcOffsetMax = mBcWindowForOneSigma * mNumSigmaForTimeCompat + mTimeMargin / o2::constants::lhc::LHCBunchSpacingNS;
+    // sweep over the collisions: the window of tracks within bcOffsetMax only moves forward for collisions sorted in BC
+    auto windowBegin = trackInfos.begin();
+    int64_t lastCollBC = -1;
     for (const auto& collision : collisions) {
       const float collTime = collision.collisionTime();
       const float collTimeRes2 = collision.collisionTimeRes() * collision.collisionTimeRes();
-      uint64_t collBC = collision.bc().globalBC();
-
-      // This is done per block to allow optimization below. Within each block the globalBC increase continously
-      for (auto& iterationWindow : trackIterationWindows) {
-        bool iteratorMoved = false;
-        const bool isAssignedTrackWindow = (iterationWindow.first != iterationWindow.second) ? iterationWindow.first.has_collision() : false;
-        for (auto track = iterationWindow.first; track != iterationWindow.second; ++track) {
-          int64_t trackBC = globalBC[track.filteredIndex()];
-          if (trackBC < 0) {
-            continue;
-          }
-
-          // Optimization to avoid looping over the full track list each time. This builds on that tracks are sorted by BCs (which they should be because collisions are sorted by BCs)
-          const int64_t bcOffset = trackBC - (int64_t)collBC;
-          if constexpr (isCentralBarrel) {
-            // only for blocks with collision association
-            if (isAssignedTrackWindow) {
-              constexpr int margin = 200;
-              if (!iteratorMoved && bcOffset > -bcOffsetMax - margin) {
-                iterationWindow.first.setCursor(track.filteredIndex());
-                iteratorMoved = true;
-                LOGP(debug, "Moving iterator begin {}", track.filteredIndex());
-              } else if (bcOffset > bcOffsetMax + margin) {
-                LOGP(debug, "Stopping iterator {}", track.filteredIndex());
-                break;
-              }
-            }
-          }
+      const int64_t collBC = collision.bc().globalBC();
 
-          int64_t bcOffsetWindow = trackBCCache[track.filteredIndex()] - (int64_t)collBC;
-          if (std::abs(bcOffsetWindow) > bcOffsetMax) {
-            continue;
-          }
+      if (collBC < lastCollBC) {
+        // collisions not sorted in BC: search the window from the beginning
+        windowBegin = trackInfos.begin();
+      }
+      lastCollBC = collBC;
+      while (windowBegin != trackInfos.end() && windowBegin->bcForWindow - collBC < -bcOffsetMax) {
+        ++windowBegin;
+      }
 
-          float trackTime = 0;
-          float trackTimeRes = 0;
-          if constexpr (isCentralBarrel) {
-            if (mUsePvAssociation && track.isPVContributor()) {
-              trackTime = track.collision().collisionTime();        // if PV contributor, we assume the time to be the one of the collision
-              trackTimeRes = o2::constants::lhc::LHCBunchSpacingNS; // 1 BC
-            } else {
-              trackTime = track.trackTime();
-              trackTimeRes = track.trackTimeRes();
-            }
-          } else {
-            trackTime = track.trackTime();
-            trackTimeRes = track.trackTimeRes();
-          }
+      compatibleTracks.clear();
+      for (auto info = windowBegin; info != trackInfos.end() && info->bcForWindow - collBC <= bcOffsetMax; ++info) {
+        const int64_t bcOffset = info->bc - collBC;
+        const float deltaTime = info->time - collTime + bcOffset * o2::constants::lhc::LHCBunchSpacingNS;
+        float sigmaTimeRes2 = collTimeRes2 + info->timeRes * info->timeRes;
+        LOGP(debug, "collision time={}, collision time res={}, track time={}, track time res={}, bc collision={}, bc track={}, delta time={}", collTime, collision.collisionTimeRes(), info->time, info->timeRes, collBC, info->bc, deltaTime);
 
-          const float deltaTime = trackTime - collTime + bcOffset * o2::constants::lhc::LHCBunchSpacingNS;
-          float sigmaTimeRes2 = collTimeRes2 + trackTimeRes * trackTimeRes;
-          LOGP(debug, "collision time={}, collision time res={}, track time={}, track time res={}, bc collision={}, bc track={}, delta time={}", collTime, collision.collisionTimeRes(), track.trackTime(), track.trackTimeRes(), collBC, trackBC, deltaTime);
+        float thresholdTime = 0.;
+        switch (info->resolution) {
+          case TimeResolution::Fixed:
+            thresholdTime = info->timeRes;
+            break;
+          case TimeResolution::Range:
+            thresholdTime = info->timeRes + mNumSigmaForTimeCompat * std::sqrt(collTimeRes2) + mTimeMargin;
+            break;
+          case TimeResolution::Gaussian:
+            thresholdTime = mNumSigmaForTimeCompat * std::sqrt(sigmaTimeRes2) + mTimeMargin;
+            break;
+          default:
+            break;
+        }
 
-          float thresholdTime = 0.;
-          if constexpr (isCentralBarrel) {
-            if (mUsePvAssociation && track.isPVContributor()) {
-              thresholdTime = trackTimeRes;
-            } else if (TESTBIT(track.flags(), o2::aod::track::TrackTimeResIsRange)) {
-              // the track time resolution is a range, not a gaussian resolution
-              thresholdTime = trackTimeRes + mNumSigmaForTimeCompat * std::sqrt(collTimeRes2) + mTimeMargin;
-            } else {
-              thresholdTime = mNumSigmaForTimeCompat * std::sqrt(sigmaTimeRes2) + mTimeMargin;
-            }
-          } else {
-            // the track is not a central track
-            if constexpr (TTracks::template contains<o2::aod::MFTTracks>()) {
-              // then the track is an MFT track, or an MFT track with additionnal joined info
-              // in this case TrackTimeResIsRange
-              thresholdTime = trackTimeRes + mNumSigmaForTimeCompat * std::sqrt(collTimeRes2) + mTimeMargin;
-            } else if constexpr (TTracks::template contains<o2::aod::FwdTracks>()) {
-              // the track is a fwd track, with a gaussian time resolution
-              thresholdTime = mNumSigmaForTimeCompat * std::sqrt(sigmaTimeRes2) + mTimeMargin;
-            }
-          }
+        if (std::abs(deltaTime) < thresholdTime) {
+          compatibleTracks.emplace_back(info->filteredIndex, info->globalIndex);
+        }
+      }
 
-          if (std::abs(deltaTime) < thresholdTime) {
-            const auto collIdx = collision.globalIndex();
-            const auto trackIdx = track.globalIndex();
-            LOGP(debug, "Filling track id {} for coll id {}", trackIdx, collIdx);
-            association(collIdx, trackIdx);
-            if (mFillTableOfCollIdsPerTrack) {
-              if (collsPerTrack[trackIdx] == nullptr) {
-                collsPerTrack[trackIdx] = std::make_unique<std::vector<int>>();
-              }
-              collsPerTrack[trackIdx].get()->push_back(collIdx);
-            }
-          }
+      // the tracks of a collision are associated in the order of the track table
+      std::sort(compatibleTracks.begin(), compatibleTracks.end());
+      const auto collIdx = collision.globalIndex();
+      for (const auto& [filteredIndex, trackIdx] : compatibleTracks) {
+        LOGP(debug, "Filling track id {} for coll id {}", trackIdx, collIdx);
+        association(collIdx, trackIdx);
+        if (mFillTableOfCollIdsPerTrack) {
+          compatiblePairs.emplace_back(trackIdx, collIdx);
         }
       }
     }
+
     // create reverse index track to collisions if enabled
     if (mFillTableOfCollIdsPerTrack) {
-      std::vector<int> empty{};
-      for (const auto& track : tracksUnfiltered) {
+      // compatible collisions per track in CSR format: the collisions of track i are collIds[offsets[i]] ... collIds[offsets[i + 1] - 1]
+      std::vector<int> offsets(tracksUnfiltered.size() + 1, 0);
+      for (const auto& pair : compatiblePairs) {
+        offsets[pair.first + 1]++;
+      }
+      for (size_t i = 1; i < offsets.size(); i++) {
+        offsets[i] += offsets[i - 1];
+      }
+      std::vector<int> collIds(compatiblePairs.size());
+      std::vector<int> fillPosition(offsets.begin(), offsets.end() - 1);
+      for (const auto& pair : compatiblePairs) {
+        collIds[fillPosition[pair.first]++] = pair.second;
+      }
 
+      std::vector<int> collIdsThisTrack;
+      for (const auto& track : tracksUnfiltered) {
         const auto trackId = track.globalIndex();
-        if (collsPerTrack[trackId] == nullptr) {
-          reverseIndices(empty);
-        } else {
-          reverseIndices(*collsPerTrack[trackId].get());
-        }
+        collIdsThisTrack.assign(collIds.begin() + offsets[trackId], collIds.begin() + offsets[trackId + 1]);
+        reverseIndices(collIdsThisTrack);
       }
     }
   }
 
  private:
+  /// time resolution model of a track, which defines the threshold for the time compatibility
+  enum class TimeResolution : uint8_t {
+    None,     // no time compatibility
+    Fixed,    // PV contributor, with the time of its collision
+    Range,    // the resolution is the half width of a range
+    Gaussian, // gaussian resolution
+  };
+
+  /// time information of a track, cached for the association
+  struct TrackTimeInfo {
+    int64_t bcForWindow = 0; // BC of the track time, to select the collisions within the maximum window
+    int64_t bc = 0;          // BC of the collision (or ambiguous track) the track time refers to
+    int64_t filteredIndex = 0;
+    int64_t globalIndex = 0;
+    float time = 0.;
+    float timeRes = 0.;
+    TimeResolution resolution = TimeResolution::None;
+  };
+
   float mNumSigmaForTimeCompat{4.};                                                  // number of sigma for time compatibility
   float mTimeMargin{500.};                                                           // additional time margin in ns
   int mTrackSelection{o2::aod::track_association::TrackSelection::GlobalTrackWoDCA}; // track selection for central barrel tracks (standard association only)
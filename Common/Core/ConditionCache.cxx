@@ -0,0 +1,57 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file ConditionCache.cxx
+/// \brief Cache of condition objects keyed by CCDB path and validity interval, shared by the tasks of a process
+
+#include "Common/Core/ConditionCache.h"
+
+#include <cstdlib>
+
+using namespace o2::analysis;
+
+ConditionCache& ConditionCache::instance()
+{
+  static ConditionCache cache;
+  return cache;
+}
+
+void ConditionCache::setURL(std::string const& url)
+{
+  if (url == mURL) {
+    return;
+  }
+  if (!mURL.empty()) {
+    LOGP(warning, "Condition cache URL changed from {} to {}, the objects already loaded are kept", mURL, url);
+  }
+  mURL = url;
+  mApi.init(mURL);
+}
+
+ConditionCache::Path* ConditionCache::getPath(std::string const& path, std::type_info const& type)
+{
+  auto it = mPaths.find(path);
+  if (it == mPaths.end()) {
+    it = mPaths.emplace(path, std::make_unique<Path>(Path{path, std::type_index(type), {}})).first;
+  } else if (it->second->type != std::type_index(type)) {
+    LOGP(fatal, "Condition object {} requested as {} but already cached as {}", path, type.name(), it->second->type.name());
+  }
+  return it->second.get();
+}
+
+uint64_t ConditionCache::getValidity(std::map<std::string, std::string> const& headers, std::string const& key, uint64_t defaultValue)
+{
+  auto it = headers.find(key);
+  if (it == headers.end() || it->second.empty()) {
+    return defaultValue;
+  }
+  return std::strtoull(it->second.c_str(), nullptr, 10);
+}
@@ -0,0 +1,161 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file ConditionCache.h
+/// \brief Cache of condition objects keyed by CCDB path and validity interval, shared by the tasks of a process
+///
+/// Tasks subscribe to the paths they need and keep the returned handles. Querying a handle with a timestamp
+/// inside the validity interval of the object it returned last is two integer comparisons, so handles can be
+/// queried for every BC or collision. Otherwise the intervals already loaded for the path are searched, and
+/// only then the object is retrieved, deserialised once and kept until the end of the process. All the tasks
+/// of a process share the objects of a path.
+///
+/// The objects are retrieved from the CCDB URL given to setURL(). For tests, a "file://<directory>" URL reads
+/// the snapshot layout of the CCDB API (<directory>/<path>/snapshot.root), objects without validity being
+/// valid for any timestamp, and insert() adds objects directly.
+
+#ifndef COMMON_CORE_CONDITIONCACHE_H_
+#define COMMON_CORE_CONDITIONCACHE_H_
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+#include "CCDB/CcdbApi.h"
+#include "Framework/Logger.h"
+
+namespace o2::analysis
+{
+
+class ConditionCache
+{
+  struct Interval {
+    uint64_t validFrom = 0;
+    uint64_t validUntil = 0; // excluded
+    std::shared_ptr<void> object;
+  };
+  struct Path {
+    std::string path;
+    std::type_index type;
+    std::vector<Interval> intervals;
+  };
+
+ public:
+  /// Handle on the objects of one path, returned by subscribe()
+  template <typename T>
+  class Handle
+  {
+   public:
+    Handle() = default;
+
+    /// Object valid at the timestamp (ms), nullptr if there is none and the cache does not fail on missing objects
+    T* get(uint64_t timestamp)
+    {
+      if (timestamp >= mValidFrom && timestamp < mValidUntil) {
+        return mObject;
+      }
+      if (mPath == nullptr) {
+        LOG(fatal) << "Condition handle used without subscribing to a path";
+      }
+      const Interval* interval = ConditionCache::instance().find<T>(*mPath, timestamp);
+      if (interval == nullptr) {
+        return nullptr;
+      }
+      mValidFrom = interval->validFrom;
+      mValidUntil = interval->validUntil;
+      mObject = static_cast<T*>(interval->object.get());
+      return mObject;
+    }
+
+   private:
+    friend class ConditionCache;
+    explicit Handle(Path* path) : mPath(path) {}
+
+    Path* mPath = nullptr;
+    uint64_t mValidFrom = 0;
+    uint64_t mValidUntil = 0;
+    T* mObject = nullptr;
+  };
+
+  static ConditionCache& instance();
+
+  /// Sets the CCDB URL, or file://<directory> for a local snapshot. Objects already loaded are kept.
+  void setURL(std::string const& url);
+  std::string const& getURL() const { return mURL; }
+  /// Fail when no object is found for a path and timestamp (default), otherwise the handles return nullptr
+  void setFatalWhenNull(bool fatalWhenNull) { mFatalWhenNull = fatalWhenNull; }
+
+  template <typename T>
+  Handle<T> subscribe(std::string const& path)
+  {
+    return Handle<T>(getPath(path, typeid(T)));
+  }
+
+  /// Adds an object valid in [validFrom, validUntil), e.g. to run tasks on condition objects built locally
+  template <typename T>
+  void insert(std::string const& path, std::unique_ptr<T> object, uint64_t validFrom = 0, uint64_t validUntil = std::numeric_limits<uint64_t>::max())
+  {
+    getPath(path, typeid(T))->intervals.push_back({validFrom, validUntil, std::shared_ptr<T>(std::move(object))});
+  }
+
+  /// Number of objects loaded for the path
+  int getNObjects(std::string const& path) const
+  {
+    auto it = mPaths.find(path);
+    return it == mPaths.end() ? 0 : it->second->intervals.size();
+  }
+
+ private:
+  ConditionCache() = default;
+
+  Path* getPath(std::string const& path, std::type_info const& type);
+
+  template <typename T>
+  const Interval* find(Path& path, uint64_t timestamp)
+  {
+    for (auto const& interval : path.intervals) {
+      if (timestamp >= interval.validFrom && timestamp < interval.validUntil) {
+        return &interval;
+      }
+    }
+    std::map<std::string, std::string> headers;
+    std::unique_ptr<T> object(mApi.retrieveFromTFileAny<T>(path.path, mMetadata, timestamp, &headers));
+    if (!object) {
+      if (mFatalWhenNull) {
+        LOGP(fatal, "Condition object {} not found for timestamp {} in {}", path.path, timestamp, mURL);
+      }
+      LOGP(error, "Condition object {} not found for timestamp {} in {}", path.path, timestamp, mURL);
+      return nullptr;
+    }
+    Interval interval{getValidity(headers, "Valid-From", 0), getValidity(headers, "Valid-Until", std::numeric_limits<uint64_t>::max()), std::shared_ptr<T>(std::move(object))};
+    LOGP(info, "Loaded condition object {} valid in [{}, {}) for timestamp {}", path.path, interval.validFrom, interval.validUntil, timestamp);
+    path.intervals.push_back(std::move(interval));
+    return &path.intervals.back();
+  }
+
+  static uint64_t getValidity(std::map<std::string, std::string> const& headers, std::string const& key, uint64_t defaultValue);
+
+  std::string mURL;
+  bool mFatalWhenNull = true;
+  o2::ccdb::CcdbApi mApi;
+  std::map<std::string, std::string> mMetadata;
+  std::unordered_map<std::string, std::unique_ptr<Path>> mPaths; // the paths are not moved, the handles point to them
+};
+
+} // namespace o2::analysis
+
+#endif // COMMON_CORE_CONDITIONCACHE_H_
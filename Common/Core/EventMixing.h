@@ -12,9 +12,15 @@
 #ifndef ANALYSIS_CORE_EVENTMIXING_H_
 #define ANALYSIS_CORE_EVENTMIXING_H_
 
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
 namespace eventmixing
 {
 /// Calculate hash for an element based on 2 properties and their bins.
+/// For repeated calls (e.g. one per collision) prefer MixingBinning, which does not scan the bins.
 /// \tparam T1 Data type of the configurable of the z-vertex and multiplicity bins
 /// \tparam T2 Data type of the value of the z-vertex and multiplicity
 /// \param vtxBins Binning in z-vertex
@@ -34,17 +40,139 @@ static int getMixingBin(const T1& vtxBins, const T1& multBins, const T2& vtx, co
   }
 
   for (unsigned int i = 1; i < vtxBins.size(); i++) {
-    if (vtx < vtxBins.at(i)) {
+    if (vtx < vtxBins[i]) {
       for (unsigned int j = 1; j < multBins.size(); j++) {
-        if (mult < multBins.at(j)) {
+        if (mult < multBins[j]) {
           return i + j * (vtxBins.size() + 1);
         }
       }
+      return -1; // overflow in multiplicity
     }
   }
   // overflow
   return -1;
 }
+
+/// \brief Binning of the collisions in N mixing variables (e.g. z-vertex, multiplicity, centrality, event plane angle)
+/// The bin of each variable is the index of the first bin edge above the value, as in getMixingBin.
+/// For equidistant edges it is computed arithmetically, otherwise with a branch-free count over the edges.
+/// The hash is i0 + i1 * (nEdges0 + 1) + i2 * (nEdges0 + 1) * (nEdges1 + 1) + ..., such that for
+/// N = 2 with (z-vertex, multiplicity) it is identical to getMixingBin. Values outside the edges give -1.
+/// \tparam N Number of mixing variables
+template <std::size_t N>
+class MixingBinning
+{
+ public:
+  MixingBinning() = default;
+  explicit MixingBinning(const std::array<std::vector<float>, N>& edges) { setEdges(edges); }
+
+  /// Sets the bin edges of all the variables, in increasing order
+  void setEdges(const std::array<std::vector<float>, N>& edges)
+  {
+    int stride = 1;
+    for (std::size_t iAxis = 0; iAxis < N; iAxis++) {
+      Axis& axis = mAxes[iAxis];
+      axis.edges = edges[iAxis];
+      axis.stride = stride;
+      stride *= static_cast<int>(axis.edges.size()) + 1;
+      const int nBins = static_cast<int>(axis.edges.size()) - 1;
+      axis.isUniform = false;
+      if (nBins < 1) {
+        continue;
+      }
+      const double width = (static_cast<double>(axis.edges.back()) - axis.edges.front()) / nBins;
+      axis.isUniform = width > 0.;
+      for (int i = 1; i < nBins && axis.isUniform; i++) {
+        axis.isUniform = std::abs(axis.edges[i] - (axis.edges.front() + i * width)) < 1.e-3 * width;
+      }
+      axis.invWidth = axis.isUniform ? 1. / width : 0.;
+    }
+    mNHashes = stride;
+  }
+
+  /// Upper bound of the hash values, to size per-bin containers
+  int getNHashes() const { return mNHashes; }
+
+  /// Hash of one collision, -1 if any of the values is outside the binning
+  int getBin(const std::array<float, N>& values) const
+  {
+    int hash = 0;
+    for (std::size_t iAxis = 0; iAxis < N; iAxis++) {
+      const int index = mAxes[iAxis].getIndex(values[iAxis]);
+      if (index < 0) {
+        return -1;
+      }
+      hash += index * mAxes[iAxis].stride;
+    }
+    return hash;
+  }
+  template <typename... Ts>
+  int getBin(Ts... values) const
+  {
+    static_assert(sizeof...(Ts) == N, "One value per mixing variable is needed");
+    return getBin(std::array<float, N>{static_cast<float>(values)...});
+  }
+
+  /// Hashes of a block of collisions given as one array per mixing variable
+  void getBins(std::size_t nCollisions, const std::array<const float*, N>& values, int* hashes) const
+  {
+    for (std::size_t i = 0; i < nCollisions; i++) {
+      hashes[i] = 0;
+    }
+    for (std::size_t iAxis = 0; iAxis < N; iAxis++) {
+      const Axis& axis = mAxes[iAxis];
+      for (std::size_t i = 0; i < nCollisions; i++) {
+        const int index = axis.getIndex(values[iAxis][i]);
+        hashes[i] = (index < 0 || hashes[i] < 0) ? -1 : hashes[i] + index * axis.stride;
+      }
+    }
+  }
+
+  /// Hashes of all the collisions of a table, in table order
+  /// \param getValues callable returning the std::array<float, N> of mixing variables of a collision
+  template <typename TCollisions, typename TGetter>
+  void getBins(const TCollisions& collisions, TGetter&& getValues, std::vector<int>& hashes) const
+  {
+    hashes.clear();
+    hashes.reserve(collisions.size());
+    for (const auto& collision : collisions) {
+      hashes.push_back(getBin(getValues(collision)));
+    }
+  }
+
+ private:
+  struct Axis {
+    std::vector<float> edges;
+    bool isUniform = false;
+    double invWidth = 0.;
+    int stride = 1;
+
+    /// Index of the first edge above the value (1 ... nEdges - 1), -1 for underflow, overflow and NaN
+    int getIndex(float value) const
+    {
+      const int nEdges = edges.size();
+      int index = 0;
+      if (!(value == value)) { // NaN
+        return -1;
+      }
+      if (isUniform) {
+        const double x = (value - edges.front()) * invWidth;
+        index = (x < 0. ? 0 : (x >= nEdges - 1 ? nEdges - 1 : static_cast<int>(x) + 1));
+        // correct for the rounding, such that the index is consistent with the stored edges
+        index -= (index > 0 && value < edges[index - 1]);
+        index += (index < nEdges && value >= edges[index]);
+      } else {
+        for (int i = 0; i < nEdges; i++) {
+          index += (value >= edges[i]);
+        }
+      }
+      return (index >= 1 && index < nEdges) ? index : -1;
+    }
+  };
+
+  std::array<Axis, N> mAxes;
+  int mNHashes = 0;
+};
 }; // namespace eventmixing
 
 #endif /* ANALYSIS_CORE_EVENTMIXING_H_ */
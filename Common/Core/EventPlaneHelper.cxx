@@ -31,7 +31,73 @@
 #include "TMath.h"
 #include "TVector3.h"
 
+namespace
+{
+// FT0 geometry with the channel centers calculated, shared by all the helpers.
+o2::ft0::Geometry& GetFT0Geometry()
+{
+  static std::unique_ptr<o2::ft0::Geometry> ft0Det = [] {
+    auto geometry = std::make_unique<o2::ft0::Geometry>();
+    geometry->calculateChannelCenter();
+    return geometry;
+  }();
+  return *ft0Det;
+}
+} // namespace
+
 double EventPlaneHelper::GetPhiFV0(int chno)
+{
+  UpdateChannelTables();
+  if (chno >= 0 && chno < NChannelsFV0) {
+    return mPhiFV0[chno];
+  }
+  return CalculatePhiFV0(chno);
+}
+
+double EventPlaneHelper::GetPhiFT0(int chno)
+{
+  UpdateChannelTables();
+  if (chno >= 0 && chno < NChannelsFT0) {
+    return mPhiFT0[chno];
+  }
+  return CalculatePhiFT0(chno);
+}
+
+void EventPlaneHelper::UpdateChannelTables()
+{
+  if (mChannelTablesUpToDate) {
+    return;
+  }
+
+  mPhiFT0.resize(NChannelsFT0);
+  for (int chno = 0; chno < NChannelsFT0; chno++) {
+    mPhiFT0[chno] = CalculatePhiFT0(chno);
+  }
+  mPhiFV0.resize(NChannelsFV0);
+  for (int chno = 0; chno < NChannelsFV0; chno++) {
+    mPhiFV0[chno] = CalculatePhiFV0(chno);
+  }
+
+  const int nHarmonics = mHarmonics.size();
+  mCosFT0.resize(nHarmonics * NChannelsFT0);
+  mSinFT0.resize(nHarmonics * NChannelsFT0);
+  mCosFV0.resize(nHarmonics * NChannelsFV0);
+  mSinFV0.resize(nHarmonics * NChannelsFV0);
+  for (int ih = 0; ih < nHarmonics; ih++) {
+    for (int chno = 0; chno < NChannelsFT0; chno++) {
+      mCosFT0[ih * NChannelsFT0 + chno] = TMath::Cos(mPhiFT0[chno] * mHarmonics[ih]);
+      mSinFT0[ih * NChannelsFT0 + chno] = TMath::Sin(mPhiFT0[chno] * mHarmonics[ih]);
+    }
+    for (int chno = 0; chno < NChannelsFV0; chno++) {
+      mCosFV0[ih * NChannelsFV0 + chno] = TMath::Cos(mPhiFV0[chno] * mHarmonics[ih]);
+      mSinFV0[ih * NChannelsFV0 + chno] = TMath::Sin(mPhiFV0[chno] * mHarmonics[ih]);
+    }
+  }
+
+  mChannelTablesUpToDate = true;
+}
+
+double EventPlaneHelper::CalculatePhiFV0(int chno) const
 {
   /* Calculate the azimuthal angle in FV0 for the channel number 'chno'. The offset
   on the A-side is taken into account here. */
@@ -58,7 +124,7 @@ double EventPlaneHelper::GetPhiFV0(int chno)
   return TMath::ATan2(chPos.y + offsetY, chPos.x + offsetX);
 }
 
-double EventPlaneHelper::GetPhiFT0(int chno)
+double EventPlaneHelper::CalculatePhiFT0(int chno) const
 {
   /* Calculate the azimuthal angle in FT0 for the channel number 'chno'. The offset
     of FT0-A is taken into account if chno is between 0 and 95. */
@@ -71,9 +137,7 @@ double EventPlaneHelper::GetPhiFT0(int chno)
     offsetY = mOffsetFT0AY;
   }
 
-  o2::ft0::Geometry ft0Det;
-  ft0Det.calculateChannelCenter();
-  auto chPos = ft0Det.getChannelCenter(chno);
+  auto chPos = GetFT0Geometry().getChannelCenter(chno);
   /// printf("Channel id: %d X: %.3f Y: %.3f\n", chno, chPos.X(), chPos.Y());
 
   return TMath::ATan2(chPos.Y() + offsetY, chPos.X() + offsetX);
@@ -107,6 +171,70 @@ void EventPlaneHelper::SumQvectors(int det, int chno, float ampl, int nmod, TCom
   sum += ampl;
 }
 
+void EventPlaneHelper::SumQvectorsHarmonics(int det, int nch, const int* chnos, const float* ampl,
+                                            double* qRe, double* qIm, float& sum)
+{
+  /* Calculate the complex Q-vectors of all the tabulated harmonics for the provided
+    detector and channels, before adding them to the total Q-vectors given as argument.
+    Each harmonic is a gather of the tabulated cos(n*phi) and sin(n*phi) of the channels,
+    multiplied by the amplitudes and accumulated in the channel order. */
+  UpdateChannelTables();
+
+  const double* cosTable = nullptr;
+  const double* sinTable = nullptr;
+  int nChannels = 0;
+  switch (det) {
+    case 0: // FT0.
+      cosTable = mCosFT0.data();
+      sinTable = mSinFT0.data();
+      nChannels = NChannelsFT0;
+      break;
+    case 1: // FV0.
+      cosTable = mCosFV0.data();
+      sinTable = mSinFV0.data();
+      nChannels = NChannelsFV0;
+      break;
+    default:
+      printf("'int det' value does not correspond to any accepted case.\n");
+      return;
+  }
+
+  for (int i = 0; i < nch; i++) {
+    if (chnos[i] < 0 || chnos[i] >= nChannels) { // Channel not tabulated, use the per-channel method.
+      for (std::size_t ih = 0; ih < mHarmonics.size(); ih++) {
+        TComplex Qvec(qRe[ih], qIm[ih]);
+        float sumDummy = 0.;
+        for (int j = 0; j < nch; j++) {
+          SumQvectors(det, chnos[j], ampl[j], mHarmonics[ih], Qvec, sumDummy);
+        }
+        qRe[ih] = Qvec.Re();
+        qIm[ih] = Qvec.Im();
+      }
+      for (int j = 0; j < nch; j++) {
+        sum += ampl[j];
+      }
+      return;
+    }
+  }
+
+  const int nHarmonics = mHarmonics.size();
+  for (int ih = 0; ih < nHarmonics; ih++) {
+    const double* cosHarmonic = cosTable + ih * nChannels;
+    const double* sinHarmonic = sinTable + ih * nChannels;
+    double re = qRe[ih];
+    double im = qIm[ih];
+    for (int i = 0; i < nch; i++) {
+      re += ampl[i] * cosHarmonic[chnos[i]];
+      im += ampl[i] * sinHarmonic[chnos[i]];
+    }
+    qRe[ih] = re;
+    qIm[ih] = im;
+  }
+  for (int i = 0; i < nch; i++) {
+    sum += ampl[i];
+  }
+}
+
 int EventPlaneHelper::GetCentBin(float cent)
 {
   const float centClasses[] = {0., 5., 10., 20., 30., 40., 50., 60., 80.};
@@ -40,24 +40,37 @@ class EventPlaneHelper
   {
     mOffsetFT0AX = offsetX;
     mOffsetFT0AY = offsetY;
+    mChannelTablesUpToDate = false;
   }
   void SetOffsetFT0C(double offsetX, double offsetY)
   {
     mOffsetFT0CX = offsetX;
     mOffsetFT0CY = offsetY;
+    mChannelTablesUpToDate = false;
   }
   void SetOffsetFV0left(double offsetX, double offsetY)
   {
     mOffsetFV0leftX = offsetX;
     mOffsetFV0leftY = offsetY;
+    mChannelTablesUpToDate = false;
   }
   void SetOffsetFV0right(double offsetX, double offsetY)
   {
     mOffsetFV0rightX = offsetX;
     mOffsetFV0rightY = offsetY;
+    mChannelTablesUpToDate = false;
   }
 
+  // Set the harmonics for which cos(n*phi) and sin(n*phi) of the FIT channels are tabulated.
+  void SetHarmonics(const std::vector<int>& harmonics)
+  {
+    mHarmonics = harmonics;
+    mChannelTablesUpToDate = false;
+  }
+  const std::vector<int>& GetHarmonics() const { return mHarmonics; }
+
   // Methods to calculate the azimuthal angles for each part of FIT, given the channel number.
+  // The angles are tabulated per channel and only recalculated when the offsets change.
   double GetPhiFT0(int chno);
   double GetPhiFV0(int chno);
 
@@ -65,6 +78,13 @@ class EventPlaneHelper
   // the detector and amplitude.
   void SumQvectors(int det, int chno, float ampl, int nmod, TComplex& Qvec, float& sum);
 
+  // Method to get the Q-vectors for all the harmonics set with SetHarmonics() and the
+  // sum of amplitudes for a list of nch channels of the detector, from the tabulated
+  // cos(n*phi) and sin(n*phi). qRe and qIm have one entry per harmonic and are incremented,
+  // in the same order as with SumQvectors() called for each channel.
+  void SumQvectorsHarmonics(int det, int nch, const int* chnos, const float* ampl,
+                            double* qRe, double* qIm, float& sum);
+
   // Method to get the bin corresponding to a centrality percentile, according to the
   // centClasses[] array defined in Tasks/qVectorsQA.cxx.
   // Note: Any change in one task should be reflected in the other.
@@ -96,6 +116,17 @@ class EventPlaneHelper
   float GetResolution(const float RefA, const float RefB, int nmode = 2);
 
  private:
+  static constexpr int NChannelsFT0 = 208; // 96 channels in FT0-A and 112 in FT0-C.
+  static constexpr int NChannelsFV0 = 48;
+
+  // Methods to calculate the azimuthal angle of a channel from the geometry and the offsets.
+  double CalculatePhiFT0(int chno) const;
+  double CalculatePhiFV0(int chno) const;
+
+  // Method to fill the tables of azimuthal angles and harmonics of the FIT channels, if
+  // the offsets or the harmonics changed since the last call.
+  void UpdateChannelTables();
+
   double mOffsetFT0AX = 0.;     // X-coordinate of the offset of FT0-A.
   double mOffsetFT0AY = 0.;     // Y-coordinate of the offset of FT0-A.
   double mOffsetFT0CX = 0.;     // X-coordinate of the offset of FT0-C.
@@ -105,6 +136,15 @@ class EventPlaneHelper
   double mOffsetFV0rightX = 0.; // X-coordinate of the offset of FV0-A right.
   double mOffsetFV0rightY = 0.; // Y-coordinate of the offset of FV0-A right.
 
+  std::vector<int> mHarmonics{2};       //! Harmonics tabulated for the FIT channels.
+  bool mChannelTablesUpToDate = false;  //! Tables consistent with the offsets and harmonics.
+  std::vector<double> mPhiFT0;          //! Azimuthal angle of the FT0 channels.
+  std::vector<double> mPhiFV0;          //! Azimuthal angle of the FV0 channels.
+  std::vector<double> mCosFT0;          //! cos(n*phi) of the FT0 channels, [harmonic][channel].
+  std::vector<double> mSinFT0;          //! sin(n*phi) of the FT0 channels, [harmonic][channel].
+  std::vector<double> mCosFV0;          //! cos(n*phi) of the FV0 channels, [harmonic][channel].
+  std::vector<double> mSinFV0;          //! sin(n*phi) of the FV0 channels, [harmonic][channel].
+
   ClassDefNV(EventPlaneHelper, 2)
 };
 
@@ -0,0 +1,118 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file HistogramLookup.h
+/// \brief Flat copy of a one-dimensional calibration histogram for per-collision lookups
+///
+/// Calibrations stored as histograms in the CCDB are evaluated for every collision. HistogramLookup copies
+/// the axis, the bin contents and the bin centers of a histogram once (e.g. per run) and then
+/// reproduces TH1::GetBinContent(TH1::FindFixBin(x)) and TH1::Interpolate(x) without the virtual calls
+/// and the axis bookkeeping of ROOT. Uniform axes are evaluated arithmetically, variable ones with a
+/// binary search on the bin edges. The bin search and the interpolation use the same arithmetic as ROOT,
+/// such that the results are identical to the ones of the histogram.
+
+#ifndef COMMON_CORE_HISTOGRAMLOOKUP_H_
+#define COMMON_CORE_HISTOGRAMLOOKUP_H_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <TH1.h>
+
+namespace o2::analysis
+{
+
+class HistogramLookup
+{
+ public:
+  HistogramLookup() = default;
+  explicit HistogramLookup(const TH1* histogram) { set(histogram); }
+
+  /// Copies the histogram, a nullptr resets the lookup
+  void set(const TH1* histogram)
+  {
+    mNBins = 0;
+    mEdges.clear();
+    mContents.clear();
+    mCenters.clear();
+    if (histogram == nullptr) {
+      return;
+    }
+    const TAxis* axis = histogram->GetXaxis();
+    mNBins = axis->GetNbins();
+    mXMin = axis->GetXmin();
+    mXMax = axis->GetXmax();
+    if (axis->GetXbins()->fN) {
+      mEdges.assign(axis->GetXbins()->GetArray(), axis->GetXbins()->GetArray() + axis->GetXbins()->fN);
+    }
+    mContents.resize(mNBins + 2);
+    mCenters.resize(mNBins + 2);
+    for (int bin = 0; bin <= mNBins + 1; bin++) {
+      mContents[bin] = histogram->GetBinContent(bin);
+      mCenters[bin] = axis->GetBinCenter(bin);
+    }
+  }
+  bool isSet() const { return mNBins > 0; }
+
+  /// Bin of x, as TAxis::FindFixBin (0: underflow, nBins + 1: overflow and NaN)
+  int findBin(double x) const
+  {
+    if (x < mXMin) {
+      return 0;
+    }
+    if (!(x < mXMax)) {
+      return mNBins + 1;
+    }
+    if (mEdges.empty()) {
+      return 1 + static_cast<int>(mNBins * (x - mXMin) / (mXMax - mXMin));
+    }
+    return std::upper_bound(mEdges.begin(), mEdges.end(), x) - mEdges.begin();
+  }
+
+  /// Content of the bin of x, as TH1::GetBinContent(TH1::FindFixBin(x))
+  double getBinContent(double x) const { return mContents[findBin(x)]; }
+
+  /// Linear interpolation between the bin centers, as TH1::Interpolate(x), NaN for a NaN x
+  double interpolate(double x) const
+  {
+    if (std::isnan(x)) {
+      return std::numeric_limits<double>::quiet_NaN(); // would otherwise fall in the overflow bin, without a next bin
+    }
+    if (x <= mCenters[1]) {
+      return mContents[1];
+    }
+    if (x >= mCenters[mNBins]) {
+      return mContents[mNBins];
+    }
+    int bin = findBin(x);
+    if (x <= mCenters[bin]) {
+      bin--;
+    }
+    // evaluated as in TH1::Interpolate, a precomputed slope would round differently
+    const double x0 = mCenters[bin];
+    const double y0 = mContents[bin];
+    return y0 + (x - x0) * ((mContents[bin + 1] - y0) / (mCenters[bin + 1] - x0));
+  }
+
+ private:
+  int mNBins = 0;
+  double mXMin = 0.;
+  double mXMax = 0.;
+  std::vector<double> mEdges;    // bin edges of variable size bins, empty for a uniform axis
+  std::vector<double> mContents; // including underflow and overflow
+  std::vector<double> mCenters;  // including underflow and overflow
+};
+
+} // namespace o2::analysis
+
+#endif // COMMON_CORE_HISTOGRAMLOOKUP_H_
@@ -18,6 +18,7 @@
 #define COMMON_CORE_PID_TPCPIDRESPONSE_H_
 
 #include <array>
+#include <cstdint>
 #include <vector>
 #include <cmath>
 #include "Framework/Logger.h"
@@ -29,6 +30,39 @@
 namespace o2::pid::tpc
 {
 
+/// \brief Track quantities entering the TPC response, stored as structure of arrays for a block of tracks
+struct TrackBlock {
+  static constexpr int kMaxSize = 256; // block size, keeps the per-block scratch in L1
+
+  /// Appends a track. Tracks flagged as not valid (e.g. without TPC) get -999 for all the response quantities
+  template <typename TrackType>
+  void add(const TrackType& track, const float multTPC, const bool isValid)
+  {
+    tpcInnerParam[mSize] = track.tpcInnerParam();
+    tgl[mSize] = track.tgl();
+    signed1Pt[mSize] = track.signed1Pt();
+    tpcSignal[mSize] = track.tpcSignal();
+    tpcNClsFound[mSize] = static_cast<float>(track.tpcNClsFound());
+    mult[mSize] = multTPC;
+    valid[mSize] = isValid;
+    mSize++;
+  }
+  void clear() { mSize = 0; }
+  int size() const { return mSize; }
+  bool full() const { return mSize == kMaxSize; }
+
+  std::array<float, kMaxSize> tpcInnerParam;
+  std::array<float, kMaxSize> tgl;
+  std::array<float, kMaxSize> signed1Pt;
+  std::array<float, kMaxSize> tpcSignal;
+  std::array<float, kMaxSize> tpcNClsFound;
+  std::array<float, kMaxSize> mult;
+  std::array<uint8_t, kMaxSize> valid;
+
+ private:
+  int mSize = 0;
+};
+
 /// \brief Class to handle the TPC PID response
 
 class Response
@@ -82,6 +116,10 @@ class Response
   float GetSignalDelta(const TrackType& trk, const o2::track::PID::ID id) const;
   /// Gets relative dEdx resolution contribution due to relative pt resolution
   float GetRelativeResolutiondEdx(const float p, const float mass, const float charge, const float resol) const;
+  /// Gets the expected resolution and the number of sigmas for a block of tracks and one mass hypothesis.
+  /// Same values as GetExpectedSigma and GetNumberOfSigma, with Bethe-Bloch evaluated once per track and no allocations.
+  /// Invalid entries (no TPC, negative expected signal or resolution) are set to -999
+  void GetNumberOfSigmaBlock(const TrackBlock& block, const o2::track::PID::ID id, float* expSigma, float* nSigma) const;
 
   void PrintAll() const;
 
@@ -179,6 +217,63 @@ inline float Response::GetRelativeResolutiondEdx(const float p, const float mass
   return deltaRel;
 }
 
+inline void Response::GetNumberOfSigmaBlock(const TrackBlock& block, const o2::track::PID::ID id, float* expSigma, float* nSigma) const
+{
+  const int n = block.size();
+  const float mass = o2::track::pid_constants::sMasses[id];
+  const float chargeFactor = std::pow(static_cast<float>(o2::track::pid_constants::sCharges[id]), mChargeFactor);
+  std::array<float, TrackBlock::kMaxSize> bethe; // Bethe-Bloch without MIP and charge scaling, shared by signal and resolution
+  std::array<float, TrackBlock::kMaxSize> expSignal;
+  for (int i = 0; i < n; i++) {
+    bethe[i] = o2::tpc::BetheBlochAleph(block.tpcInnerParam[i] / mass, mBetheBlochParams[0], mBetheBlochParams[1], mBetheBlochParams[2], mBetheBlochParams[3], mBetheBlochParams[4]);
+  }
+  for (int i = 0; i < n; i++) {
+    const float signal = mMIP * bethe[i] * chargeFactor;
+    expSignal[i] = signal >= 0.f ? signal : -999.f;
+  }
+
+  if (mUseDefaultResolutionParam) {
+    for (int i = 0; i < n; i++) {
+      const float ncl = block.tpcNClsFound[i];
+      const float reso = expSignal[i] * mResolutionParamsDefault[0] * (ncl > 0 ? std::sqrt(1. + mResolutionParamsDefault[1] / ncl) : 1.f);
+      expSigma[i] = reso >= 0.f ? reso : -999.f;
+    }
+  } else {
+    const double res0Sq = mResolutionParams[0] * mResolutionParams[0];
+    const double res1Sq = mResolutionParams[1] * mResolutionParams[1];
+    const float resolRel = mResolutionParams[3];
+    for (int i = 0; i < n; i++) {
+      const float p = block.tpcInnerParam[i];
+      const double dEdx = bethe[i] * chargeFactor;
+      // Relative resolution due to the momentum resolution, see GetRelativeResolutiondEdx
+      const float dEdxF = dEdx;
+      const float bgDelta = p * (1 + resolRel * std::sqrt(dEdxF)) / mass;
+      const float dEdx2 = o2::tpc::BetheBlochAleph(bgDelta, mBetheBlochParams[0], mBetheBlochParams[1], mBetheBlochParams[2], mBetheBlochParams[3], mBetheBlochParams[4]) * chargeFactor;
+      const double relReso = std::abs(dEdx2 - dEdxF) / dEdxF;
+
+      const double invdEdx = 1.f / dEdx;
+      const double sqrtNcl = std::sqrt(static_cast<double>(nClNorm / block.tpcNClsFound[i]));
+      const double tgl = block.tgl[i];
+      const double mult = block.mult[i] / mMultNormalization;
+      const double scaledInvdEdx = invdEdx / std::sqrt(1 + tgl * tgl);
+      const double res4Pt = mResolutionParams[4] * block.signed1Pt[i];
+      const double res6Mult = mult * mResolutionParams[6];
+      const double res7Mult = mult * scaledInvdEdx * mResolutionParams[7];
+
+      const float reso = std::sqrt(res0Sq * invdEdx + res1Sq * (sqrtNcl * mResolutionParams[5]) * std::pow(scaledInvdEdx, mResolutionParams[2]) + sqrtNcl * relReso * relReso + res4Pt * res4Pt + res6Mult * res6Mult + res7Mult * res7Mult) * dEdx * mMIP;
+      expSigma[i] = reso >= 0.f ? reso : -999.f;
+    }
+  }
+
+  for (int i = 0; i < n; i++) {
+    const bool isValid = block.valid[i] && expSignal[i] >= 0.f && expSigma[i] >= 0.f;
+    const float sigma = isValid ? expSigma[i] : 1.f;
+    const float value = (block.tpcSignal[i] - expSignal[i]) / sigma;
+    expSigma[i] = isValid ? expSigma[i] : -999.f;
+    nSigma[i] = isValid ? value : -999.f;
+  }
+}
+
 inline void Response::PrintAll() const
 {
   LOGP(info, "==== TPC PID response parameters: ====");
@@ -0,0 +1,84 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file ParallelFor.h
+/// \brief Loop over the entries of flat buffers on a pool of threads
+///
+/// The entries are split in chunks of fixed size which are handed out to the threads in increasing order.
+/// Each thread gets an index such that the loop body can use per-thread objects (fitters, caches), the
+/// entries being processed in place so that the output keeps the input order whatever the number of threads.
+
+#ifndef COMMON_CORE_PARALLELFOR_H_
+#define COMMON_CORE_PARALLELFOR_H_
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace o2::analysis
+{
+
+/// Number of threads to use for a requested number, 0 or less meaning the hardware concurrency
+inline int getNThreads(int nThreads)
+{
+  return nThreads > 0 ? nThreads : std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+}
+
+/// Calls f(first, last, iThread) for the chunks [first, last) of chunkSize consecutive entries covering [0, nEntries).
+/// iThread is in [0, getNThreads(nThreads)). An exception thrown by f is rethrown once all the threads are joined.
+/// \param nThreads number of threads, 0 for the hardware concurrency, 1 runs in the calling thread
+template <typename F>
+void parallelForChunks(int nEntries, int nThreads, int chunkSize, F&& f)
+{
+  chunkSize = std::max(chunkSize, 1);
+  const int nChunks = (nEntries + chunkSize - 1) / chunkSize;
+  auto processChunk = [&](int iChunk, int iThread) {
+    f(iChunk * chunkSize, std::min((iChunk + 1) * chunkSize, nEntries), iThread);
+  };
+
+  nThreads = std::min(getNThreads(nThreads), nChunks);
+  if (nThreads <= 1) {
+    for (int iChunk = 0; iChunk < nChunks; iChunk++) {
+      processChunk(iChunk, 0);
+    }
+    return;
+  }
+
+  std::atomic<int> nextChunk{0};
+  std::vector<std::exception_ptr> exceptions(nThreads);
+  std::vector<std::thread> threads;
+  threads.reserve(nThreads);
+  for (int iThread = 0; iThread < nThreads; iThread++) {
+    threads.emplace_back([&, iThread]() {
+      try {
+        for (int iChunk = nextChunk++; iChunk < nChunks; iChunk = nextChunk++) {
+          processChunk(iChunk, iThread);
+        }
+      } catch (...) {
+        exceptions[iThread] = std::current_exception();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto& exception : exceptions) {
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+  }
+}
+
+} // namespace o2::analysis
+
+#endif // COMMON_CORE_PARALLELFOR_H_
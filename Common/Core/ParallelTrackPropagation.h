@@ -0,0 +1,66 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file ParallelTrackPropagation.h
+/// \brief Propagation of a batch of tracks to their vertices on a pool of threads
+///
+/// The tracks, their DCA and the index of their vertex are kept in flat buffers, one entry per track.
+/// The buffers are split in chunks of fixed size which are handed out to the threads (see ParallelFor.h),
+/// each track being propagated in place, such that the output keeps the input order whatever the number of threads.
+/// The propagator is only read during the propagation (field, material LUT), so it is shared by the threads.
+
+#ifndef COMMON_CORE_PARALLELTRACKPROPAGATION_H_
+#define COMMON_CORE_PARALLELTRACKPROPAGATION_H_
+
+#include <vector>
+
+#include "Common/Core/ParallelFor.h"
+#include "DetectorsBase/Propagator.h"
+#include "ReconstructionDataFormats/DCA.h"
+#include "ReconstructionDataFormats/Track.h"
+#include "ReconstructionDataFormats/Vertex.h"
+
+namespace track_propagation
+{
+
+/// Propagates a track with covariance to the DCA to the vertex
+inline bool propagateToVertex(o2::dataformats::VertexBase const& vertex, o2::track::TrackParametrizationWithError<float>& track, o2::dataformats::DCA& dca, float maxStep, o2::base::Propagator::MatCorrType matCorr)
+{
+  return o2::base::Propagator::Instance()->propagateToDCABxByBz(vertex, track, maxStep, matCorr, &dca);
+}
+
+/// Propagates a track without covariance to the DCA to the vertex position
+inline bool propagateToVertex(o2::dataformats::VertexBase const& vertex, o2::track::TrackParametrization<float>& track, o2::gpu::gpustd::array<float, 2>& dca, float maxStep, o2::base::Propagator::MatCorrType matCorr)
+{
+  return o2::base::Propagator::Instance()->propagateToDCABxByBz(vertex.getXYZ(), track, maxStep, matCorr, &dca);
+}
+
+/// Propagates tracks[i] to vertices[vertexIndices[i]], writing the DCA to dcas[i].
+/// Tracks with a negative vertex index are left untouched.
+/// \param nThreads number of threads, 0 for the hardware concurrency, 1 runs in the calling thread
+/// \param chunkSize number of consecutive tracks handed to a thread at once
+template <typename TTrack, typename TDca>
+void propagateToVertices(std::vector<TTrack>& tracks, std::vector<TDca>& dcas, std::vector<int> const& vertexIndices,
+                         std::vector<o2::dataformats::VertexBase> const& vertices, float maxStep, o2::base::Propagator::MatCorrType matCorr,
+                         int nThreads = 1, int chunkSize = 256)
+{
+  o2::analysis::parallelForChunks(tracks.size(), nThreads, chunkSize, [&](int first, int last, int) {
+    for (int iTrack = first; iTrack < last; iTrack++) {
+      if (vertexIndices[iTrack] >= 0) {
+        propagateToVertex(vertices[vertexIndices[iTrack]], tracks[iTrack], dcas[iTrack], maxStep, matCorr);
+      }
+    }
+  });
+}
+
+} // namespace track_propagation
+
+#endif // COMMON_CORE_PARALLELTRACKPROPAGATION_H_
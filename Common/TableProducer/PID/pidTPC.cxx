@@ -19,6 +19,9 @@
 ///         QA histograms for the TPC PID can be produced by adding `--add-qa 1` to the workflow
 ///
 
+#include <algorithm>
+#include <memory>
+
 // ROOT includes
 #include "TFile.h"
 #include "TSystem.h"
@@ -28,6 +31,7 @@
 #include "Framework/AnalysisTask.h"
 #include "ReconstructionDataFormats/Track.h"
 #include "CCDB/CcdbApi.h"
+#include <Monitoring/Monitoring.h>
 #include "Common/DataModel/PIDResponse.h"
 #include "Common/Core/PID/TPCPIDResponse.h"
 #include "Framework/AnalysisDataModel.h"
@@ -70,15 +74,22 @@ struct tpcPid {
 
   // TPC PID Response
   o2::pid::tpc::Response* response;
+  o2::pid::tpc::TrackBlock trackBlock; // Tracks buffered for the batched response evaluation
+  std::array<float, o2::pid::tpc::TrackBlock::kMaxSize> blockExpSigma;
+  std::array<float, o2::pid::tpc::TrackBlock::kMaxSize> blockNSigma;
 
   // Network correction for TPC PID response
-  OnnxModel network;
+  OnnxModel* network = nullptr;                         // session used for the current time frame, owned by networkCache
+  std::vector<std::unique_ptr<OnnxModel>> networkCache; // ready sessions, one per validity interval
+  std::vector<float> networkInput;                      // input tensor of the whole time frame, all mass hypotheses
+  std::vector<float> networkOutput;                     // output of one inference chunk
   o2::ccdb::CcdbApi ccdbApi;
   std::map<std::string, std::string> metadata;
   std::map<std::string, std::string> headers;
 
   // Input parameters
   Service<o2::ccdb::BasicCCDBManager> ccdb;
+  Service<o2::monitoring::Monitoring> monitoring;
   Configurable<std::string> paramfile{"param-file", "", "Path to the parametrization object, if empty the parametrization is not taken from file"};
   Configurable<std::string> url{"ccdb-url", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
   Configurable<std::string> ccdbPath{"ccdbPath", "Analysis/PID/TPC/Response", "Path of the TPC parametrization on the CCDB"};
@@ -92,6 +103,8 @@ struct tpcPid {
   Configurable<bool> enableNetworkOptimizations{"enableNetworkOptimizations", 1, "(bool) If the neural network correction is used, this enables GraphOptimizationLevel::ORT_ENABLE_EXTENDED in the ONNX session"};
   Configurable<std::string> networkPathCCDB{"networkPathCCDB", "Analysis/PID/TPC/ML", "Path on CCDB"};
   Configurable<int> networkSetNumThreads{"networkSetNumThreads", 0, "Especially important for running on a SLURM cluster. Sets the number of threads used for execution."};
+  Configurable<int> networkChunkSize{"networkChunkSize", 8192, "Number of (track, mass hypothesis) rows evaluated per network inference call"};
+  Configurable<int> networkCacheSize{"networkCacheSize", 4, "Maximum number of network sessions (validity intervals) kept in memory, the oldest is dropped first"};
   // Configuration flags to include and exclude particle hypotheses
   Configurable<int> pidEl{"pid-el", -1, {"Produce PID information for the Electron mass hypothesis, overrides the automatic setup: the corresponding table can be set off (0) or on (1)"}};
   Configurable<int> pidMu{"pid-mu", -1, {"Produce PID information for the Muon mass hypothesis, overrides the automatic setup: the corresponding table can be set off (0) or on (1)"}};
@@ -176,25 +189,18 @@ struct tpcPid {
       if (!autofetchNetworks) {
         if (ccdbTimestamp > 0) {
           /// Fetching network for specific timestamp
-          LOG(info) << "Fetching network for timestamp: " << ccdbTimestamp.value;
-          bool retrieveSuccess = ccdbApi.retrieveBlob(networkPathCCDB.value, ".", metadata, ccdbTimestamp.value, false, networkPathLocally.value);
-          headers = ccdbApi.retrieveHeaders(networkPathCCDB.value, metadata, ccdbTimestamp.value);
-          if (retrieveSuccess) {
-            network.initModel(networkPathLocally.value, enableNetworkOptimizations.value, networkSetNumThreads.value, strtoul(headers["Valid-From"].c_str(), NULL, 0), strtoul(headers["Valid-Until"].c_str(), NULL, 0));
-            std::vector<float> dummyInput(network.getNumInputNodes(), 1.);
-            network.evalModel(dummyInput); /// Init the model evaluations
-          } else {
-            LOG(fatal) << "Error encountered while fetching/loading the network from CCDB! Maybe the network doesn't exist yet for this runnumber/timestamp?";
-          }
+          selectNetwork(ccdbTimestamp.value);
         } else {
           /// Taking the network from local file
           if (networkPathLocally.value == "") {
             LOG(fatal) << "Local path must be set (flag networkPathLocally)! Aborting...";
           }
           LOG(info) << "Using local file [" << networkPathLocally.value << "] for the TPC PID response correction.";
-          network.initModel(networkPathLocally.value, enableNetworkOptimizations.value, networkSetNumThreads.value);
-          std::vector<float> dummyInput(network.getNumInputNodes(), 1.);
-          network.evalModel(dummyInput); // This is an initialisation and might reduce the overhead of the model
+          networkCache.emplace_back(std::make_unique<OnnxModel>());
+          network = networkCache.back().get();
+          network->initModel(networkPathLocally.value, enableNetworkOptimizations.value, networkSetNumThreads.value);
+          std::vector<float> dummyInput(network->getNumInputNodes(), 1.);
+          network->evalModel(dummyInput); // This is an initialisation and might reduce the overhead of the model
         }
       } else {
         return;
@@ -202,6 +208,57 @@ struct tpcPid {
     }
   }
 
+  /// Retrieves the TPC response object for the given timestamp from CCDB, falling back to the latest object if the reco pass is not found
+  void retrieveResponse(const uint64_t timestamp)
+  {
+    if (recoPass.value == "") {
+      LOGP(info, "Retrieving latest TPC response object for timestamp {}:", timestamp);
+    } else {
+      LOGP(info, "Retrieving TPC Response for timestamp {} and recoPass {}:", timestamp, recoPass.value);
+    }
+    response = ccdb->getSpecific<o2::pid::tpc::Response>(ccdbPath.value, timestamp, metadata);
+    if (!response) {
+      LOGP(warning, "!! Could not find a valid TPC response object for specific pass name {}! Falling back to latest uploaded object.", recoPass.value);
+      response = ccdb->getForTimeStamp<o2::pid::tpc::Response>(ccdbPath.value, timestamp);
+      if (!response) {
+        LOGP(fatal, "Could not find ANY TPC response object for the timestamp {}!", timestamp);
+      }
+    }
+    response->PrintAll();
+  }
+
+  /// Selects the network valid for the timestamp. Sessions of previous validity intervals are kept in memory,
+  /// the network is only downloaded from CCDB and a new session is created if none of them covers the timestamp
+  void selectNetwork(const uint64_t timestamp)
+  {
+    if (network && timestamp >= network->getValidityFrom() && timestamp <= network->getValidityUntil()) {
+      return;
+    }
+    for (const auto& cached : networkCache) {
+      if (timestamp >= cached->getValidityFrom() && timestamp <= cached->getValidityUntil()) {
+        LOG(info) << "Using cached network valid from " << cached->getValidityFrom() << " until " << cached->getValidityUntil() << " for timestamp: " << timestamp;
+        network = cached.get();
+        return;
+      }
+    }
+
+    LOG(info) << "Fetching network for timestamp: " << timestamp;
+    bool retrieveSuccess = ccdbApi.retrieveBlob(networkPathCCDB.value, ".", metadata, timestamp, false, networkPathLocally.value);
+    headers = ccdbApi.retrieveHeaders(networkPathCCDB.value, metadata, timestamp);
+    if (!retrieveSuccess) {
+      LOG(fatal) << "Error encountered while fetching/loading the network from CCDB! Maybe the network doesn't exist yet for this runnumber/timestamp?";
+    }
+    if (!networkCache.empty() && static_cast<int>(networkCache.size()) >= networkCacheSize.value) {
+      networkCache.erase(networkCache.begin());
+    }
+    auto model = std::make_unique<OnnxModel>();
+    model->initModel(networkPathLocally.value, enableNetworkOptimizations.value, networkSetNumThreads.value, strtoul(headers["Valid-From"].c_str(), NULL, 0), strtoul(headers["Valid-Until"].c_str(), NULL, 0));
+    std::vector<float> dummyInput(model->getNumInputNodes(), 1.);
+    model->evalModel(dummyInput); /// Init the model evaluations
+    network = model.get();
+    networkCache.emplace_back(std::move(model));
+  }
+
   Partition<Trks> notTPCStandaloneTracks = ((aod::track::itsClusterSizes > (uint32_t)0) || (aod::track::trdPattern > (uint8_t)0) || (aod::track::tofExpMom > 0.f && aod::track::tofChi2 > 0.f)); // To count number of tracks for use in NN array
   Partition<Trks> tracksWithTPC = (aod::track::tpcNClsFindable > (uint8_t)0);
 
@@ -227,6 +284,54 @@ struct tpcPid {
     reserveTable(pidHe, tablePIDHe);
     reserveTable(pidAl, tablePIDAl);
 
+    if (!useNetworkCorrection) {
+      // Tracks are buffered in blocks and all the enabled mass hypotheses are evaluated per block with the batched response
+      auto fillBlock = [&]() {
+        auto fillTable = [&](const Configurable<int>& flag, auto& table, const o2::track::PID::ID pid) {
+          if (flag.value != 1) {
+            return;
+          }
+          response->GetNumberOfSigmaBlock(trackBlock, pid, blockExpSigma.data(), blockNSigma.data());
+          for (int i = 0; i < trackBlock.size(); i++) {
+            if (blockExpSigma[i] < 0.f) { // invalid track or expected signal
+              table(aod::pidtpc_tiny::binning::underflowBin);
+            } else {
+              aod::pidutils::packInTable<aod::pidtpc_tiny::binning>(blockNSigma[i], table);
+            }
+          }
+        };
+        fillTable(pidEl, tablePIDEl, o2::track::PID::Electron);
+        fillTable(pidMu, tablePIDMu, o2::track::PID::Muon);
+        fillTable(pidPi, tablePIDPi, o2::track::PID::Pion);
+        fillTable(pidKa, tablePIDKa, o2::track::PID::Kaon);
+        fillTable(pidPr, tablePIDPr, o2::track::PID::Proton);
+        fillTable(pidDe, tablePIDDe, o2::track::PID::Deuteron);
+        fillTable(pidTr, tablePIDTr, o2::track::PID::Triton);
+        fillTable(pidHe, tablePIDHe, o2::track::PID::Helium3);
+        fillTable(pidAl, tablePIDAl, o2::track::PID::Alpha);
+        trackBlock.clear();
+      };
+
+      for (auto const& trk : tracks) {
+        float multTPC = 0.f;
+        if (trk.has_collision()) {
+          const auto& collision = collisions.iteratorAt(trk.collisionId());
+          const auto& bc = collision.bc_as<aod::BCsWithTimestamps>();
+          if (useCCDBParam && ccdbTimestamp.value == 0 && !ccdb->isCachedObjectValid(ccdbPath.value, bc.timestamp())) { // Updating parametrisation only if the initial timestamp is 0
+            fillBlock(); // buffered tracks are evaluated with the previous parametrisation
+            retrieveResponse(bc.timestamp());
+          }
+          multTPC = collision.multTPC();
+        }
+        trackBlock.add(trk, multTPC, trk.hasTPC() && (!skipTPCOnly || trk.hasITS() || trk.hasTRD() || trk.hasTOF()));
+        if (trackBlock.full()) {
+          fillBlock();
+        }
+      }
+      fillBlock();
+      return;
+    }
+
     std::vector<float> network_prediction;
     const uint64_t tracksForNet_size = (skipTPCOnly) ? notTPCStandaloneTracks.size() : tracksWithTPC.size();
 
@@ -236,90 +341,68 @@ struct tpcPid {
         auto bc = collisions.iteratorAt(0).bc_as<aod::BCsWithTimestamps>();
         // Initialise correct TPC response object before NN setup (for NCl normalisation)
         if (useCCDBParam && ccdbTimestamp.value == 0 && !ccdb->isCachedObjectValid(ccdbPath.value, bc.timestamp())) { // Updating parametrisation only if the initial timestamp is 0
-          if (recoPass.value == "") {
-            LOGP(info, "Retrieving latest TPC response object for timestamp {}:", bc.timestamp());
-          } else {
-            LOGP(info, "Retrieving TPC Response for timestamp {} and recoPass {}:", bc.timestamp(), recoPass.value);
-          }
-          response = ccdb->getSpecific<o2::pid::tpc::Response>(ccdbPath.value, bc.timestamp(), metadata);
-          if (!response) {
-            LOGP(warning, "!! Could not find a valid TPC response object for specific pass name {}! Falling back to latest uploaded object.", recoPass.value);
-            response = ccdb->getForTimeStamp<o2::pid::tpc::Response>(ccdbPath.value, bc.timestamp());
-            if (!response) {
-              LOGP(fatal, "Could not find ANY TPC response object for the timestamp {}!", bc.timestamp());
-            }
-          }
-          response->PrintAll();
+          retrieveResponse(bc.timestamp());
         }
 
-        if (bc.timestamp() < network.getValidityFrom() || bc.timestamp() > network.getValidityUntil()) { // fetches network only if the runnumbers change
-          LOG(info) << "Fetching network for timestamp: " << bc.timestamp();
-          bool retrieveSuccess = ccdbApi.retrieveBlob(networkPathCCDB.value, ".", metadata, bc.timestamp(), false, networkPathLocally.value);
-          headers = ccdbApi.retrieveHeaders(networkPathCCDB.value, metadata, bc.timestamp());
-          if (retrieveSuccess) {
-            network.initModel(networkPathLocally.value, enableNetworkOptimizations.value, networkSetNumThreads.value, strtoul(headers["Valid-From"].c_str(), NULL, 0), strtoul(headers["Valid-Until"].c_str(), NULL, 0));
-
-            std::vector<float> dummyInput(network.getNumInputNodes(), 1.);
-            network.evalModel(dummyInput);
-          } else {
-            LOG(fatal) << "Error encountered while fetching/loading the network from CCDB! Maybe the network doesn't exist yet for this runnumber/timestamp?";
-          }
-        }
+        selectNetwork(bc.timestamp());
       }
 
       // Defining some network parameters
-      int input_dimensions = network.getNumInputNodes();
-      int output_dimensions = network.getNumOutputNodes();
-      const uint64_t track_prop_size = input_dimensions * tracksForNet_size;
-      const uint64_t prediction_size = output_dimensions * tracksForNet_size;
-
-      network_prediction = std::vector<float>(prediction_size * 9); // For each mass hypotheses
+      const int input_dimensions = network->getNumInputNodes();
+      const int output_dimensions = network->getNumOutputNodes();
+      const uint64_t nRows = tracksForNet_size * 9; // For each mass hypotheses
       const float nNclNormalization = response->GetNClNormalization();
-      float duration_network = 0;
 
-      std::vector<float> track_properties(track_prop_size);
+      // One contiguous input tensor for the whole time frame, ordered by mass hypothesis and then track.
+      // The track features are filled once for the first hypothesis and copied for the others, only the mass differs
+      networkInput.resize(nRows * input_dimensions);
       uint64_t counter_track_props = 0;
-      int loop_counter = 0;
-
-      // Filling a std::vector<float> to be evaluated by the network
-      // Evaluation on single tracks brings huge overhead: Thus evaluation is done on one large vector
-      for (int i = 0; i < 9; i++) { // Loop over particle number for which network correction is used
-        for (auto const& trk : tracks) {
-          if (!trk.hasTPC()) {
+      for (auto const& trk : tracks) {
+        if (!trk.hasTPC()) {
+          continue;
+        }
+        if (skipTPCOnly) {
+          if (!trk.hasITS() && !trk.hasTRD() && !trk.hasTOF()) {
             continue;
           }
-          if (skipTPCOnly) {
-            if (!trk.hasITS() && !trk.hasTRD() && !trk.hasTOF()) {
-              continue;
-            }
-          }
-          track_properties[counter_track_props] = trk.tpcInnerParam();
-          track_properties[counter_track_props + 1] = trk.tgl();
-          track_properties[counter_track_props + 2] = trk.signed1Pt();
-          track_properties[counter_track_props + 3] = o2::track::pid_constants::sMasses[i];
-          track_properties[counter_track_props + 4] = collisions.iteratorAt(trk.collisionId()).multTPC() / 11000.;
-          track_properties[counter_track_props + 5] = std::sqrt(nNclNormalization / trk.tpcNClsFound());
-          counter_track_props += input_dimensions;
         }
-
-        auto start_network_eval = std::chrono::high_resolution_clock::now();
-        float* output_network = network.evalModel(track_properties);
-        auto stop_network_eval = std::chrono::high_resolution_clock::now();
-        duration_network += std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_eval - start_network_eval).count();
-        for (uint64_t i = 0; i < prediction_size; i += output_dimensions) {
-          for (int j = 0; j < output_dimensions; j++) {
-            network_prediction[i + j + prediction_size * loop_counter] = output_network[i + j];
-          }
+        networkInput[counter_track_props] = trk.tpcInnerParam();
+        networkInput[counter_track_props + 1] = trk.tgl();
+        networkInput[counter_track_props + 2] = trk.signed1Pt();
+        networkInput[counter_track_props + 3] = o2::track::pid_constants::sMasses[0];
+        networkInput[counter_track_props + 4] = collisions.iteratorAt(trk.collisionId()).multTPC() / 11000.;
+        networkInput[counter_track_props + 5] = std::sqrt(nNclNormalization / trk.tpcNClsFound());
+        counter_track_props += input_dimensions;
+      }
+      const uint64_t track_prop_size = input_dimensions * tracksForNet_size;
+      for (int i = 1; i < 9; i++) {
+        float* speciesInput = networkInput.data() + track_prop_size * i;
+        std::copy(networkInput.begin(), networkInput.begin() + track_prop_size, speciesInput);
+        for (uint64_t row = 3; row < track_prop_size; row += input_dimensions) {
+          speciesInput[row] = o2::track::pid_constants::sMasses[i];
         }
+      }
 
-        counter_track_props = 0;
-        loop_counter += 1;
+      // Inference in fixed-size chunks, the prediction keeps the layout of the input rows
+      network_prediction.resize(nRows * output_dimensions);
+      const uint64_t chunkSize = std::max(networkChunkSize.value, 1);
+      auto start_network_eval = std::chrono::high_resolution_clock::now();
+      for (uint64_t firstRow = 0; firstRow < nRows; firstRow += chunkSize) {
+        const uint64_t nChunkRows = std::min(chunkSize, nRows - firstRow);
+        if (!network->evalModelBatch(networkInput.data() + firstRow * input_dimensions, nChunkRows, networkOutput)) {
+          LOG(fatal) << "Evaluation of the network for the TPC PID response correction failed!";
+        }
+        std::copy(networkOutput.begin(), networkOutput.end(), network_prediction.begin() + firstRow * output_dimensions);
+      }
+      auto stop_network_eval = std::chrono::high_resolution_clock::now();
+      const float duration_network = std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_eval - start_network_eval).count();
+      if (nRows > 0 && duration_network > 0.f) {
+        monitoring->send(o2::monitoring::Metric{nRows / (duration_network * 1.e-9), "tpcpid-network-inference-rate"}); // (track, mass hypothesis) rows per second
       }
-      track_properties.clear();
 
       auto stop_network_total = std::chrono::high_resolution_clock::now();
-      LOG(debug) << "Neural Network for the TPC PID response correction: Time per track (eval ONNX): " << duration_network / (tracksForNet_size * 9) << "ns ; Total time (eval ONNX): " << duration_network / 1000000000 << " s";
-      LOG(debug) << "Neural Network for the TPC PID response correction: Time per track (eval + overhead): " << std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_total - start_network_total).count() / (tracksForNet_size * 9) << "ns ; Total time (eval + overhead): " << std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_total - start_network_total).count() / 1000000000 << " s";
+      LOG(debug) << "Neural Network for the TPC PID response correction: Time per track (eval ONNX): " << duration_network / nRows << "ns ; Total time (eval ONNX): " << duration_network / 1000000000 << " s";
+      LOG(debug) << "Neural Network for the TPC PID response correction: Time per track (eval + overhead): " << std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_total - start_network_total).count() / nRows << "ns ; Total time (eval + overhead): " << std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_total - start_network_total).count() / 1000000000 << " s";
     }
 
     uint64_t count_tracks = 0;
@@ -329,20 +412,7 @@ struct tpcPid {
       if (trk.has_collision()) {
         const auto& bc = collisions.iteratorAt(trk.collisionId()).bc_as<aod::BCsWithTimestamps>();
         if (useCCDBParam && ccdbTimestamp.value == 0 && !ccdb->isCachedObjectValid(ccdbPath.value, bc.timestamp())) { // Updating parametrisation only if the initial timestamp is 0
-          if (recoPass.value == "") {
-            LOGP(info, "Retrieving latest TPC response object for timestamp {}:", bc.timestamp());
-          } else {
-            LOGP(info, "Retrieving TPC Response for timestamp {} and recoPass {}:", bc.timestamp(), recoPass.value);
-          }
-          response = ccdb->getSpecific<o2::pid::tpc::Response>(ccdbPath.value, bc.timestamp(), metadata);
-          if (!response) {
-            LOGP(warning, "!! Could not find a valid TPC response object for specific pass name {}! Falling back to latest uploaded object.", recoPass.value);
-            response = ccdb->getForTimeStamp<o2::pid::tpc::Response>(ccdbPath.value, bc.timestamp());
-            if (!response) {
-              LOGP(fatal, "Could not find ANY TPC response object for the timestamp {}!", bc.timestamp());
-            }
-          }
-          response->PrintAll();
+          retrieveResponse(bc.timestamp());
         }
       }
       // Check and fill enabled tables
@@ -371,11 +441,11 @@ struct tpcPid {
 
           // Here comes the application of the network. The output--dimensions of the network dtermine the application: 1: mean, 2: sigma, 3: sigma asymmetric
           // For now only the option 2: sigma will be used. The other options are kept if there would be demand later on
-          if (network.getNumOutputNodes() == 1) {
+          if (network->getNumOutputNodes() == 1) {
             aod::pidutils::packInTable<aod::pidtpc_tiny::binning>((trk.tpcSignal() - network_prediction[count_tracks + tracksForNet_size * pid] * expSignal) / expSigma, table);
-          } else if (network.getNumOutputNodes() == 2) {
+          } else if (network->getNumOutputNodes() == 2) {
             aod::pidutils::packInTable<aod::pidtpc_tiny::binning>((trk.tpcSignal() / expSignal - network_prediction[2 * (count_tracks + tracksForNet_size * pid)]) / (network_prediction[2 * (count_tracks + tracksForNet_size * pid) + 1] - network_prediction[2 * (count_tracks + tracksForNet_size * pid)]), table);
-          } else if (network.getNumOutputNodes() == 3) {
+          } else if (network->getNumOutputNodes() == 3) {
             if (trk.tpcSignal() / expSignal >= network_prediction[3 * (count_tracks + tracksForNet_size * pid)]) {
               aod::pidutils::packInTable<aod::pidtpc_tiny::binning>((trk.tpcSignal() / expSignal - network_prediction[3 * (count_tracks + tracksForNet_size * pid)]) / (network_prediction[3 * (count_tracks + tracksForNet_size * pid) + 1] - network_prediction[3 * (count_tracks + tracksForNet_size * pid)]), table);
             } else {
@@ -70,6 +70,9 @@ struct tpcPidFull {
 
   // TPC PID Response
   o2::pid::tpc::Response* response;
+  o2::pid::tpc::TrackBlock trackBlock; // Tracks buffered for the batched response evaluation
+  std::array<float, o2::pid::tpc::TrackBlock::kMaxSize> blockExpSigma;
+  std::array<float, o2::pid::tpc::TrackBlock::kMaxSize> blockNSigma;
 
   // Network correction for TPC PID response
   OnnxModel network;
@@ -203,6 +206,25 @@ struct tpcPidFull {
     }
   }
 
+  /// Retrieves the TPC response object for the given timestamp from CCDB, falling back to the latest object if the reco pass is not found
+  void retrieveResponse(const uint64_t timestamp)
+  {
+    if (recoPass.value == "") {
+      LOGP(info, "Retrieving latest TPC response object for timestamp {}:", timestamp);
+    } else {
+      LOGP(info, "Retrieving TPC Response for timestamp {} and recoPass {}:", timestamp, recoPass.value);
+    }
+    response = ccdb->getSpecific<o2::pid::tpc::Response>(ccdbPath.value, timestamp, metadata);
+    if (!response) {
+      LOGP(warning, "!! Could not find a valid TPC response object for specific pass name {}! Falling back to latest uploaded object.", recoPass.value);
+      response = ccdb->getForTimeStamp<o2::pid::tpc::Response>(ccdbPath.value, timestamp);
+      if (!response) {
+        LOGP(fatal, "Could not find ANY TPC response object for the timestamp {}!", timestamp);
+      }
+    }
+    response->PrintAll();
+  }
+
   Partition<Trks> notTPCStandaloneTracks = (aod::track::tpcNClsFindable > (uint8_t)0) && ((aod::track::itsClusterSizes > (uint32_t)0) || (aod::track::trdPattern > (uint8_t)0) || (aod::track::tofExpMom > 0.f && aod::track::tofChi2 > 0.f)); // To count number of tracks for use in NN array
   Partition<Trks> tracksWithTPC = (aod::track::tpcNClsFindable > (uint8_t)0);
 
@@ -228,6 +250,50 @@ struct tpcPidFull {
     reserveTable(pidHe, tablePIDHe);
     reserveTable(pidAl, tablePIDAl);
 
+    if (!useNetworkCorrection) {
+      // Tracks are buffered in blocks and all the enabled mass hypotheses are evaluated per block with the batched response
+      auto fillBlock = [&]() {
+        auto fillTable = [&](const Configurable<int>& flag, auto& table, const o2::track::PID::ID pid) {
+          if (flag.value != 1) {
+            return;
+          }
+          response->GetNumberOfSigmaBlock(trackBlock, pid, blockExpSigma.data(), blockNSigma.data());
+          for (int i = 0; i < trackBlock.size(); i++) {
+            table(blockExpSigma[i], blockNSigma[i]);
+          }
+        };
+        fillTable(pidEl, tablePIDEl, o2::track::PID::Electron);
+        fillTable(pidMu, tablePIDMu, o2::track::PID::Muon);
+        fillTable(pidPi, tablePIDPi, o2::track::PID::Pion);
+        fillTable(pidKa, tablePIDKa, o2::track::PID::Kaon);
+        fillTable(pidPr, tablePIDPr, o2::track::PID::Proton);
+        fillTable(pidDe, tablePIDDe, o2::track::PID::Deuteron);
+        fillTable(pidTr, tablePIDTr, o2::track::PID::Triton);
+        fillTable(pidHe, tablePIDHe, o2::track::PID::Helium3);
+        fillTable(pidAl, tablePIDAl, o2::track::PID::Alpha);
+        trackBlock.clear();
+      };
+
+      for (auto const& trk : tracks) {
+        float multTPC = 0.f;
+        if (trk.has_collision()) {
+          const auto& collision = collisions.iteratorAt(trk.collisionId());
+          const auto& bc = collision.bc_as<aod::BCsWithTimestamps>();
+          if (useCCDBParam && ccdbTimestamp.value == 0 && !ccdb->isCachedObjectValid(ccdbPath.value, bc.timestamp())) { // Updating parametrisation only if the initial timestamp is 0
+            fillBlock(); // buffered tracks are evaluated with the previous parametrisation
+            retrieveResponse(bc.timestamp());
+          }
+          multTPC = collision.multTPC();
+        }
+        trackBlock.add(trk, multTPC, trk.hasTPC() && (!skipTPCOnly || trk.hasITS() || trk.hasTRD() || trk.hasTOF()));
+        if (trackBlock.full()) {
+          fillBlock();
+        }
+      }
+      fillBlock();
+      return;
+    }
+
     std::vector<float> network_prediction;
     const uint64_t tracksForNet_size = (skipTPCOnly) ? notTPCStandaloneTracks.size() : tracksWithTPC.size();
 
@@ -238,20 +304,7 @@ struct tpcPidFull {
         auto bc = collisions.iteratorAt(0).bc_as<aod::BCsWithTimestamps>();
         // Initialise correct TPC response object before NN setup (for NCl normalisation)
         if (useCCDBParam && ccdbTimestamp.value == 0 && !ccdb->isCachedObjectValid(ccdbPath.value, bc.timestamp())) { // Updating parametrisation only if the initial timestamp is 0
-          if (recoPass.value == "") {
-            LOGP(info, "Retrieving latest TPC response object for timestamp {}:", bc.timestamp());
-          } else {
-            LOGP(info, "Retrieving TPC Response for timestamp {} and recoPass {}:", bc.timestamp(), recoPass.value);
-          }
-          response = ccdb->getSpecific<o2::pid::tpc::Response>(ccdbPath.value, bc.timestamp(), metadata);
-          if (!response) {
-            LOGP(warning, "!! Could not find a valid TPC response object for specific pass name {}! Falling back to latest uploaded object.", recoPass.value);
-            response = ccdb->getForTimeStamp<o2::pid::tpc::Response>(ccdbPath.value, bc.timestamp());
-            if (!response) {
-              LOGP(fatal, "Could not find ANY TPC response object for the timestamp {}!", bc.timestamp());
-            }
-          }
-          response->PrintAll();
+          retrieveResponse(bc.timestamp());
         }
 
         if (bc.timestamp() < network.getValidityFrom() || bc.timestamp() > network.getValidityUntil()) { // fetches network only if the runnumbers change
@@ -330,20 +383,7 @@ struct tpcPidFull {
       if (trk.has_collision()) {
         const auto& bc = collisions.iteratorAt(trk.collisionId()).bc_as<aod::BCsWithTimestamps>();
         if (useCCDBParam && ccdbTimestamp.value == 0 && !ccdb->isCachedObjectValid(ccdbPath.value, bc.timestamp())) { // Updating parametrisation only if the initial timestamp is 0
-          if (recoPass.value == "") {
-            LOGP(info, "Retrieving latest TPC response object for timestamp {}:", bc.timestamp());
-          } else {
-            LOGP(info, "Retrieving TPC Response for timestamp {} and recoPass {}:", bc.timestamp(), recoPass.value);
-          }
-          response = ccdb->getSpecific<o2::pid::tpc::Response>(ccdbPath.value, bc.timestamp(), metadata);
-          if (!response) {
-            LOGP(warning, "!! Could not find a valid TPC response object for specific pass name {}! Falling back to latest uploaded object.", recoPass.value);
-            response = ccdb->getForTimeStamp<o2::pid::tpc::Response>(ccdbPath.value, bc.timestamp());
-            if (!response) {
-              LOGP(fatal, "Could not find ANY TPC response object for the timestamp {}!", bc.timestamp());
-            }
-          }
-          response->PrintAll();
+          retrieveResponse(bc.timestamp());
         }
       }
       // Check and fill enabled tables
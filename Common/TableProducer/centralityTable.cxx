@@ -21,6 +21,7 @@
 #include "Framework/RunningWorkflowInfo.h"
 #include "Common/DataModel/Multiplicity.h"
 #include "Common/DataModel/Centrality.h"
+#include "Common/Core/HistogramLookup.h"
 #include "TableHelper.h"
 
 using namespace o2;
@@ -83,46 +84,45 @@ struct CentralityTable {
     bool mCalibrationStored = false;
     TFormula* mMCScale = nullptr;
     float mMCScalePars[6] = {0.0};
-    TH1* mhVtxAmpCorrV0A = nullptr;
-    TH1* mhVtxAmpCorrV0C = nullptr;
-    TH1* mhMultSelCalib = nullptr;
+    o2::analysis::HistogramLookup mhVtxAmpCorrV0A;
+    o2::analysis::HistogramLookup mhVtxAmpCorrV0C;
+    o2::analysis::HistogramLookup mhMultSelCalib;
   } Run2V0MInfo;
   struct tagRun2V0ACalibration {
     bool mCalibrationStored = false;
-    TH1* mhVtxAmpCorrV0A = nullptr;
-    TH1* mhMultSelCalib = nullptr;
+    o2::analysis::HistogramLookup mhVtxAmpCorrV0A;
+    o2::analysis::HistogramLookup mhMultSelCalib;
   } Run2V0AInfo;
   struct tagRun2SPDTrackletsCalibration {
     bool mCalibrationStored = false;
-    TH1* mhVtxAmpCorr = nullptr;
-    TH1* mhMultSelCalib = nullptr;
+    o2::analysis::HistogramLookup mhVtxAmpCorr;
+    o2::analysis::HistogramLookup mhMultSelCalib;
   } Run2SPDTksInfo;
   struct tagRun2SPDClustersCalibration {
     bool mCalibrationStored = false;
-    TH1* mhVtxAmpCorrCL0 = nullptr;
-    TH1* mhVtxAmpCorrCL1 = nullptr;
-    TH1* mhMultSelCalib = nullptr;
+    o2::analysis::HistogramLookup mhVtxAmpCorrCL0;
+    o2::analysis::HistogramLookup mhVtxAmpCorrCL1;
+    o2::analysis::HistogramLookup mhMultSelCalib;
   } Run2SPDClsInfo;
   struct tagRun2CL0Calibration {
     bool mCalibrationStored = false;
-    TH1* mhVtxAmpCorr = nullptr;
-    TH1* mhMultSelCalib = nullptr;
+    o2::analysis::HistogramLookup mhVtxAmpCorr;
+    o2::analysis::HistogramLookup mhMultSelCalib;
   } Run2CL0Info;
   struct tagRun2CL1Calibration {
     bool mCalibrationStored = false;
-    TH1* mhVtxAmpCorr = nullptr;
-    TH1* mhMultSelCalib = nullptr;
+    o2::analysis::HistogramLookup mhVtxAmpCorr;
+    o2::analysis::HistogramLookup mhMultSelCalib;
   } Run2CL1Info;
   struct calibrationInfo {
     std::string name = "";
     bool mCalibrationStored = false;
-    TH1* mhMultSelCalib = nullptr;
+    o2::analysis::HistogramLookup mhMultSelCalib;
     float mMCScalePars[6] = {0.0};
     TFormula* mMCScale = nullptr;
     explicit calibrationInfo(std::string name)
       : name(name),
         mCalibrationStored(false),
-        mhMultSelCalib(nullptr),
         mMCScalePars{0.0},
         mMCScale(nullptr)
     {
@@ -136,6 +136,9 @@ struct CentralityTable {
   calibrationInfo NTPVInfo = calibrationInfo("NTracksPV");
   std::vector<int> mEnabledTables; // Vector of enabled tables
   std::array<bool, nTables> isTableEnabled;
+  // Run 3 estimator values of the collisions waiting for the percentile evaluation
+  std::array<std::vector<float>, nTables> mMultiplicities;
+  std::vector<bool> mAssignOutOfRange;
 
   void init(InitContext& context)
   {
@@ -204,11 +207,11 @@ struct CentralityTable {
         };
         if (isTableEnabled[kCentRun2V0Ms]) {
           LOGF(debug, "Getting new histograms with %d run number for %d run number", mRunNumber, bc.runNumber());
-          Run2V0MInfo.mhVtxAmpCorrV0A = getccdb("hVtx_fAmplitude_V0A_Normalized");
-          Run2V0MInfo.mhVtxAmpCorrV0C = getccdb("hVtx_fAmplitude_V0C_Normalized");
-          Run2V0MInfo.mhMultSelCalib = getccdb("hMultSelCalib_V0M");
+          Run2V0MInfo.mhVtxAmpCorrV0A.set(getccdb("hVtx_fAmplitude_V0A_Normalized"));
+          Run2V0MInfo.mhVtxAmpCorrV0C.set(getccdb("hVtx_fAmplitude_V0C_Normalized"));
+          Run2V0MInfo.mhMultSelCalib.set(getccdb("hMultSelCalib_V0M"));
           Run2V0MInfo.mMCScale = getformulaccdb(TString::Format("%s-V0M", genName->c_str()).Data());
-          if ((Run2V0MInfo.mhVtxAmpCorrV0A != nullptr) && (Run2V0MInfo.mhVtxAmpCorrV0C != nullptr) && (Run2V0MInfo.mhMultSelCalib != nullptr)) {
+          if (Run2V0MInfo.mhVtxAmpCorrV0A.isSet() && Run2V0MInfo.mhVtxAmpCorrV0C.isSet() && Run2V0MInfo.mhMultSelCalib.isSet()) {
             if (genName->length() != 0) {
               if (Run2V0MInfo.mMCScale != nullptr) {
                 for (int ixpar = 0; ixpar < 6; ++ixpar) {
@@ -225,9 +228,9 @@ struct CentralityTable {
         }
         if (isTableEnabled[kCentRun2V0As]) {
           LOGF(debug, "Getting new histograms with %d run number for %d run number", mRunNumber, bc.runNumber());
-          Run2V0AInfo.mhVtxAmpCorrV0A = getccdb("hVtx_fAmplitude_V0A_Normalized");
-          Run2V0AInfo.mhMultSelCalib = getccdb("hMultSelCalib_V0A");
-          if ((Run2V0AInfo.mhVtxAmpCorrV0A != nullptr) && (Run2V0AInfo.mhMultSelCalib != nullptr)) {
+          Run2V0AInfo.mhVtxAmpCorrV0A.set(getccdb("hVtx_fAmplitude_V0A_Normalized"));
+          Run2V0AInfo.mhMultSelCalib.set(getccdb("hMultSelCalib_V0A"));
+          if (Run2V0AInfo.mhVtxAmpCorrV0A.isSet() && Run2V0AInfo.mhMultSelCalib.isSet()) {
             Run2V0AInfo.mCalibrationStored = true;
           } else {
             LOGF(fatal, "Calibration information from V0A for run %d corrupted", bc.runNumber());
@@ -235,9 +238,9 @@ struct CentralityTable {
         }
         if (isTableEnabled[kCentRun2SPDTrks]) {
           LOGF(debug, "Getting new histograms with %d run number for %d run number", mRunNumber, bc.runNumber());
-          Run2SPDTksInfo.mhVtxAmpCorr = getccdb("hVtx_fnTracklets_Normalized");
-          Run2SPDTksInfo.mhMultSelCalib = getccdb("hMultSelCalib_SPDTracklets");
-          if ((Run2SPDTksInfo.mhVtxAmpCorr != nullptr) && (Run2SPDTksInfo.mhMultSelCalib != nullptr)) {
+          Run2SPDTksInfo.mhVtxAmpCorr.set(getccdb("hVtx_fnTracklets_Normalized"));
+          Run2SPDTksInfo.mhMultSelCalib.set(getccdb("hMultSelCalib_SPDTracklets"));
+          if (Run2SPDTksInfo.mhVtxAmpCorr.isSet() && Run2SPDTksInfo.mhMultSelCalib.isSet()) {
             Run2SPDTksInfo.mCalibrationStored = true;
           } else {
             LOGF(fatal, "Calibration information from SPD tracklets for run %d corrupted", bc.runNumber());
@@ -245,10 +248,10 @@ struct CentralityTable {
         }
         if (isTableEnabled[kCentRun2SPDClss]) {
           LOGF(debug, "Getting new histograms with %d run number for %d run number", mRunNumber, bc.runNumber());
-          Run2SPDClsInfo.mhVtxAmpCorrCL0 = getccdb("hVtx_fnSPDClusters0_Normalized");
-          Run2SPDClsInfo.mhVtxAmpCorrCL1 = getccdb("hVtx_fnSPDClusters1_Normalized");
-          Run2SPDClsInfo.mhMultSelCalib = getccdb("hMultSelCalib_SPDClusters");
-          if ((Run2SPDClsInfo.mhVtxAmpCorrCL0 != nullptr) && (Run2SPDClsInfo.mhVtxAmpCorrCL1 != nullptr) && (Run2SPDClsInfo.mhMultSelCalib != nullptr)) {
+          Run2SPDClsInfo.mhVtxAmpCorrCL0.set(getccdb("hVtx_fnSPDClusters0_Normalized"));
+          Run2SPDClsInfo.mhVtxAmpCorrCL1.set(getccdb("hVtx_fnSPDClusters1_Normalized"));
+          Run2SPDClsInfo.mhMultSelCalib.set(getccdb("hMultSelCalib_SPDClusters"));
+          if (Run2SPDClsInfo.mhVtxAmpCorrCL0.isSet() && Run2SPDClsInfo.mhVtxAmpCorrCL1.isSet() && Run2SPDClsInfo.mhMultSelCalib.isSet()) {
             Run2SPDClsInfo.mCalibrationStored = true;
           } else {
             LOGF(fatal, "Calibration information from SPD clusters for run %d corrupted", bc.runNumber());
@@ -256,9 +259,9 @@ struct CentralityTable {
         }
         if (isTableEnabled[kCentRun2CL0s]) {
           LOGF(debug, "Getting new histograms with %d run number for %d run number", mRunNumber, bc.runNumber());
-          Run2CL0Info.mhVtxAmpCorr = getccdb("hVtx_fnSPDClusters0_Normalized");
-          Run2CL0Info.mhMultSelCalib = getccdb("hMultSelCalib_CL0");
-          if ((Run2CL0Info.mhVtxAmpCorr != nullptr) && (Run2CL0Info.mhMultSelCalib != nullptr)) {
+          Run2CL0Info.mhVtxAmpCorr.set(getccdb("hVtx_fnSPDClusters0_Normalized"));
+          Run2CL0Info.mhMultSelCalib.set(getccdb("hMultSelCalib_CL0"));
+          if (Run2CL0Info.mhVtxAmpCorr.isSet() && Run2CL0Info.mhMultSelCalib.isSet()) {
             Run2CL0Info.mCalibrationStored = true;
           } else {
             LOGF(fatal, "Calibration information from CL0 multiplicity for run %d corrupted", bc.runNumber());
@@ -266,9 +269,9 @@ struct CentralityTable {
         }
         if (isTableEnabled[kCentRun2CL1s]) {
           LOGF(debug, "Getting new histograms with %d run number for %d run number", mRunNumber, bc.runNumber());
-          Run2CL1Info.mhVtxAmpCorr = getccdb("hVtx_fnSPDClusters1_Normalized");
-          Run2CL1Info.mhMultSelCalib = getccdb("hMultSelCalib_CL1");
-          if ((Run2CL1Info.mhVtxAmpCorr != nullptr) && (Run2CL1Info.mhMultSelCalib != nullptr)) {
+          Run2CL1Info.mhVtxAmpCorr.set(getccdb("hVtx_fnSPDClusters1_Normalized"));
+          Run2CL1Info.mhMultSelCalib.set(getccdb("hMultSelCalib_CL1"));
+          if (Run2CL1Info.mhVtxAmpCorr.isSet() && Run2CL1Info.mhMultSelCalib.isSet()) {
             Run2CL1Info.mCalibrationStored = true;
           } else {
             LOGF(fatal, "Calibration information from CL1 multiplicity for run %d corrupted", bc.runNumber());
@@ -299,10 +302,10 @@ struct CentralityTable {
           v0m = scaleMC(collision.multFV0M(), Run2V0MInfo.mMCScalePars);
           LOGF(debug, "Unscaled v0m: %f, scaled v0m: %f", collision.multFV0M(), v0m);
         } else {
-          v0m = collision.multFV0A() * Run2V0MInfo.mhVtxAmpCorrV0A->GetBinContent(Run2V0MInfo.mhVtxAmpCorrV0A->FindFixBin(collision.posZ())) +
-                collision.multFV0C() * Run2V0MInfo.mhVtxAmpCorrV0C->GetBinContent(Run2V0MInfo.mhVtxAmpCorrV0C->FindFixBin(collision.posZ()));
+          v0m = collision.multFV0A() * Run2V0MInfo.mhVtxAmpCorrV0A.getBinContent(collision.posZ()) +
+                collision.multFV0C() * Run2V0MInfo.mhVtxAmpCorrV0C.getBinContent(collision.posZ());
         }
-        cV0M = Run2V0MInfo.mhMultSelCalib->GetBinContent(Run2V0MInfo.mhMultSelCalib->FindFixBin(v0m));
+        cV0M = Run2V0MInfo.mhMultSelCalib.getBinContent(v0m);
       }
       LOGF(debug, "centRun2V0M=%.0f", cV0M);
       // fill centrality columns
@@ -311,8 +314,8 @@ struct CentralityTable {
     if (isTableEnabled[kCentRun2V0As]) {
       float cV0A = 105.0f;
       if (Run2V0AInfo.mCalibrationStored) {
-        float v0a = collision.multFV0A() * Run2V0AInfo.mhVtxAmpCorrV0A->GetBinContent(Run2V0AInfo.mhVtxAmpCorrV0A->FindFixBin(collision.posZ()));
-        cV0A = Run2V0AInfo.mhMultSelCalib->GetBinContent(Run2V0AInfo.mhMultSelCalib->FindFixBin(v0a));
+        float v0a = collision.multFV0A() * Run2V0AInfo.mhVtxAmpCorrV0A.getBinContent(collision.posZ());
+        cV0A = Run2V0AInfo.mhMultSelCalib.getBinContent(v0a);
       }
       LOGF(debug, "centRun2V0A=%.0f", cV0A);
       // fill centrality columns
@@ -321,8 +324,8 @@ struct CentralityTable {
     if (isTableEnabled[kCentRun2SPDTrks]) {
       float cSPD = 105.0f;
       if (Run2SPDTksInfo.mCalibrationStored) {
-        float spdm = collision.multTracklets() * Run2SPDTksInfo.mhVtxAmpCorr->GetBinContent(Run2SPDTksInfo.mhVtxAmpCorr->FindFixBin(collision.posZ()));
-        cSPD = Run2SPDTksInfo.mhMultSelCalib->GetBinContent(Run2SPDTksInfo.mhMultSelCalib->FindFixBin(spdm));
+        float spdm = collision.multTracklets() * Run2SPDTksInfo.mhVtxAmpCorr.getBinContent(collision.posZ());
+        cSPD = Run2SPDTksInfo.mhMultSelCalib.getBinContent(spdm);
       }
       LOGF(debug, "centSPDTracklets=%.0f", cSPD);
       centRun2SPDTracklets(cSPD);
@@ -330,9 +333,9 @@ struct CentralityTable {
     if (isTableEnabled[kCentRun2SPDClss]) {
       float cSPD = 105.0f;
       if (Run2SPDClsInfo.mCalibrationStored) {
-        float spdm = bc.spdClustersL0() * Run2SPDClsInfo.mhVtxAmpCorrCL0->GetBinContent(Run2SPDClsInfo.mhVtxAmpCorrCL0->FindFixBin(collision.posZ())) +
-                     bc.spdClustersL1() * Run2SPDClsInfo.mhVtxAmpCorrCL1->GetBinContent(Run2SPDClsInfo.mhVtxAmpCorrCL1->FindFixBin(collision.posZ()));
-        cSPD = Run2SPDClsInfo.mhMultSelCalib->GetBinContent(Run2SPDClsInfo.mhMultSelCalib->FindFixBin(spdm));
+        float spdm = bc.spdClustersL0() * Run2SPDClsInfo.mhVtxAmpCorrCL0.getBinContent(collision.posZ()) +
+                     bc.spdClustersL1() * Run2SPDClsInfo.mhVtxAmpCorrCL1.getBinContent(collision.posZ());
+        cSPD = Run2SPDClsInfo.mhMultSelCalib.getBinContent(spdm);
       }
       LOGF(debug, "centSPDClusters=%.0f", cSPD);
       centRun2SPDClusters(cSPD);
@@ -340,8 +343,8 @@ struct CentralityTable {
     if (isTableEnabled[kCentRun2CL0s]) {
       float cCL0 = 105.0f;
       if (Run2CL0Info.mCalibrationStored) {
-        float cl0m = bc.spdClustersL0() * Run2CL0Info.mhVtxAmpCorr->GetBinContent(Run2CL0Info.mhVtxAmpCorr->FindFixBin(collision.posZ()));
-        cCL0 = Run2CL0Info.mhMultSelCalib->GetBinContent(Run2CL0Info.mhMultSelCalib->FindFixBin(cl0m));
+        float cl0m = bc.spdClustersL0() * Run2CL0Info.mhVtxAmpCorr.getBinContent(collision.posZ());
+        cCL0 = Run2CL0Info.mhMultSelCalib.getBinContent(cl0m);
       }
       LOGF(debug, "centCL0=%.0f", cCL0);
       centRun2CL0(cCL0);
@@ -349,8 +352,8 @@ struct CentralityTable {
     if (isTableEnabled[kCentRun2CL1s]) {
       float cCL1 = 105.0f;
       if (Run2CL1Info.mCalibrationStored) {
-        float cl1m = bc.spdClustersL1() * Run2CL1Info.mhVtxAmpCorr->GetBinContent(Run2CL1Info.mhVtxAmpCorr->FindFixBin(collision.posZ()));
-        cCL1 = Run2CL1Info.mhMultSelCalib->GetBinContent(Run2CL1Info.mhMultSelCalib->FindFixBin(cl1m));
+        float cl1m = bc.spdClustersL1() * Run2CL1Info.mhVtxAmpCorr.getBinContent(collision.posZ());
+        cCL1 = Run2CL1Info.mhMultSelCalib.getBinContent(cl1m);
       }
       LOGF(debug, "centCL1=%.0f", cCL1);
       centRun2CL1(cCL1);
@@ -393,6 +396,8 @@ struct CentralityTable {
       /* check the previous run number */
       auto bc = collision.bc_as<BCsWithTimestamps>();
       if (bc.runNumber() != mRunNumber) {
+        // the collisions of the previous run are filled with its calibration
+        fillRun3Tables();
         LOGF(info, "timestamp=%llu, run number=%d", bc.timestamp(), bc.runNumber());
         TList* callst = ccdb->getForTimeStamp<TList>(ccdbPath, bc.timestamp());
 
@@ -405,9 +410,9 @@ struct CentralityTable {
         if (callst != nullptr) {
           LOGF(info, "Getting new histograms with %d run number for %d run number", mRunNumber, bc.runNumber());
           auto getccdb = [callst, bc](struct calibrationInfo& estimator, const Configurable<std::string> generatorName) { // TODO: to consider the name inside the estimator structure
-            estimator.mhMultSelCalib = reinterpret_cast<TH1*>(callst->FindObject(TString::Format("hCalibZeq%s", estimator.name.c_str()).Data()));
+            estimator.mhMultSelCalib.set(reinterpret_cast<TH1*>(callst->FindObject(TString::Format("hCalibZeq%s", estimator.name.c_str()).Data())));
             estimator.mMCScale = reinterpret_cast<TFormula*>(callst->FindObject(TString::Format("%s-%s", generatorName->c_str(), estimator.name.c_str()).Data()));
-            if (estimator.mhMultSelCalib != nullptr) {
+            if (estimator.mhMultSelCalib.isSet()) {
               if (generatorName->length() != 0) {
                 LOGF(info, "Retrieving MC calibration for %d, generator name: %s", bc.runNumber(), generatorName->c_str());
                 if (estimator.mMCScale != nullptr) {
@@ -461,54 +466,90 @@ struct CentralityTable {
         }
       }
 
-      auto populateTable = [](auto& table, struct calibrationInfo& estimator, float multiplicity, bool assignOutOfRange) {
-        auto scaleMC = [](float x, float pars[6]) {
-          return pow(((pars[0] + pars[1] * pow(x, pars[2])) - pars[3]) / pars[4], 1.0f / pars[5]);
-        };
-
-        float percentile = 105.0f;
-        float scaledMultiplicity = multiplicity;
-        if (estimator.mCalibrationStored) {
-          if (estimator.mMCScale != nullptr) {
-            scaledMultiplicity = scaleMC(multiplicity, estimator.mMCScalePars);
-            LOGF(debug, "Unscaled %s multiplicity: %f, scaled %s multiplicity: %f", estimator.name.c_str(), multiplicity, estimator.name.c_str(), scaledMultiplicity);
-          }
-          percentile = estimator.mhMultSelCalib->GetBinContent(estimator.mhMultSelCalib->FindFixBin(scaledMultiplicity));
-          if (assignOutOfRange)
-            percentile = 100.5f;
-        }
-        LOGF(debug, "%s centrality/multiplicity percentile = %.0f for a zvtx eq %s value %.0f", estimator.name.c_str(), percentile, estimator.name.c_str(), scaledMultiplicity);
-        table(percentile);
-      };
-
+      // the percentiles are evaluated estimator by estimator once all the collisions of the run are collected
       for (auto const& table : mEnabledTables) {
         switch (table) {
           case kCentFV0As:
-            populateTable(centFV0A, FV0AInfo, collision.multZeqFV0A(), collision.multNTracksPVeta1() < 1 && embedINELgtZEROselection);
+            mMultiplicities[table].push_back(collision.multZeqFV0A());
             break;
           case kCentFT0Ms:
-            populateTable(centFT0M, FT0MInfo, collision.multZeqFT0A() + collision.multZeqFT0C(), collision.multNTracksPVeta1() < 1 && embedINELgtZEROselection);
+            mMultiplicities[table].push_back(collision.multZeqFT0A() + collision.multZeqFT0C());
             break;
           case kCentFT0As:
-            populateTable(centFT0A, FT0AInfo, collision.multZeqFT0A(), collision.multNTracksPVeta1() < 1 && embedINELgtZEROselection);
+            mMultiplicities[table].push_back(collision.multZeqFT0A());
             break;
           case kCentFT0Cs:
-            populateTable(centFT0C, FT0CInfo, collision.multZeqFT0C(), collision.multNTracksPVeta1() < 1 && embedINELgtZEROselection);
+            mMultiplicities[table].push_back(collision.multZeqFT0C());
             break;
           case kCentFDDMs:
-            populateTable(centFDDM, FDDMInfo, collision.multZeqFDDA() + collision.multZeqFDDC(), collision.multNTracksPVeta1() < 1 && embedINELgtZEROselection);
+            mMultiplicities[table].push_back(collision.multZeqFDDA() + collision.multZeqFDDC());
             break;
           case kCentNTPVs:
-            populateTable(centNTPV, NTPVInfo, collision.multZeqNTracksPV(), collision.multNTracksPVeta1() < 1 && embedINELgtZEROselection);
+            mMultiplicities[table].push_back(collision.multZeqNTracksPV());
             break;
           default:
             LOGF(fatal, "Table %d not supported in Run3", table);
             break;
         }
       }
+      mAssignOutOfRange.push_back(collision.multNTracksPVeta1() < 1 && embedINELgtZEROselection);
     }
+    fillRun3Tables();
   }
   PROCESS_SWITCH(CentralityTable, processRun3, "Provide Run3 calibrated centrality/multiplicity percentiles tables", false);
+
+  /// Fills the percentiles of the collected collisions with the current calibrations, one estimator at a time
+  void fillRun3Tables()
+  {
+    auto populateTable = [this](auto& table, struct calibrationInfo& estimator, std::vector<float>& multiplicities) {
+      auto scaleMC = [](float x, float pars[6]) {
+        return pow(((pars[0] + pars[1] * pow(x, pars[2])) - pars[3]) / pars[4], 1.0f / pars[5]);
+      };
+
+      if (!estimator.mCalibrationStored) {
+        for (size_t iCollision = 0; iCollision < multiplicities.size(); iCollision++) {
+          table(105.0f);
+        }
+      } else if (estimator.mMCScale != nullptr) {
+        for (size_t iCollision = 0; iCollision < multiplicities.size(); iCollision++) {
+          float scaledMultiplicity = scaleMC(multiplicities[iCollision], estimator.mMCScalePars);
+          table(mAssignOutOfRange[iCollision] ? 100.5f : static_cast<float>(estimator.mhMultSelCalib.getBinContent(scaledMultiplicity)));
+        }
+      } else {
+        for (size_t iCollision = 0; iCollision < multiplicities.size(); iCollision++) {
+          table(mAssignOutOfRange[iCollision] ? 100.5f : static_cast<float>(estimator.mhMultSelCalib.getBinContent(multiplicities[iCollision])));
+        }
+      }
+      multiplicities.clear();
+    };
+
+    for (auto const& table : mEnabledTables) {
+      switch (table) {
+        case kCentFV0As:
+          populateTable(centFV0A, FV0AInfo, mMultiplicities[table]);
+          break;
+        case kCentFT0Ms:
+          populateTable(centFT0M, FT0MInfo, mMultiplicities[table]);
+          break;
+        case kCentFT0As:
+          populateTable(centFT0A, FT0AInfo, mMultiplicities[table]);
+          break;
+        case kCentFT0Cs:
+          populateTable(centFT0C, FT0CInfo, mMultiplicities[table]);
+          break;
+        case kCentFDDMs:
+          populateTable(centFDDM, FDDMInfo, mMultiplicities[table]);
+          break;
+        case kCentNTPVs:
+          populateTable(centNTPV, NTPVInfo, mMultiplicities[table]);
+          break;
+        default:
+          LOGF(fatal, "Table %d not supported in Run3", table);
+          break;
+      }
+    }
+    mAssignOutOfRange.clear();
+  }
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
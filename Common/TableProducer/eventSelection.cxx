@@ -16,6 +16,7 @@
 #include "Common/DataModel/EventSelection.h"
 #include "Common/CCDB/EventSelectionParams.h"
 #include "Common/CCDB/TriggerAliases.h"
+#include "Common/Core/ConditionCache.h"
 #include "CCDB/BasicCCDBManager.h"
 #include "CommonConstants/LHCConstants.h"
 #include "Framework/HistogramRegistry.h"
@@ -26,6 +27,11 @@
 
 #include "TH1D.h"
 
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
 using namespace o2;
 using namespace o2::framework;
 using namespace o2::aod::evsel;
@@ -36,6 +42,107 @@ using BCsWithBcSelsRun2 = soa::Join<aod::BCs, aod::Timestamps, aod::BcSels, aod:
 using BCsWithBcSelsRun3 = soa::Join<aod::BCs, aod::Timestamps, aod::BcSels>;
 using FullTracksIU = soa::Join<aod::TracksIU, aod::TracksExtra>;
 
+// Flat index of global BCs sorted in increasing order, for the BC searches of the event selection
+struct GlobalBCIndex {
+  std::vector<int64_t> globalBCs;
+  std::vector<int32_t> bcIds;
+
+  void clear()
+  {
+    globalBCs.clear();
+    bcIds.clear();
+  }
+  void add(int64_t globalBC, int32_t bcId)
+  {
+    globalBCs.push_back(globalBC);
+    bcIds.push_back(bcId);
+  }
+  // sorts the entries if they were not added in order; for a repeated global BC the last added bc is kept
+  void finalize()
+  {
+    if (!std::is_sorted(globalBCs.begin(), globalBCs.end())) {
+      std::vector<size_t> order(globalBCs.size());
+      std::iota(order.begin(), order.end(), 0);
+      std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) { return globalBCs[a] < globalBCs[b]; });
+      std::vector<int64_t> sortedBCs(order.size());
+      std::vector<int32_t> sortedIds(order.size());
+      for (size_t i = 0; i < order.size(); i++) {
+        sortedBCs[i] = globalBCs[order[i]];
+        sortedIds[i] = bcIds[order[i]];
+      }
+      globalBCs.swap(sortedBCs);
+      bcIds.swap(sortedIds);
+    }
+    size_t nUnique = 0;
+    for (size_t i = 0; i < globalBCs.size(); i++) {
+      if (nUnique > 0 && globalBCs[nUnique - 1] == globalBCs[i]) {
+        bcIds[nUnique - 1] = bcIds[i];
+        continue;
+      }
+      globalBCs[nUnique] = globalBCs[i];
+      bcIds[nUnique] = bcIds[i];
+      nUnique++;
+    }
+    globalBCs.resize(nUnique);
+    bcIds.resize(nUnique);
+  }
+  size_t size() const { return globalBCs.size(); }
+
+  // position of the first global BC >= globalBC, binary search without branches on the data
+  size_t lowerBound(int64_t globalBC) const
+  {
+    if (globalBCs.empty()) {
+      return 0;
+    }
+    const int64_t* base = globalBCs.data();
+    size_t n = globalBCs.size();
+    while (n > 1) {
+      size_t half = n / 2;
+      base = (base[half] < globalBC) ? base + half : base;
+      n -= half;
+    }
+    return (base - globalBCs.data()) + (*base < globalBC);
+  }
+
+  // bc id of the global BC, 0 if it is not in the index
+  int32_t find(int64_t globalBC) const
+  {
+    size_t i = lowerBound(globalBC);
+    return (i < globalBCs.size() && globalBCs[i] == globalBC) ? bcIds[i] : 0;
+  }
+
+  // position of the global BC closest to globalBC, the later one for equal distances
+  size_t findClosest(int64_t globalBC) const
+  {
+    size_t i = lowerBound(globalBC);
+    if (i == globalBCs.size()) {
+      return i - 1;
+    }
+    if (i > 0 && globalBC - globalBCs[i - 1] < globalBCs[i] - globalBC) {
+      return i - 1;
+    }
+    return i;
+  }
+
+  // For each search window [center - delta, center + delta] without a bc yet (bcIds < 0), the bc id
+  // of the global BC of the index closest to the center if it is within the window
+  void findClosestInWindows(std::vector<int64_t> const& centers, std::vector<int64_t> const& deltas, std::vector<int32_t>& foundBcIds) const
+  {
+    if (globalBCs.empty()) {
+      return;
+    }
+    for (size_t iWindow = 0; iWindow < centers.size(); iWindow++) {
+      if (foundBcIds[iWindow] >= 0) {
+        continue;
+      }
+      size_t i = findClosest(centers[iWindow]);
+      if (std::abs(globalBCs[i] - centers[iWindow]) <= deltas[iWindow]) {
+        foundBcIds[iWindow] = bcIds[i];
+      }
+    }
+  }
+};
+
 struct BcSelectionTask {
   Produces<aod::BcSels> bcsel;
   Service<o2::ccdb::BasicCCDBManager> ccdb;
@@ -47,6 +154,10 @@ struct BcSelectionTask {
 
   int lastRunNumber = -1;
   int64_t bcSOR = -1;     // global bc of the start of the first orbit
+  o2::analysis::ConditionCache::Handle<EventSelectionParams> evselParams;
+  o2::analysis::ConditionCache::Handle<TriggerAliases> triggerAliases;
+  o2::analysis::ConditionCache::Handle<o2::parameters::GRPLHCIFData> grpLHCIF;
+  GlobalBCIndex globalBCIndex; // all BCs of the time frame
   int64_t nBCsPerTF = -1; // duration of TF in bcs, should be 128*3564 or 32*3564
 
   void init(InitContext&)
@@ -55,6 +166,12 @@ struct BcSelectionTask {
     ccdb->setURL("http://alice-ccdb.cern.ch");
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
+    // objects queried for every BC, served by the condition cache
+    auto& conditions = o2::analysis::ConditionCache::instance();
+    conditions.setURL("http://alice-ccdb.cern.ch");
+    evselParams = conditions.subscribe<EventSelectionParams>("EventSelection/EventSelectionParams");
+    triggerAliases = conditions.subscribe<TriggerAliases>("EventSelection/TriggerAliases");
+    grpLHCIF = conditions.subscribe<o2::parameters::GRPLHCIFData>("GLO/Config/GRPLHCIF");
 
     histos.add("hCounterTVX", "", kTH1D, {{1, 0., 1.}});
     histos.add("hCounterTCE", "", kTH1D, {{1, 0., 1.}});
@@ -77,8 +194,8 @@ struct BcSelectionTask {
     bcsel.reserve(bcs.size());
 
     for (auto& bc : bcs) {
-      EventSelectionParams* par = ccdb->getForTimeStamp<EventSelectionParams>("EventSelection/EventSelectionParams", bc.timestamp());
-      TriggerAliases* aliases = ccdb->getForTimeStamp<TriggerAliases>("EventSelection/TriggerAliases", bc.timestamp());
+      EventSelectionParams* par = evselParams.get(bc.timestamp());
+      TriggerAliases* aliases = triggerAliases.get(bc.timestamp());
       // fill fired aliases
       uint32_t alias{0};
       uint64_t triggerMask = bc.triggerMask();
@@ -207,11 +324,12 @@ struct BcSelectionTask {
     int64_t ts = bcs.iteratorAt(0).timestamp();
     auto alppar = ccdb->getForTimeStamp<o2::itsmft::DPLAlpideParam<0>>("ITS/Config/AlpideParam", ts);
 
-    // map from GlobalBC to BcId needed to find triggerBc
-    std::map<uint64_t, int32_t> mapGlobalBCtoBcId;
+    // index from GlobalBC to BcId needed to find triggerBc
+    globalBCIndex.clear();
     for (auto& bc : bcs) {
-      mapGlobalBCtoBcId[bc.globalBC()] = bc.globalIndex();
+      globalBCIndex.add(bc.globalBC(), bc.globalIndex());
     }
+    globalBCIndex.finalize();
     int triggerBcShift = confTriggerBcShift;
     if (confTriggerBcShift == 999) {
       int run = bcs.iteratorAt(0).runNumber();
@@ -263,11 +381,11 @@ struct BcSelectionTask {
 
     // bc loop
     for (auto bc : bcs) {
-      EventSelectionParams* par = ccdb->getForTimeStamp<EventSelectionParams>("EventSelection/EventSelectionParams", bc.timestamp());
-      TriggerAliases* aliases = ccdb->getForTimeStamp<TriggerAliases>("EventSelection/TriggerAliases", bc.timestamp());
+      EventSelectionParams* par = evselParams.get(bc.timestamp());
+      TriggerAliases* aliases = triggerAliases.get(bc.timestamp());
       uint32_t alias{0};
       // workaround for pp2022 (trigger info is shifted by -294 bcs)
-      int32_t triggerBcId = mapGlobalBCtoBcId[bc.globalBC() + triggerBcShift];
+      int32_t triggerBcId = globalBCIndex.find(bc.globalBC() + triggerBcShift);
       if (triggerBcId) {
         auto triggerBc = bcs.iteratorAt(triggerBcId);
         uint64_t triggerMask = triggerBc.triggerMask();
@@ -354,7 +472,7 @@ struct BcSelectionTask {
 
       // Temporary workaround to get visible cross section. TODO: store run-by-run visible cross sections in CCDB
       const char* srun = Form("%d", run);
-      auto grplhcif = ccdb->getForTimeStamp<o2::parameters::GRPLHCIFData>("GLO/Config/GRPLHCIF", bc.timestamp());
+      auto grplhcif = grpLHCIF.get(bc.timestamp());
       int beamZ1 = grplhcif->getBeamZ(o2::constants::lhc::BeamA);
       int beamZ2 = grplhcif->getBeamZ(o2::constants::lhc::BeamC);
       bool isPP = beamZ1 == 1 && beamZ2 == 1;
@@ -412,20 +530,7 @@ struct EventSelectionTask {
 
   int lastRun = -1;                                          // last run number (needed to access ccdb only if run!=lastRun)
   std::bitset<o2::constants::lhc::LHCMaxBunches> bcPatternB; // bc pattern of colliding bunches
-
-  int32_t findClosest(int64_t globalBC, std::map<int64_t, int32_t>& bcs)
-  {
-    auto it = bcs.lower_bound(globalBC);
-    int64_t bc1 = it->first;
-    int32_t index1 = it->second;
-    if (it != bcs.begin())
-      --it;
-    int64_t bc2 = it->first;
-    int32_t index2 = it->second;
-    int64_t dbc1 = std::abs(bc1 - globalBC);
-    int64_t dbc2 = std::abs(bc2 - globalBC);
-    return (dbc1 <= dbc2) ? index1 : index2;
-  }
+  o2::analysis::ConditionCache::Handle<EventSelectionParams> evselParams;
 
   void init(InitContext&)
   {
@@ -433,6 +538,10 @@ struct EventSelectionTask {
     ccdb->setURL("http://alice-ccdb.cern.ch");
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
+    // objects queried for every collision, served by the condition cache
+    auto& conditions = o2::analysis::ConditionCache::instance();
+    conditions.setURL("http://alice-ccdb.cern.ch");
+    evselParams = conditions.subscribe<EventSelectionParams>("EventSelection/EventSelectionParams");
 
     histos.add("hColCounterAll", "", kTH1D, {{1, 0., 1.}});
     histos.add("hColCounterAcc", "", kTH1D, {{1, 0., 1.}});
@@ -446,7 +555,7 @@ struct EventSelectionTask {
   void processRun2(aod::Collision const& col, BCsWithBcSelsRun2 const& bcs, aod::Tracks const& tracks, aod::FV0Cs const&)
   {
     auto bc = col.bc_as<BCsWithBcSelsRun2>();
-    EventSelectionParams* par = ccdb->getForTimeStamp<EventSelectionParams>("EventSelection/EventSelectionParams", bc.timestamp());
+    EventSelectionParams* par = evselParams.get(bc.timestamp());
     bool* applySelection = par->GetSelection(muonSelection);
     if (isMC) {
       applySelection[kIsBBZAC] = 0;
@@ -515,7 +624,22 @@ struct EventSelectionTask {
   }
   PROCESS_SWITCH(EventSelectionTask, processRun2, "Process Run2 event selection", true);
 
-  Preslice<FullTracksIU> perCollision = aod::track::collisionId;
+  struct CollisionTrackCounters {
+    int nITStracks = 0;
+    int nTPCtracks = 0;
+    int nTOFtracks = 0;
+    int nTRDtracks = 0;
+    double timeFromTOFtracks = 0;
+    double timeFromTRDtracks = 0;
+  };
+  // buffers of processRun3, kept between time frames
+  GlobalBCIndex indexGlobalBcWithTVX;
+  GlobalBCIndex indexGlobalBcWithTOR;
+  std::vector<CollisionTrackCounters> colTrackCounters;
+  std::vector<int64_t> colMeanBC;
+  std::vector<int64_t> colDeltaBC;
+  std::vector<int32_t> colFoundBcId;
+
   void processRun3(aod::Collisions const& cols, FullTracksIU const& tracks, BCsWithBcSelsRun3 const& bcs)
   {
     int run = bcs.iteratorAt(0).runNumber();
@@ -527,10 +651,10 @@ struct EventSelectionTask {
       bcPatternB = grplhcif->getBunchFilling().getBCPattern();
     }
 
-    // create maps from globalBC to bc index for TVX or FT0-OR fired bcs
+    // create indices from globalBC to bc index for TVX or FT0-OR fired bcs
     // to be used for closest TVX (FT0-OR) searches
-    std::map<int64_t, int32_t> mapGlobalBcWithTVX;
-    std::map<int64_t, int32_t> mapGlobalBcWithTOR;
+    indexGlobalBcWithTVX.clear();
+    indexGlobalBcWithTOR.clear();
     for (auto& bc : bcs) {
       int64_t globalBC = bc.globalBC();
       // skip non-colliding bcs for data and anchored runs
@@ -538,15 +662,17 @@ struct EventSelectionTask {
         continue;
       }
       if (bc.selection_bit(kIsBBT0A) || bc.selection_bit(kIsBBT0C)) {
-        mapGlobalBcWithTOR[globalBC] = bc.globalIndex();
+        indexGlobalBcWithTOR.add(globalBC, bc.globalIndex());
       }
       if (bc.selection_bit(kIsTriggerTVX)) {
-        mapGlobalBcWithTVX[globalBC] = bc.globalIndex();
+        indexGlobalBcWithTVX.add(globalBC, bc.globalIndex());
       }
     }
+    indexGlobalBcWithTVX.finalize();
+    indexGlobalBcWithTOR.finalize();
 
     // protection against empty FT0 maps
-    if (mapGlobalBcWithTOR.size() == 0 || mapGlobalBcWithTVX.size() == 0) {
+    if (indexGlobalBcWithTOR.size() == 0 || indexGlobalBcWithTVX.size() == 0) {
       LOGP(error, "FT0 table is empty or corrupted. Filling evsel table with dummy values");
       for (auto& col : cols) {
         auto bc = col.bc_as<BCsWithBcSelsRun3>();
@@ -560,60 +686,59 @@ struct EventSelectionTask {
       return;
     }
 
+    // count PV contributors of different types in a single pass over the tracks
+    const int nCols = cols.size();
+    colTrackCounters.assign(nCols, CollisionTrackCounters{});
+    for (auto& track : tracks) {
+      if (!track.has_collision() || !track.isPVContributor()) {
+        continue;
+      }
+      auto& counters = colTrackCounters[track.collisionId()];
+      counters.nITStracks += track.hasITS();
+      counters.nTPCtracks += track.hasTPC();
+      counters.nTOFtracks += track.hasTOF();
+      counters.nTRDtracks += track.hasTRD() && !track.hasTOF();
+      // calculate average time using TOF and TRD tracks
+      if (track.hasTOF()) {
+        counters.timeFromTOFtracks += track.trackTime();
+      } else if (track.hasTRD()) {
+        counters.timeFromTRDtracks += track.trackTime();
+      }
+    }
+
+    // search regions of the collision bcs
+    const double bcNS = o2::constants::lhc::LHCBunchSpacingNS;
+    colMeanBC.resize(nCols);
+    colDeltaBC.resize(nCols);
     for (auto& col : cols) {
       auto bc = col.bc_as<BCsWithBcSelsRun3>();
+      auto const& counters = colTrackCounters[col.globalIndex()];
       int64_t meanBC = bc.globalBC();
-      const double bcNS = o2::constants::lhc::LHCBunchSpacingNS;
       int64_t deltaBC = std::ceil(col.collisionTimeRes() / bcNS * 4);
-
-      // count tracks of different types
-      int nITStracks = 0;
-      int nTPCtracks = 0;
-      int nTOFtracks = 0;
-      int nTRDtracks = 0;
-      double timeFromTOFtracks = 0;
-      double timeFromTRDtracks = 0;
-      auto tracksGrouped = tracks.sliceBy(perCollision, col.globalIndex());
-      for (auto& track : tracksGrouped) {
-        if (!track.isPVContributor()) {
-          continue;
-        }
-        nITStracks += track.hasITS();
-        nTPCtracks += track.hasTPC();
-        nTOFtracks += track.hasTOF();
-        nTRDtracks += track.hasTRD() && !track.hasTOF();
-        // calculate average time using TOF and TRD tracks
-        if (track.hasTOF()) {
-          timeFromTOFtracks += track.trackTime();
-        } else if (track.hasTRD()) {
-          timeFromTRDtracks += track.trackTime();
-        }
-      }
-      LOGP(debug, "nContrib={} nITStracks={} nTPCtracks={} nTOFtracks={} nTRDtracks={}", col.numContrib(), nITStracks, nTPCtracks, nTOFtracks, nTRDtracks);
-
-      if (nTRDtracks > 0) {
-        meanBC += TMath::Nint(timeFromTRDtracks / nTRDtracks / bcNS); // assign collision bc using TRD-matched tracks
-        deltaBC = 0;                                                  // use precise bc from TRD-matched tracks
-      } else if (nTOFtracks > 0) {
-        meanBC += TMath::FloorNint(timeFromTOFtracks / nTOFtracks / bcNS); // assign collision bc using TOF-matched tracks
-        deltaBC = 4;                                                       // use precise bc from TOF tracks with +/-4 bc margin
-      } else if (nTPCtracks > 0) {
+      LOGP(debug, "nContrib={} nITStracks={} nTPCtracks={} nTOFtracks={} nTRDtracks={}", col.numContrib(), counters.nITStracks, counters.nTPCtracks, counters.nTOFtracks, counters.nTRDtracks);
+
+      if (counters.nTRDtracks > 0) {
+        meanBC += TMath::Nint(counters.timeFromTRDtracks / counters.nTRDtracks / bcNS); // assign collision bc using TRD-matched tracks
+        deltaBC = 0;                                                                     // use precise bc from TRD-matched tracks
+      } else if (counters.nTOFtracks > 0) {
+        meanBC += TMath::FloorNint(counters.timeFromTOFtracks / counters.nTOFtracks / bcNS); // assign collision bc using TOF-matched tracks
+        deltaBC = 4;                                                                          // use precise bc from TOF tracks with +/-4 bc margin
+      } else if (counters.nTPCtracks > 0) {
         deltaBC += 30; // extend deltaBC for collisions built with ITS-TPC tracks only
       }
+      colMeanBC[col.globalIndex()] = meanBC;
+      colDeltaBC[col.globalIndex()] = deltaBC;
+    }
 
-      int64_t minBC = meanBC - deltaBC;
-      int64_t maxBC = meanBC + deltaBC;
-
-      int32_t indexClosestTVX = findClosest(meanBC, mapGlobalBcWithTVX);
-      int64_t tvxBC = bcs.iteratorAt(indexClosestTVX).globalBC();
-      if (tvxBC >= minBC && tvxBC <= maxBC) { // closest TVX within search region
-        bc.setCursor(indexClosestTVX);
-      } else { // no TVX within search region, searching for TOR = T0A | T0C
-        int32_t indexClosestTOR = findClosest(meanBC, mapGlobalBcWithTOR);
-        int64_t torBC = bcs.iteratorAt(indexClosestTOR).globalBC();
-        if (torBC >= minBC && torBC <= maxBC) {
-          bc.setCursor(indexClosestTOR);
-        }
+    // closest TVX within the search regions, then TOR = T0A | T0C for the collisions without TVX
+    colFoundBcId.assign(nCols, -1);
+    indexGlobalBcWithTVX.findClosestInWindows(colMeanBC, colDeltaBC, colFoundBcId);
+    indexGlobalBcWithTOR.findClosestInWindows(colMeanBC, colDeltaBC, colFoundBcId);
+
+    for (auto& col : cols) {
+      auto bc = col.bc_as<BCsWithBcSelsRun3>();
+      if (colFoundBcId[col.globalIndex()] >= 0) {
+        bc.setCursor(colFoundBcId[col.globalIndex()]);
       }
 
       int32_t foundBC = bc.globalIndex();
@@ -20,6 +20,7 @@
 #include "Framework/ASoAHelpers.h"
 #include "Framework/O2DatabasePDGPlugin.h"
 #include "Common/DataModel/TrackSelectionTables.h"
+#include "Common/Core/HistogramLookup.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -91,15 +92,28 @@ struct MultiplicityTableTaskIndexed {
   Configurable<std::string> ccdbUrl{"ccdburl", "http://alice-ccdb.cern.ch", "The CCDB endpoint url address"};
   Configurable<std::string> ccdbPath{"ccdbpath", "Centrality/Calibration", "The CCDB path for centrality/multiplicity information"};
 
+  // Vertex-Z equalisation of an estimator, copied from the calibration profile once per run
+  struct VertexZEqualisation {
+    o2::analysis::HistogramLookup mProfile;
+    double mReference = 1.; // profile value at z = 0
+    bool set(const TProfile* profile)
+    {
+      mProfile.set(profile);
+      mReference = mProfile.isSet() ? mProfile.interpolate(0.0) : 1.;
+      return mProfile.isSet();
+    }
+    float equalise(float multiplicity, float posZ) const { return mReference * multiplicity / mProfile.interpolate(posZ); }
+  };
+
   int mRunNumber;
   bool lCalibLoaded;
   TList* lCalibObjects;
-  TProfile* hVtxZFV0A;
-  TProfile* hVtxZFT0A;
-  TProfile* hVtxZFT0C;
-  TProfile* hVtxZFDDA;
-  TProfile* hVtxZFDDC;
-  TProfile* hVtxZNTracks;
+  VertexZEqualisation hVtxZFV0A;
+  VertexZEqualisation hVtxZFT0A;
+  VertexZEqualisation hVtxZFT0C;
+  VertexZEqualisation hVtxZFDDA;
+  VertexZEqualisation hVtxZFDDC;
+  VertexZEqualisation hVtxZNTracks;
   std::vector<int> mEnabledTables; // Vector of enabled tables
 
   unsigned int randomSeed = 0;
@@ -143,12 +157,6 @@ struct MultiplicityTableTaskIndexed {
     mRunNumber = 0;
     lCalibLoaded = false;
     lCalibObjects = nullptr;
-    hVtxZFV0A = nullptr;
-    hVtxZFT0A = nullptr;
-    hVtxZFT0C = nullptr;
-    hVtxZFDDA = nullptr;
-    hVtxZFDDC = nullptr;
-    hVtxZNTracks = nullptr;
 
     ccdb->setURL(ccdbUrl);
     ccdb->setCaching(true);
@@ -308,15 +316,16 @@ struct MultiplicityTableTaskIndexed {
           mRunNumber = bc.runNumber(); // mark this run as at least tried
           lCalibObjects = ccdb->getForTimeStamp<TList>(ccdbPath, bc.timestamp());
           if (lCalibObjects) {
-            hVtxZFV0A = static_cast<TProfile*>(lCalibObjects->FindObject("hVtxZFV0A"));
-            hVtxZFT0A = static_cast<TProfile*>(lCalibObjects->FindObject("hVtxZFT0A"));
-            hVtxZFT0C = static_cast<TProfile*>(lCalibObjects->FindObject("hVtxZFT0C"));
-            hVtxZFDDA = static_cast<TProfile*>(lCalibObjects->FindObject("hVtxZFDDA"));
-            hVtxZFDDC = static_cast<TProfile*>(lCalibObjects->FindObject("hVtxZFDDC"));
-            hVtxZNTracks = static_cast<TProfile*>(lCalibObjects->FindObject("hVtxZNTracksPV"));
+            // the profiles are copied into flat lookups, such that the list is only searched at the run change
+            bool lFV0A = hVtxZFV0A.set(static_cast<TProfile*>(lCalibObjects->FindObject("hVtxZFV0A")));
+            bool lFT0A = hVtxZFT0A.set(static_cast<TProfile*>(lCalibObjects->FindObject("hVtxZFT0A")));
+            bool lFT0C = hVtxZFT0C.set(static_cast<TProfile*>(lCalibObjects->FindObject("hVtxZFT0C")));
+            bool lFDDA = hVtxZFDDA.set(static_cast<TProfile*>(lCalibObjects->FindObject("hVtxZFDDA")));
+            bool lFDDC = hVtxZFDDC.set(static_cast<TProfile*>(lCalibObjects->FindObject("hVtxZFDDC")));
+            bool lNTracks = hVtxZNTracks.set(static_cast<TProfile*>(lCalibObjects->FindObject("hVtxZNTracksPV")));
             lCalibLoaded = true;
             // Capture error
-            if (!hVtxZFV0A || !hVtxZFT0A || !hVtxZFT0C || !hVtxZFDDA || !hVtxZFDDC || !hVtxZNTracks) {
+            if (!lFV0A || !lFT0A || !lFT0C || !lFDDA || !lFDDC || !lNTracks) {
               LOGF(error, "Problem loading CCDB objects! Please check");
               lCalibLoaded = false;
             }
@@ -487,12 +496,12 @@ struct MultiplicityTableTaskIndexed {
           case kMultZeqs: // Z equalized
           {
             if (fabs(collision.posZ()) < 15.0f && lCalibLoaded) {
-              multZeqFV0A = hVtxZFV0A->Interpolate(0.0) * multFV0A / hVtxZFV0A->Interpolate(collision.posZ());
-              multZeqFT0A = hVtxZFT0A->Interpolate(0.0) * multFT0A / hVtxZFT0A->Interpolate(collision.posZ());
-              multZeqFT0C = hVtxZFT0C->Interpolate(0.0) * multFT0C / hVtxZFT0C->Interpolate(collision.posZ());
-              multZeqFDDA = hVtxZFDDA->Interpolate(0.0) * multFDDA / hVtxZFDDA->Interpolate(collision.posZ());
-              multZeqFDDC = hVtxZFDDC->Interpolate(0.0) * multFDDC / hVtxZFDDC->Interpolate(collision.posZ());
-              multZeqNContribs = hVtxZNTracks->Interpolate(0.0) * multNContribs / hVtxZNTracks->Interpolate(collision.posZ());
+              multZeqFV0A = hVtxZFV0A.equalise(multFV0A, collision.posZ());
+              multZeqFT0A = hVtxZFT0A.equalise(multFT0A, collision.posZ());
+              multZeqFT0C = hVtxZFT0C.equalise(multFT0C, collision.posZ());
+              multZeqFDDA = hVtxZFDDA.equalise(multFDDA, collision.posZ());
+              multZeqFDDC = hVtxZFDDC.equalise(multFDDC, collision.posZ());
+              multZeqNContribs = hVtxZNTracks.equalise(multNContribs, collision.posZ());
             }
             tableMultZeq(multZeqFV0A, multZeqFT0A, multZeqFT0C, multZeqFDDA, multZeqFDDC, multZeqNContribs);
           } break;
@@ -22,7 +22,6 @@
 #include <chrono>
 #include <string>
 #include <vector>
-#include <TComplex.h>
 #include <TMath.h>
 
 // o2Physics includes.
@@ -124,6 +123,10 @@ struct qVectorsTable {
   std::vector<float> FT0RelGainConst;
   std::vector<float> FV0RelGainConst;
 
+  // Channels of FIT with their gain-equalised amplitudes for the current event.
+  std::vector<int> fitChannels;
+  std::vector<float> fitAmplitudes;
+
   // Variables for other classes.
   EventPlaneHelper helperEP;
 
@@ -153,6 +156,9 @@ struct qVectorsTable {
     histosQA.add("FT0AmpCor", "", {HistType::kTH2F, {axisFITamp, axisChID}});
     histosQA.add("FV0Amp", "", {HistType::kTH2F, {axisFITamp, axisChID}});
     histosQA.add("FV0AmpCor", "", {HistType::kTH2F, {axisFITamp, axisChID}});
+
+    // The Q-vectors of FIT are calculated from the tabulated harmonics of the channels.
+    helperEP.SetHarmonics({cfgnMod});
   }
 
   void initCCDB(aod::BCsWithTimestamps::iterator const& bc)
@@ -372,8 +378,10 @@ struct qVectorsTable {
     float qVectBPos[2] = {0.};
     float qVectBNeg[2] = {0.};
 
-    TComplex QvecDet(0); // Complex value of the Q-vector for any detector.
-    TComplex QvecFT0M(0);
+    double qFT0ARe = 0., qFT0AIm = 0.; // Q-vectors of FIT before normalisation.
+    double qFT0CRe = 0., qFT0CIm = 0.;
+    double qFT0MRe = 0., qFT0MIm = 0.;
+    double qFV0ARe = 0., qFV0AIm = 0.;
     float sumAmplFT0A = 0.; // Sum of the amplitudes of all non-dead channels in any detector.
     float sumAmplFT0C = 0.;
     float sumAmplFT0M = 0.;
@@ -385,8 +393,10 @@ struct qVectorsTable {
     if (coll.has_foundFT0()) {
       auto ft0 = coll.foundFT0();
 
-      // Iterate over the non-dead channels for FT0-A to get the total Q-vector
-      // and sum of amplitudes.
+      // Collect the non-dead channels for FT0-A with their gain-equalised amplitudes,
+      // then get the total Q-vector and sum of amplitudes using the helper function.
+      fitChannels.clear();
+      fitAmplitudes.clear();
       for (std::size_t iChA = 0; iChA < ft0.channelA().size(); iChA++) {
         // Get first the corresponding amplitude.
         float ampl = ft0.amplitudeA()[iChA];
@@ -394,18 +404,17 @@ struct qVectorsTable {
 
         histosQA.fill(HIST("FT0Amp"), ampl, FT0AchId);
         histosQA.fill(HIST("FT0AmpCor"), ampl / FT0RelGainConst[FT0AchId], FT0AchId);
-        // Update the Q-vector and sum of amplitudes using the helper function.
-        // LOKI: Note this assumes nHarmo = 2!! Likely generalise in the future.
-        helperEP.SumQvectors(0, FT0AchId, ampl / FT0RelGainConst[FT0AchId], cfgnMod, QvecDet, sumAmplFT0A);
-        helperEP.SumQvectors(0, FT0AchId, ampl / FT0RelGainConst[FT0AchId], cfgnMod, QvecFT0M, sumAmplFT0M);
+        fitChannels.push_back(FT0AchId);
+        fitAmplitudes.push_back(ampl / FT0RelGainConst[FT0AchId]);
       } // Go to the next channel iChA.
+      helperEP.SumQvectorsHarmonics(0, fitChannels.size(), fitChannels.data(), fitAmplitudes.data(), &qFT0ARe, &qFT0AIm, sumAmplFT0A);
+      helperEP.SumQvectorsHarmonics(0, fitChannels.size(), fitChannels.data(), fitAmplitudes.data(), &qFT0MRe, &qFT0MIm, sumAmplFT0M);
 
       // Set the Qvectors for FT0A with the normalised Q-vector values if the sum of
       // amplitudes is non-zero. Otherwise, set it to a dummy 999.
       if (sumAmplFT0A > 1e-8) {
-        QvecDet /= sumAmplFT0A;
-        qVectFT0A[0] = QvecDet.Re();
-        qVectFT0A[1] = QvecDet.Im();
+        qVectFT0A[0] = qFT0ARe / sumAmplFT0A;
+        qVectFT0A[1] = qFT0AIm / sumAmplFT0A;
         // printf("qVectFT0A[0] = %.2f ; qVectFT0A[1] = %.2f \n", qVectFT0A[0], qVectFT0A[1]); // Debug printing.
       } else {
         qVectFT0A[0] = 999.;
@@ -413,8 +422,8 @@ struct qVectorsTable {
       }
 
       // Repeat the procedure with FT0-C for the found FT0.
-      // Start by resetting to zero the intermediate quantities.
-      QvecDet = TComplex(0., 0.);
+      fitChannels.clear();
+      fitAmplitudes.clear();
       for (std::size_t iChC = 0; iChC < ft0.channelC().size(); iChC++) {
         // iChC ranging from 0 to max 112. We need to add 96 (= max channels in FT0-A)
         // to ensure a proper channel number in FT0 as a whole.
@@ -423,15 +432,15 @@ struct qVectorsTable {
 
         histosQA.fill(HIST("FT0Amp"), ampl, FT0CchId);
         histosQA.fill(HIST("FT0AmpCor"), ampl / FT0RelGainConst[FT0CchId], FT0CchId);
-
-        helperEP.SumQvectors(0, FT0CchId, ampl / FT0RelGainConst[FT0CchId], cfgnMod, QvecDet, sumAmplFT0C);
-        helperEP.SumQvectors(0, FT0CchId, ampl / FT0RelGainConst[FT0CchId], cfgnMod, QvecFT0M, sumAmplFT0M);
+        fitChannels.push_back(FT0CchId);
+        fitAmplitudes.push_back(ampl / FT0RelGainConst[FT0CchId]);
       }
+      helperEP.SumQvectorsHarmonics(0, fitChannels.size(), fitChannels.data(), fitAmplitudes.data(), &qFT0CRe, &qFT0CIm, sumAmplFT0C);
+      helperEP.SumQvectorsHarmonics(0, fitChannels.size(), fitChannels.data(), fitAmplitudes.data(), &qFT0MRe, &qFT0MIm, sumAmplFT0M);
 
       if (sumAmplFT0C > 1e-8) {
-        QvecDet /= sumAmplFT0C;
-        qVectFT0C[0] = QvecDet.Re();
-        qVectFT0C[1] = QvecDet.Im();
+        qVectFT0C[0] = qFT0CRe / sumAmplFT0C;
+        qVectFT0C[1] = qFT0CIm / sumAmplFT0C;
         // printf("qVectFT0C[0] = %.2f ; qVectFT0C[1] = %.2f \n", qVectFT0C[0], qVectFT0C[1]); // Debug printing.
       } else {
         qVectFT0C[0] = 999.;
@@ -439,9 +448,8 @@ struct qVectorsTable {
       }
 
       if (sumAmplFT0M > 1e-8) {
-        QvecFT0M /= sumAmplFT0M;
-        qVectFT0M[0] = QvecFT0M.Re();
-        qVectFT0M[1] = QvecFT0M.Im();
+        qVectFT0M[0] = qFT0MRe / sumAmplFT0M;
+        qVectFT0M[1] = qFT0MIm / sumAmplFT0M;
       } else {
         qVectFT0M[0] = 999.;
         qVectFT0M[1] = 999.;
@@ -455,25 +463,25 @@ struct qVectorsTable {
       qVectFT0M[1] = -999.;
     }
 
-    QvecDet = TComplex(0., 0.);
-    sumAmplFV0A = 0;
     if (coll.has_foundFV0()) {
       auto fv0 = coll.foundFV0();
 
+      fitChannels.clear();
+      fitAmplitudes.clear();
       for (std::size_t iCh = 0; iCh < fv0.channel().size(); iCh++) {
         float ampl = fv0.amplitude()[iCh];
         int FV0AchId = fv0.channel()[iCh];
 
         histosQA.fill(HIST("FV0Amp"), ampl, FV0AchId);
         histosQA.fill(HIST("FV0AmpCor"), ampl / FV0RelGainConst[FV0AchId], FV0AchId);
-
-        helperEP.SumQvectors(1, FV0AchId, ampl / FV0RelGainConst[FV0AchId], cfgnMod, QvecDet, sumAmplFV0A);
+        fitChannels.push_back(FV0AchId);
+        fitAmplitudes.push_back(ampl / FV0RelGainConst[FV0AchId]);
       }
+      helperEP.SumQvectorsHarmonics(1, fitChannels.size(), fitChannels.data(), fitAmplitudes.data(), &qFV0ARe, &qFV0AIm, sumAmplFV0A);
 
       if (sumAmplFV0A > 1e-8) {
-        QvecDet /= sumAmplFV0A;
-        qVectFV0A[0] = QvecDet.Re();
-        qVectFV0A[1] = QvecDet.Im();
+        qVectFV0A[0] = qFV0ARe / sumAmplFV0A;
+        qVectFV0A[1] = qFV0AIm / sumAmplFV0A;
         // printf("qVectFV0[0] = %.2f ; qVectFV0[1] = %.2f \n", qVectFV0[0], qVectFV0[1]); // Debug printing.
       } else {
         qVectFV0A[0] = 999.;
@@ -15,6 +15,7 @@
 
 #include "TableHelper.h"
 #include "Common/Tools/TrackTuner.h"
+#include "Common/Core/ParallelTrackPropagation.h"
 
 // The Run 3 AO2D stores the tracks at the point of innermost update. For a track with ITS this is the innermost (or second innermost)
 // ITS layer. For a track without ITS, this is the TPC inner wall or for loopers in the TPC even a radius beyond that.
@@ -57,6 +58,8 @@ struct TrackPropagation {
   Configurable<std::string> grpmagPath{"grpmagPath", "GLO/Config/GRPMagField", "CCDB path of the GRPMagField object"};
   Configurable<std::string> mVtxPath{"mVtxPath", "GLO/Calib/MeanVertex", "Path of the mean vertex file"};
   Configurable<float> minPropagationRadius{"minPropagationDistance", o2::constants::geom::XTPCInnerRef + 0.1, "Only tracks which are at a smaller radius will be propagated, defaults to TPC inner wall"};
+  Configurable<int> nThreads{"nThreads", 1, "Number of threads for the propagation (1: sequential, 0: number of hardware threads)"};
+  Configurable<int> propagationChunkSize{"propagationChunkSize", 256, "Number of tracks handed to a thread at once in the multi-threaded propagation"};
   // for TrackTuner only (MC smearing)
   Configurable<bool> useTrackTuner{"useTrackTuner", false, "Apply Improver/DCA corrections to MC"};
   Configurable<std::string> trackTunerParams{"trackTunerParams", "debugInfo=0|updateTrackCovMat=1|updateCurvature=0|updatePulls=0|isInputFileFromCCDB=1|pathInputFile=Users/m/mfaggin/test/inputsTrackTuner/PbPb2022|nameInputFile=trackTuner_DataLHC22sPass5_McLHC22l1b2_run529397.root|usePvRefitCorrections=0|oneOverPtCurrent=0|oneOverPtUpgr=0", "TrackTuner parameter initialization (format: <name>=<value>|<name>=<value>)"};
@@ -133,10 +136,18 @@ struct TrackPropagation {
   o2::track::TrackParametrization<float> mTrackPar;
   o2::track::TrackParametrizationWithError<float> mTrackParCov;
 
+  // Buffers of the multi-threaded propagation, one entry per track
+  std::vector<o2::track::TrackParametrization<float>> mTrackPars;
+  std::vector<o2::track::TrackParametrizationWithError<float>> mTrackParCovs;
+  std::vector<gpu::gpustd::array<float, 2>> mDcaInfos;
+  std::vector<o2::dataformats::DCA> mDcaInfoCovs;
+  std::vector<int> mVertexIndices; // index in mVertices, -1 for the tracks which are not propagated
+  std::vector<o2::dataformats::VertexBase> mVertices;
+
   template <typename TTrack, typename TParticle, bool isMc, bool fillCovMat = false, bool useTrkPid = false>
   void fillTrackTables(TTrack const& tracks,
                        TParticle const& mcParticles,
-                       aod::Collisions const&,
+                       aod::Collisions const& collisions,
                        aod::BCsWithTimestamps const& bcs)
   {
     if (bcs.size() == 0) {
@@ -158,6 +169,11 @@ struct TrackPropagation {
       }
     }
 
+    if (nThreads != 1) {
+      fillTrackTablesParallel<TTrack, TParticle, isMc, fillCovMat, useTrkPid>(tracks, mcParticles, collisions);
+      return;
+    }
+
     for (auto& track : tracks) {
       if constexpr (fillCovMat) {
         if (fillTracksDCA || fillTracksDCACov) {
@@ -219,28 +235,115 @@ struct TrackPropagation {
         trackType = aod::track::Track;
       }
       if constexpr (fillCovMat) {
-        tracksParPropagated(track.collisionId(), trackType, mTrackParCov.getX(), mTrackParCov.getAlpha(), mTrackParCov.getY(), mTrackParCov.getZ(), mTrackParCov.getSnp(), mTrackParCov.getTgl(), mTrackParCov.getQ2Pt());
-        tracksParExtensionPropagated(mTrackParCov.getPt(), mTrackParCov.getP(), mTrackParCov.getEta(), mTrackParCov.getPhi());
-        // TODO do we keep the rho as 0? Also the sigma's are duplicated information
-        tracksParCovPropagated(std::sqrt(mTrackParCov.getSigmaY2()), std::sqrt(mTrackParCov.getSigmaZ2()), std::sqrt(mTrackParCov.getSigmaSnp2()),
-                               std::sqrt(mTrackParCov.getSigmaTgl2()), std::sqrt(mTrackParCov.getSigma1Pt2()), 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
-        tracksParCovExtensionPropagated(mTrackParCov.getSigmaY2(), mTrackParCov.getSigmaZY(), mTrackParCov.getSigmaZ2(), mTrackParCov.getSigmaSnpY(),
-                                        mTrackParCov.getSigmaSnpZ(), mTrackParCov.getSigmaSnp2(), mTrackParCov.getSigmaTglY(), mTrackParCov.getSigmaTglZ(), mTrackParCov.getSigmaTglSnp(),
-                                        mTrackParCov.getSigmaTgl2(), mTrackParCov.getSigma1PtY(), mTrackParCov.getSigma1PtZ(), mTrackParCov.getSigma1PtSnp(), mTrackParCov.getSigma1PtTgl(),
-                                        mTrackParCov.getSigma1Pt2());
-        if (fillTracksDCA) {
-          tracksDCA(mDcaInfoCov.getY(), mDcaInfoCov.getZ());
-        }
-        if (fillTracksDCACov) {
-          tracksDCACov(mDcaInfoCov.getSigmaY2(), mDcaInfoCov.getSigmaZ2());
+        fillTrackRow<fillCovMat>(track.collisionId(), trackType, mTrackParCov, mDcaInfoCov);
+      } else {
+        fillTrackRow<fillCovMat>(track.collisionId(), trackType, mTrackPar, mDcaInfo);
+      }
+    }
+  }
+
+  // Multi-threaded version of fillTrackTables: the track parameters and their vertices are collected
+  // in flat buffers, the propagation runs on nThreads threads and the tables are filled in the track order
+  template <typename TTrack, typename TParticle, bool isMc, bool fillCovMat = false, bool useTrkPid = false>
+  void fillTrackTablesParallel(TTrack const& tracks,
+                               TParticle const& mcParticles,
+                               aod::Collisions const& collisions)
+  {
+    const int nTracks = tracks.size();
+    // collision vertices, indexed by the collision id, followed by the mean vertex
+    mVertices.clear();
+    mVertices.reserve(collisions.size() + 1);
+    for (auto const& collision : collisions) {
+      mVertices.emplace_back(getPrimaryVertex(collision));
+    }
+    mVtx.setPos({mMeanVtx->getX(), mMeanVtx->getY(), mMeanVtx->getZ()});
+    mVtx.setCov(mMeanVtx->getSigmaX() * mMeanVtx->getSigmaX(), 0.0f, mMeanVtx->getSigmaY() * mMeanVtx->getSigmaY(), 0.0f, 0.0f, mMeanVtx->getSigmaZ() * mMeanVtx->getSigmaZ());
+    mVertices.push_back(mVtx);
+    const int meanVertexIndex = mVertices.size() - 1;
+
+    mVertexIndices.resize(nTracks);
+    if constexpr (fillCovMat) {
+      mTrackParCovs.resize(nTracks);
+      mDcaInfoCovs.resize(nTracks);
+    } else {
+      mTrackPars.resize(nTracks);
+      mDcaInfos.resize(nTracks);
+    }
+
+    int iTrack = 0;
+    for (auto& track : tracks) {
+      if constexpr (fillCovMat) {
+        mDcaInfoCovs[iTrack].set(999, 999, 999, 999, 999);
+        setTrackParCov(track, mTrackParCovs[iTrack]);
+        if constexpr (useTrkPid) {
+          mTrackParCovs[iTrack].setPID(track.pidForTracking());
         }
       } else {
-        tracksParPropagated(track.collisionId(), trackType, mTrackPar.getX(), mTrackPar.getAlpha(), mTrackPar.getY(), mTrackPar.getZ(), mTrackPar.getSnp(), mTrackPar.getTgl(), mTrackPar.getQ2Pt());
-        tracksParExtensionPropagated(mTrackPar.getPt(), mTrackPar.getP(), mTrackPar.getEta(), mTrackPar.getPhi());
-        if (fillTracksDCA) {
-          tracksDCA(mDcaInfo[0], mDcaInfo[1]);
+        mDcaInfos[iTrack][0] = 999;
+        mDcaInfos[iTrack][1] = 999;
+        setTrackPar(track, mTrackPars[iTrack]);
+        if constexpr (useTrkPid) {
+          mTrackPars[iTrack].setPID(track.pidForTracking());
         }
       }
+      mVertexIndices[iTrack] = -1;
+      // Only propagate tracks which have passed the innermost wall of the TPC (e.g. skipping loopers etc). Others fill unpropagated.
+      if (track.trackType() == aod::track::TrackIU && track.x() < minPropagationRadius) {
+        if constexpr (isMc && fillCovMat) { /// track tuner ok only if cov. matrix is used, it fills a histogram so it runs here in the track order
+          if (useTrackTuner) {
+            trackTunedTracks->Fill(1); // all tracks
+            if (track.has_mcParticle()) {
+              auto mcParticle = track.mcParticle();
+              trackTunerObj.tuneTrackParams(mcParticle, mTrackParCovs[iTrack], matCorr, &mDcaInfoCovs[iTrack], trackTunedTracks);
+            }
+          }
+        }
+        mVertexIndices[iTrack] = track.has_collision() ? track.collisionId() : meanVertexIndex;
+      }
+      iTrack++;
+    }
+
+    if constexpr (fillCovMat) {
+      track_propagation::propagateToVertices(mTrackParCovs, mDcaInfoCovs, mVertexIndices, mVertices, 2.f, matCorr, nThreads, propagationChunkSize);
+    } else {
+      track_propagation::propagateToVertices(mTrackPars, mDcaInfos, mVertexIndices, mVertices, 2.f, matCorr, nThreads, propagationChunkSize);
+    }
+
+    iTrack = 0;
+    for (auto& track : tracks) {
+      aod::track::TrackTypeEnum trackType = mVertexIndices[iTrack] >= 0 ? aod::track::Track : (aod::track::TrackTypeEnum)track.trackType();
+      if constexpr (fillCovMat) {
+        fillTrackRow<fillCovMat>(track.collisionId(), trackType, mTrackParCovs[iTrack], mDcaInfoCovs[iTrack]);
+      } else {
+        fillTrackRow<fillCovMat>(track.collisionId(), trackType, mTrackPars[iTrack], mDcaInfos[iTrack]);
+      }
+      iTrack++;
+    }
+  }
+
+  template <bool fillCovMat, typename TTrackPar, typename TDcaInfo>
+  void fillTrackRow(int collisionId, aod::track::TrackTypeEnum trackType, TTrackPar const& trackPar, TDcaInfo const& dcaInfo)
+  {
+    tracksParPropagated(collisionId, trackType, trackPar.getX(), trackPar.getAlpha(), trackPar.getY(), trackPar.getZ(), trackPar.getSnp(), trackPar.getTgl(), trackPar.getQ2Pt());
+    tracksParExtensionPropagated(trackPar.getPt(), trackPar.getP(), trackPar.getEta(), trackPar.getPhi());
+    if constexpr (fillCovMat) {
+      // TODO do we keep the rho as 0? Also the sigma's are duplicated information
+      tracksParCovPropagated(std::sqrt(trackPar.getSigmaY2()), std::sqrt(trackPar.getSigmaZ2()), std::sqrt(trackPar.getSigmaSnp2()),
+                             std::sqrt(trackPar.getSigmaTgl2()), std::sqrt(trackPar.getSigma1Pt2()), 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+      tracksParCovExtensionPropagated(trackPar.getSigmaY2(), trackPar.getSigmaZY(), trackPar.getSigmaZ2(), trackPar.getSigmaSnpY(),
+                                      trackPar.getSigmaSnpZ(), trackPar.getSigmaSnp2(), trackPar.getSigmaTglY(), trackPar.getSigmaTglZ(), trackPar.getSigmaTglSnp(),
+                                      trackPar.getSigmaTgl2(), trackPar.getSigma1PtY(), trackPar.getSigma1PtZ(), trackPar.getSigma1PtSnp(), trackPar.getSigma1PtTgl(),
+                                      trackPar.getSigma1Pt2());
+      if (fillTracksDCA) {
+        tracksDCA(dcaInfo.getY(), dcaInfo.getZ());
+      }
+      if (fillTracksDCACov) {
+        tracksDCACov(dcaInfo.getSigmaY2(), dcaInfo.getSigmaZ2());
+      }
+    } else {
+      if (fillTracksDCA) {
+        tracksDCA(dcaInfo[0], dcaInfo[1]);
+      }
     }
   }
 
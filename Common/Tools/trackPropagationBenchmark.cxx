@@ -0,0 +1,97 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file trackPropagationBenchmark.cxx
+/// \brief Throughput of the multi-threaded propagation of tracks to their vertices versus the number of threads
+///        Usage: o2-analysis-track-propagation-benchmark [number of tracks] [maximum number of threads] [material LUT file]
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DataFormatsParameters/GRPMagField.h"
+#include "DetectorsBase/MatLayerCylSet.h"
+#include "Common/Core/ParallelTrackPropagation.h"
+
+int main(int argc, char* argv[])
+{
+  const int nTracks = argc > 1 ? std::atoi(argv[1]) : 200000;
+  const int maxThreads = argc > 2 ? std::atoi(argv[2]) : std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+  const std::string lutFile = argc > 3 ? argv[3] : "";
+
+  // nominal solenoid field
+  o2::parameters::GRPMagField grpmag;
+  grpmag.setL3Current(30000.f);
+  grpmag.setDipoleCurrent(6000.f);
+  grpmag.setFieldUniformity(false);
+  o2::base::Propagator::initFieldFromGRP(&grpmag);
+  auto matCorr = o2::base::Propagator::MatCorrType::USEMatCorrNONE;
+  if (!lutFile.empty()) {
+    o2::base::Propagator::Instance()->setMatLUT(o2::base::MatLayerCylSet::loadFromFile(lutFile));
+    matCorr = o2::base::Propagator::MatCorrType::USEMatCorrLUT;
+  }
+
+  // tracks at the innermost ITS layer, attached to one of the vertices around the nominal interaction point
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> uniform(-1., 1.);
+  std::exponential_distribution<float> ptDist(1.);
+  std::vector<o2::dataformats::VertexBase> vertices(100);
+  for (auto& vertex : vertices) {
+    vertex.setPos({0.01f * uniform(generator), 0.01f * uniform(generator), 10.f * uniform(generator)});
+    vertex.setCov(1e-4f, 0.f, 1e-4f, 0.f, 0.f, 1e-4f);
+  }
+  std::uniform_int_distribution<int> vertexDist(0, vertices.size() - 1);
+  std::vector<o2::track::TrackParametrizationWithError<float>> inputTracks(nTracks);
+  std::vector<int> vertexIndices(nTracks);
+  for (int i = 0; i < nTracks; i++) {
+    const float alpha = M_PI * uniform(generator);
+    const float q2pt = (uniform(generator) > 0 ? 1.f : -1.f) / (0.15f + ptDist(generator));
+    std::array<float, o2::track::kNParams> par{0.1f * uniform(generator), 10.f * uniform(generator), 0.2f * uniform(generator), uniform(generator), q2pt};
+    std::array<float, o2::track::kCovMatSize> cov{1e-4f, 0.f, 1e-4f, 0.f, 0.f, 1e-5f, 0.f, 0.f, 0.f, 1e-5f, 0.f, 0.f, 0.f, 0.f, 1e-4f};
+    inputTracks[i] = o2::track::TrackParametrizationWithError<float>(2.3f, alpha, par, cov);
+    vertexIndices[i] = vertexDist(generator);
+  }
+
+  using clock = std::chrono::steady_clock;
+  std::vector<o2::track::TrackParametrizationWithError<float>> referenceTracks;
+  std::vector<o2::track::TrackParametrizationWithError<float>> tracks;
+  std::vector<o2::dataformats::DCA> dcas(nTracks);
+  size_t nDiffTotal = 0;
+  std::cout << "Tracks: " << nTracks << ", material correction: " << (lutFile.empty() ? "none" : lutFile) << std::endl;
+  for (int nThreads = 1; nThreads <= maxThreads; nThreads *= 2) {
+    tracks = inputTracks;
+    auto start = clock::now();
+    track_propagation::propagateToVertices(tracks, dcas, vertexIndices, vertices, 2.f, matCorr, nThreads);
+    std::chrono::duration<double> time = clock::now() - start;
+
+    // the result must not depend on the number of threads
+    size_t nDiff = 0;
+    if (referenceTracks.empty()) {
+      referenceTracks = tracks;
+    } else {
+      for (int i = 0; i < nTracks; i++) {
+        nDiff += (tracks[i].getX() != referenceTracks[i].getX() || tracks[i].getY() != referenceTracks[i].getY() || tracks[i].getZ() != referenceTracks[i].getZ() ||
+                  tracks[i].getSnp() != referenceTracks[i].getSnp() || tracks[i].getTgl() != referenceTracks[i].getTgl() || tracks[i].getQ2Pt() != referenceTracks[i].getQ2Pt());
+      }
+    }
+    nDiffTotal += nDiff;
+    std::cout << "Threads: " << nThreads << ", " << time.count() << " s (" << nTracks / time.count() << " tracks/s), " << nDiff << " different tracks" << std::endl;
+  }
+
+  return nDiffTotal == 0 ? 0 : 1;
+}
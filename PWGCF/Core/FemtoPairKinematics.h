@@ -0,0 +1,244 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file FemtoPairKinematics.h
+/// \brief Pair kinematics of the femtoscopy frameworks (k*, kT, mT, q out/side/long) from Cartesian four-momenta
+///
+/// The four-momenta are computed once per particle from pt, eta, phi and mass, as ROOT::Math::PtEtaPhiMVector does.
+/// The pair quantities are then closed formulas of the components, without building vectors and boosts:
+/// - k* = |q*| / 2, q = p1 - p2 in the pair rest frame, from the invariant |q*|^2 = (q.P)^2 / P^2 - q^2 with P = p1 + p2
+/// - kT = |pT1 + pT2| / 2 and mT = sqrt(kT^2 + ((m1 + m2) / 2)^2)
+/// - q out/side/long: q boosted along z to the longitudinally co-moving system and rotated such that out is along the pair pT
+/// FourMomentumBlock keeps the four-momenta of the particles of an event as arrays and getPairKinematics() evaluates one particle
+/// against a block of partners: a first loop computes the squares and numerators, then a second loop takes the square roots.
+/// The first loop has no branches nor calls so that it can be vectorised, which clang and GCC at -O3 do, while GCC at -O2 keeps
+/// it scalar. The four-momenta and the pair sums are in double precision, but the squares and numerators are stored in the
+/// float output arrays before the square roots, so the results agree with the ROOT implementations to float precision.
+
+#ifndef PWGCF_CORE_FEMTOPAIRKINEMATICS_H_
+#define PWGCF_CORE_FEMTOPAIRKINEMATICS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace o2::analysis::femto
+{
+
+/// Cartesian four-momentum
+struct FourMomentum {
+  double px = 0.;
+  double py = 0.;
+  double pz = 0.;
+  double e = 0.;
+};
+
+/// Four-momentum of a particle from its pt, eta, phi and mass
+inline FourMomentum getFourMomentum(double pt, double eta, double phi, double mass)
+{
+  FourMomentum p;
+  p.px = pt * std::cos(phi);
+  p.py = pt * std::sin(phi);
+  p.pz = pt * std::sinh(eta);
+  p.e = std::sqrt(p.px * p.px + p.py * p.py + p.pz * p.pz + mass * mass);
+  return p;
+}
+
+/// Four-momentum of a particle with pt(), eta() and phi() getters
+template <typename T>
+FourMomentum getFourMomentum(T const& part, double mass)
+{
+  return getFourMomentum(part.pt(), part.eta(), part.phi(), mass);
+}
+
+/// k* of a pair: half of the relative momentum in the pair rest frame
+inline double getKstar(FourMomentum const& p1, FourMomentum const& p2)
+{
+  const double sumPx = p1.px + p2.px, sumPy = p1.py + p2.py, sumPz = p1.pz + p2.pz, sumE = p1.e + p2.e;
+  const double qx = p1.px - p2.px, qy = p1.py - p2.py, qz = p1.pz - p2.pz, q0 = p1.e - p2.e;
+  const double sum2 = sumE * sumE - sumPx * sumPx - sumPy * sumPy - sumPz * sumPz;
+  const double qDotSum = q0 * sumE - qx * sumPx - qy * sumPy - qz * sumPz;
+  const double q2 = q0 * q0 - qx * qx - qy * qy - qz * qz;
+  return 0.5 * std::sqrt(std::max(qDotSum * qDotSum / sum2 - q2, 0.));
+}
+
+/// kT of a pair: half of the transverse momentum of the pair
+inline double getKt(FourMomentum const& p1, FourMomentum const& p2)
+{
+  const double sumPx = p1.px + p2.px, sumPy = p1.py + p2.py;
+  return 0.5 * std::sqrt(sumPx * sumPx + sumPy * sumPy);
+}
+
+/// mT of a pair of particles of masses mass1 and mass2 with the given kT
+inline double getMt(double kT, double mass1, double mass2)
+{
+  const double averageMass = 0.5 * (mass1 + mass2);
+  return std::sqrt(kT * kT + averageMass * averageMass);
+}
+
+/// Components out, side and long of q = p1 - p2 in the longitudinally co-moving system of the pair
+inline void getQLCMS(FourMomentum const& p1, FourMomentum const& p2, double& qOut, double& qSide, double& qLong)
+{
+  const double sumPx = p1.px + p2.px, sumPy = p1.py + p2.py, sumPz = p1.pz + p2.pz, sumE = p1.e + p2.e;
+  const double qx = p1.px - p2.px, qy = p1.py - p2.py, qz = p1.pz - p2.pz, q0 = p1.e - p2.e;
+  const double sumPt = std::sqrt(sumPx * sumPx + sumPy * sumPy);
+  // direction of the pair pT, along x for a pair at rest in the transverse plane (phi = 0 as in ROOT)
+  const double cosPhi = sumPt > 0. ? sumPx / sumPt : 1.;
+  const double sinPhi = sumPt > 0. ? sumPy / sumPt : 0.;
+  qOut = qx * cosPhi + qy * sinPhi;
+  qSide = qy * cosPhi - qx * sinPhi;
+  qLong = (sumE * qz - sumPz * q0) / std::sqrt(sumE * sumE - sumPz * sumPz);
+}
+
+/// Four-momenta and masses of the particles of an event, as arrays
+class FourMomentumBlock
+{
+ public:
+  void clear()
+  {
+    mPx.clear();
+    mPy.clear();
+    mPz.clear();
+    mE.clear();
+    mMass.clear();
+  }
+  void reserve(int n)
+  {
+    mPx.reserve(n);
+    mPy.reserve(n);
+    mPz.reserve(n);
+    mE.reserve(n);
+    mMass.reserve(n);
+  }
+  int size() const { return mPx.size(); }
+
+  void add(FourMomentum const& p, double mass)
+  {
+    mPx.push_back(p.px);
+    mPy.push_back(p.py);
+    mPz.push_back(p.pz);
+    mE.push_back(p.e);
+    mMass.push_back(mass);
+  }
+  /// Adds a particle with pt(), eta() and phi() getters
+  template <typename T>
+  void add(T const& part, double mass)
+  {
+    add(getFourMomentum(part, mass), mass);
+  }
+  /// Adds all the particles of a table or slice
+  template <typename TParts>
+  void fill(TParts const& parts, double mass)
+  {
+    clear();
+    reserve(parts.size());
+    for (auto const& part : parts) {
+      add(part, mass);
+    }
+  }
+
+  FourMomentum get(int i) const { return {mPx[i], mPy[i], mPz[i], mE[i]}; }
+  double getMass(int i) const { return mMass[i]; }
+
+  const double* px() const { return mPx.data(); }
+  const double* py() const { return mPy.data(); }
+  const double* pz() const { return mPz.data(); }
+  const double* e() const { return mE.data(); }
+  const double* mass() const { return mMass.data(); }
+
+ private:
+  std::vector<double> mPx;
+  std::vector<double> mPy;
+  std::vector<double> mPz;
+  std::vector<double> mE;
+  std::vector<double> mMass;
+};
+
+/// Pair quantities of one particle with the partners of a block, indexed as the partners
+struct PairKinematics {
+  std::vector<float> kstar;
+  std::vector<float> kT;
+  std::vector<float> mT;
+  std::vector<float> qOut; ///< q out/side/long in the LCMS, filled only by getPairKinematics<true>
+  std::vector<float> qSide;
+  std::vector<float> qLong;
+};
+
+/// Computes k*, kT, mT and, if withQLCMS, q out/side/long of the particle p1 of mass mass1 with the partners [first, partners.size())
+/// of the block. The entries of the partners before first are left untouched, first = i + 1 gives the pairs i < j of a same-event block.
+template <bool withQLCMS = false>
+void getPairKinematics(FourMomentum const& p1, double mass1, FourMomentumBlock const& partners, PairKinematics& pairs, int first = 0)
+{
+  const int n = partners.size();
+  pairs.kstar.resize(n);
+  pairs.kT.resize(n);
+  pairs.mT.resize(n);
+  if constexpr (withQLCMS) {
+    pairs.qOut.resize(n);
+    pairs.qSide.resize(n);
+    pairs.qLong.resize(n);
+  }
+  const double* px = partners.px();
+  const double* py = partners.py();
+  const double* pz = partners.pz();
+  const double* e = partners.e();
+  const double* mass = partners.mass();
+  float* kstar = pairs.kstar.data();
+  float* kT = pairs.kT.data();
+  float* mT = pairs.mT.data();
+  float* qOut = pairs.qOut.data();
+  float* qSide = pairs.qSide.data();
+  float* qLong = pairs.qLong.data();
+
+  // squares and numerators only: no branch, no selection and no call, such that the loop can be vectorised
+  // whatever the errno and floating point trapping settings
+  for (int i = first; i < n; i++) {
+    const double sumPx = p1.px + px[i], sumPy = p1.py + py[i], sumPz = p1.pz + pz[i], sumE = p1.e + e[i];
+    const double qx = p1.px - px[i], qy = p1.py - py[i], qz = p1.pz - pz[i], q0 = p1.e - e[i];
+    const double sum2 = sumE * sumE - sumPx * sumPx - sumPy * sumPy - sumPz * sumPz;
+    const double qDotSum = q0 * sumE - qx * sumPx - qy * sumPy - qz * sumPz;
+    const double q2 = q0 * q0 - qx * qx - qy * qy - qz * qz;
+    const double kT2 = 0.25 * (sumPx * sumPx + sumPy * sumPy);
+    const double averageMass = 0.5 * (mass1 + mass[i]);
+    kstar[i] = 0.25 * (qDotSum * qDotSum / sum2 - q2);
+    kT[i] = kT2;
+    mT[i] = kT2 + averageMass * averageMass;
+    if constexpr (withQLCMS) {
+      qOut[i] = qx * sumPx + qy * sumPy;
+      qSide[i] = qy * sumPx - qx * sumPy;
+      qLong[i] = sumE * qz - sumPz * q0;
+    }
+  }
+
+  // square roots and normalisations
+  for (int i = first; i < n; i++) {
+    kstar[i] = std::sqrt(std::max(kstar[i], 0.f));
+    kT[i] = std::sqrt(kT[i]);
+    mT[i] = std::sqrt(mT[i]);
+    if constexpr (withQLCMS) {
+      const double sumPt = 2. * kT[i];
+      if (sumPt > 0.) {
+        qOut[i] /= sumPt;
+        qSide[i] /= sumPt;
+      } else {
+        // out along x for a pair at rest in the transverse plane (phi = 0 as in ROOT)
+        qOut[i] = p1.px - px[i];
+        qSide[i] = p1.py - py[i];
+      }
+      const double sumPz = p1.pz + pz[i], sumE = p1.e + e[i];
+      qLong[i] /= std::sqrt(sumE * sumE - sumPz * sumPz);
+    }
+  }
+}
+
+} // namespace o2::analysis::femto
+
+#endif // PWGCF_CORE_FEMTOPAIRKINEMATICS_H_
@@ -12,7 +12,10 @@
 #ifndef O2_ANALYSIS_PAIRCUTS_H
 #define O2_ANALYSIS_PAIRCUTS_H
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <vector>
 
 #include "Framework/Logger.h"
 #include "Framework/HistogramRegistry.h"
@@ -53,6 +56,12 @@ class PairCuts
     mTwoTrackDistance = distance;
     mTwoTrackRadius = radius;
 
+    // radii at which the minimum dphistar is searched (same accumulation as the original 1 cm scan)
+    mTwoTrackRadii.clear();
+    for (Double_t rad = mTwoTrackRadius; rad < 2.51; rad += 0.01) {
+      mTwoTrackRadii.push_back(rad);
+    }
+
     if (histogramRegistry != nullptr && histogramRegistry->contains(HIST("TwoTrackDistancePt_0")) == false) {
       histogramRegistry->add("TwoTrackDistancePt_0", "", {HistType::kTH3F, {{100, -0.15, 0.15, "#Delta#eta"}, {100, -0.05, 0.05, "#Delta#varphi^{*}_{min}"}, {20, 0, 10, "#Delta p_{T}"}}});
       histogramRegistry->addClone("TwoTrackDistancePt_0", "TwoTrackDistancePt_1");
@@ -65,10 +74,20 @@ class PairCuts
   template <typename T>
   bool twoTrackCut(T const& track1, T const& track2, int magField);
 
+  // Reference implementation of twoTrackCut which scans all radii, kept for validation and benchmarking
+  template <typename T>
+  bool twoTrackCutScan(T const& track1, T const& track2, int magField);
+
+  // Two-track cut of one trigger particle against a block of n associated particles given as arrays
+  // reject[i] is set to 1 if the pair (trigger, i) has to be removed; the decisions are the same as twoTrackCut
+  template <typename T>
+  void twoTrackCutBlock(T const& trigger, int n, const float* eta, const float* phi, const float* pt, const int8_t* sign, int magField, uint8_t* reject);
+
  protected:
   float mCuts[ParticlesLastEntry] = {-1};
   float mTwoTrackDistance = -1; // distance below which the pair is flagged as to be removed
   float mTwoTrackRadius = 0.8f; // radius at which the two track cuts are applied
+  std::vector<double> mTwoTrackRadii; // radii between mTwoTrackRadius and 2.5 m (1 cm steps) where the minimum dphistar is searched
 
   HistogramRegistry* histogramRegistry = nullptr; // if set, control histograms are stored here
 
@@ -83,6 +102,22 @@ class PairCuts
 
   template <typename T>
   float getDPhiStar(T const& track1, T const& track2, float radius, int magField);
+
+  static float getDPhiStarRaw(float phi1, float pt1, int charge1, float phi2, float pt2, int charge2, float radius, int magField)
+  {
+    return phi1 - phi2 - charge1 * std::asin(0.015 * magField * radius / pt1) + charge2 * std::asin(0.015 * magField * radius / pt2);
+  }
+
+  static float foldDPhiStar(float dphistar)
+  {
+    dphistar = (dphistar > PI) ? TwoPI - dphistar : dphistar;
+    dphistar = (dphistar < -PI) ? -TwoPI - dphistar : dphistar;
+    dphistar = (dphistar > PI) ? TwoPI - dphistar : dphistar; // might look funny but is needed
+    return dphistar;
+  }
+
+  bool twoTrackCutPair(float deta, float dpt, float phi1, float pt1, int charge1, float phi2, float pt2, int charge2, int magField);
+  float getDPhiStarMin(float phi1, float pt1, int charge1, float phi2, float pt2, int charge2, int magField);
 };
 
 template <typename T>
@@ -118,6 +153,141 @@ bool PairCuts::twoTrackCut(T const& track1, T const& track2, int magField)
   // Parameters:
   //   magField: B field in kG
 
+  return twoTrackCutPair(track1.eta() - track2.eta(), std::fabs(track1.pt() - track2.pt()), track1.phi(), track1.pt(), track1.sign(), track2.phi(), track2.pt(), track2.sign(), magField);
+}
+
+template <typename T>
+void PairCuts::twoTrackCutBlock(T const& trigger, int n, const float* eta, const float* phi, const float* pt, const int8_t* sign, int magField, uint8_t* reject)
+{
+  // first pass without branches over the block: flag the pairs which are close enough to need the minimum search
+  const float etaT = trigger.eta();
+  const float phiT = trigger.phi();
+  const float ptT = trigger.pt();
+  const int chargeT = trigger.sign();
+  const float kLimitEta = mTwoTrackDistance * 2.5 * 3;
+  const float kLimit = mTwoTrackDistance * 3;
+  for (int i = 0; i < n; i++) {
+    float dphistar1 = foldDPhiStar(getDPhiStarRaw(phiT, ptT, chargeT, phi[i], pt[i], sign[i], mTwoTrackRadius, magField));
+    float dphistar2 = foldDPhiStar(getDPhiStarRaw(phiT, ptT, chargeT, phi[i], pt[i], sign[i], 2.5, magField));
+    reject[i] = (std::fabs(etaT - eta[i]) < kLimitEta) & ((std::fabs(dphistar1) < kLimit) | (std::fabs(dphistar2) < kLimit) | (dphistar1 * dphistar2 < 0));
+  }
+
+  // second pass on the flagged pairs only
+  for (int i = 0; i < n; i++) {
+    if (reject[i]) {
+      reject[i] = twoTrackCutPair(etaT - eta[i], std::fabs(ptT - pt[i]), phiT, ptT, chargeT, phi[i], pt[i], sign[i], magField);
+    }
+  }
+}
+
+inline bool PairCuts::twoTrackCutPair(float deta, float dpt, float phi1, float pt1, int charge1, float phi2, float pt2, int charge2, int magField)
+{
+  // optimization
+  if (std::fabs(deta) < mTwoTrackDistance * 2.5 * 3) {
+    // check first boundaries to see if is worth to search for the minimum
+    float dphistar1 = foldDPhiStar(getDPhiStarRaw(phi1, pt1, charge1, phi2, pt2, charge2, mTwoTrackRadius, magField));
+    float dphistar2 = foldDPhiStar(getDPhiStarRaw(phi1, pt1, charge1, phi2, pt2, charge2, 2.5, magField));
+
+    const float kLimit = mTwoTrackDistance * 3;
+
+    if (std::fabs(dphistar1) < kLimit || std::fabs(dphistar2) < kLimit || dphistar1 * dphistar2 < 0) {
+      float dphistarmin = getDPhiStarMin(phi1, pt1, charge1, phi2, pt2, charge2, magField);
+      float dphistarminabs = std::fabs(dphistarmin);
+
+      if (histogramRegistry != nullptr) {
+        histogramRegistry->fill(HIST("TwoTrackDistancePt_0"), deta, dphistarmin, dpt);
+      }
+
+      if (dphistarminabs < mTwoTrackDistance && std::fabs(deta) < mTwoTrackDistance) {
+        return true;
+      }
+
+      if (histogramRegistry != nullptr) {
+        histogramRegistry->fill(HIST("TwoTrackDistancePt_1"), deta, dphistarmin, dpt);
+      }
+    }
+  }
+
+  return false;
+}
+
+inline float PairCuts::getDPhiStarMin(float phi1, float pt1, int charge1, float phi2, float pt2, int charge2, int magField)
+{
+  // Finds the dphistar with the smallest absolute value on the radius grid, with the same result as scanning all radii.
+  // The unfolded dphistar is monotonic in the radius (both asin terms are monotonic and, for any charge combination,
+  // their contributions never compensate in slope), and it is defined (not NaN) only up to some radius.
+  // The minimum of |dphistar| is therefore either at an end of the valid range or next to a radius where the unfolded
+  // dphistar crosses a multiple of 2 pi. These are found by bisection, i.e. O(log n) instead of O(n) evaluations.
+
+  auto raw = [&](int k) { return getDPhiStarRaw(phi1, pt1, charge1, phi2, pt2, charge2, mTwoTrackRadii[k], magField); };
+
+  float dphistarmin = 1e5;
+  int last = static_cast<int>(mTwoTrackRadii.size()) - 1;
+  if (last < 0 || std::isnan(raw(0))) {
+    return dphistarmin;
+  }
+  float rawLast = raw(last);
+  if (std::isnan(rawLast)) {
+    // the asin argument grows with the radius: find the last radius where dphistar is defined
+    int lo = 0, hi = last; // raw(lo) valid, raw(hi) NaN
+    while (hi - lo > 1) {
+      int mid = (lo + hi) / 2;
+      if (std::isnan(raw(mid))) {
+        hi = mid;
+      } else {
+        lo = mid;
+      }
+    }
+    last = lo;
+    rawLast = raw(last);
+  }
+  const float rawFirst = raw(0);
+
+  // candidate radii (in increasing order, to reproduce the tie breaking of the scan)
+  int candidates[8] = {0};
+  int nCandidates = 1;
+  const float crossings[3] = {-TwoPI, 0.f, TwoPI};
+  for (const auto crossing : crossings) {
+    const bool firstAbove = rawFirst > crossing;
+    if (firstAbove == (rawLast > crossing)) {
+      continue;
+    }
+    int lo = 0, hi = last; // crossing between lo and hi
+    while (hi - lo > 1) {
+      int mid = (lo + hi) / 2;
+      if ((raw(mid) > crossing) == firstAbove) {
+        lo = mid;
+      } else {
+        hi = mid;
+      }
+    }
+    candidates[nCandidates++] = lo;
+    candidates[nCandidates++] = hi;
+  }
+  candidates[nCandidates++] = last;
+  std::sort(candidates, candidates + nCandidates);
+
+  float dphistarminabs = 1e5;
+  for (int i = 0; i < nCandidates; i++) {
+    float dphistar = foldDPhiStar(raw(candidates[i]));
+    float dphistarabs = std::fabs(dphistar);
+    if (dphistarabs < dphistarminabs) {
+      dphistarmin = dphistar;
+      dphistarminabs = dphistarabs;
+    }
+  }
+
+  return dphistarmin;
+}
+
+template <typename T>
+bool PairCuts::twoTrackCutScan(T const& track1, T const& track2, int magField)
+{
+  // the variables & cut have been developed in Run 1 by the CF - HBT group
+  //
+  // Parameters:
+  //   magField: B field in kG
+
   auto deta = track1.eta() - track2.eta();
 
   // optimization
@@ -324,19 +494,7 @@ float PairCuts::getDPhiStar(T const& track1, T const& track2, float radius, int
   auto pt2 = track2.pt();
   auto charge2 = track2.sign();
 
-  float dphistar = phi1 - phi2 - charge1 * std::asin(0.015 * magField * radius / pt1) + charge2 * std::asin(0.015 * magField * radius / pt2);
-
-  if (dphistar > PI) {
-    dphistar = TwoPI - dphistar;
-  }
-  if (dphistar < -PI) {
-    dphistar = -TwoPI - dphistar;
-  }
-  if (dphistar > PI) { // might look funny but is needed
-    dphistar = TwoPI - dphistar;
-  }
-
-  return dphistar;
+  return foldDPhiStar(getDPhiStarRaw(phi1, pt1, charge1, phi2, pt2, charge2, radius, magField));
 }
 
 #endif
@@ -0,0 +1,103 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file pairCutsBenchmark.cxx
+/// \brief Micro-benchmark of the two-track cut: radius scan vs. bisection search vs. block evaluation
+///        Usage: o2-analysis-pwgcf-paircuts-benchmark [number of tracks] [magnetic field in kG]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "PWGCF/Core/PairCuts.h"
+
+namespace
+{
+struct BenchmarkTrack {
+  float mEta, mPhi, mPt;
+  int8_t mSign;
+  float eta() const { return mEta; }
+  float phi() const { return mPhi; }
+  float pt() const { return mPt; }
+  int8_t sign() const { return mSign; }
+};
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  const int nTracks = argc > 1 ? std::atoi(argv[1]) : 2000;
+  const int magField = argc > 2 ? std::atoi(argv[2]) : 5;
+
+  // narrow eta range so that a large fraction of the pairs goes through the minimum search
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> etaDist(-0.1, 0.1);
+  std::uniform_real_distribution<float> phiDist(0, TwoPI);
+  std::exponential_distribution<float> ptDist(2.);
+  std::bernoulli_distribution signDist(0.5);
+
+  std::vector<BenchmarkTrack> tracks(nTracks);
+  std::vector<float> eta(nTracks), phi(nTracks), pt(nTracks);
+  std::vector<int8_t> sign(nTracks);
+  for (int i = 0; i < nTracks; i++) {
+    tracks[i] = {etaDist(generator), phiDist(generator), 0.15f + ptDist(generator), static_cast<int8_t>(signDist(generator) ? 1 : -1)};
+    eta[i] = tracks[i].eta();
+    phi[i] = tracks[i].phi();
+    pt[i] = tracks[i].pt();
+    sign[i] = tracks[i].sign();
+  }
+
+  PairCuts pairCuts;
+  pairCuts.SetTwoTrackCuts(0.02f, 0.8f);
+
+  using clock = std::chrono::steady_clock;
+  std::vector<uint8_t> decisionsScan(static_cast<size_t>(nTracks) * nTracks);
+  std::vector<uint8_t> decisionsSearch(decisionsScan.size());
+  std::vector<uint8_t> decisionsBlock(decisionsScan.size());
+
+  auto start = clock::now();
+  for (int i = 0; i < nTracks; i++) {
+    for (int j = 0; j < nTracks; j++) {
+      decisionsScan[i * nTracks + j] = pairCuts.twoTrackCutScan(tracks[i], tracks[j], magField);
+    }
+  }
+  std::chrono::duration<double> timeScan = clock::now() - start;
+
+  start = clock::now();
+  for (int i = 0; i < nTracks; i++) {
+    for (int j = 0; j < nTracks; j++) {
+      decisionsSearch[i * nTracks + j] = pairCuts.twoTrackCut(tracks[i], tracks[j], magField);
+    }
+  }
+  std::chrono::duration<double> timeSearch = clock::now() - start;
+
+  start = clock::now();
+  for (int i = 0; i < nTracks; i++) {
+    pairCuts.twoTrackCutBlock(tracks[i], nTracks, eta.data(), phi.data(), pt.data(), sign.data(), magField, &decisionsBlock[i * nTracks]);
+  }
+  std::chrono::duration<double> timeBlock = clock::now() - start;
+
+  size_t nRejected = 0, nDiffSearch = 0, nDiffBlock = 0;
+  for (size_t k = 0; k < decisionsScan.size(); k++) {
+    nRejected += decisionsScan[k];
+    nDiffSearch += (decisionsScan[k] != decisionsSearch[k]);
+    nDiffBlock += (decisionsScan[k] != decisionsBlock[k]);
+  }
+
+  const double nPairs = decisionsScan.size();
+  std::cout << "Pairs: " << nPairs << ", rejected by the radius scan: " << nRejected << std::endl;
+  std::cout << "Radius scan:      " << timeScan.count() << " s (" << nPairs / timeScan.count() << " pairs/s)" << std::endl;
+  std::cout << "Bisection search: " << timeSearch.count() << " s (" << nPairs / timeSearch.count() << " pairs/s), " << nDiffSearch << " different decisions" << std::endl;
+  std::cout << "Block evaluation: " << timeBlock.count() << " s (" << nPairs / timeBlock.count() << " pairs/s), " << nDiffBlock << " different decisions" << std::endl;
+
+  return (nDiffSearch == 0 && nDiffBlock == 0) ? 0 : 1;
+}
@@ -28,6 +28,8 @@
 #include "TVector3.h"
 #include "TDatabasePDG.h"
 
+#include "PWGCF/Core/FemtoPairKinematics.h"
+
 double particle_mass(int PDGcode)
 {
   // if(PDGcode == 2212) return TDatabasePDG::Instance()->GetParticle(2212)->Mass();
@@ -221,12 +223,8 @@ float FemtoPair<TrackType>::GetKstar() const
   if (_PDG1 * _PDG2 == 0)
     return -1000;
 
-  TLorentzVector first4momentum;
-  first4momentum.SetPtEtaPhiM(_first->pt(), _first->eta(), _first->phi(), particle_mass(_PDG1));
-  TLorentzVector second4momentum;
-  second4momentum.SetPtEtaPhiM(_second->pt(), _second->eta(), _second->phi(), particle_mass(_PDG2));
-
-  return GetKstarFrom4vectors(first4momentum, second4momentum, _isidentical);
+  // identical particles have q.P = 0, for which k* is |q|/2 as in GetKstarFrom4vectors
+  return o2::analysis::femto::getKstar(o2::analysis::femto::getFourMomentum(*_first, particle_mass(_PDG1)), o2::analysis::femto::getFourMomentum(*_second, particle_mass(_PDG2)));
 }
 
 template <typename TrackType>
@@ -239,12 +237,9 @@ TVector3 FemtoPair<TrackType>::GetQLCMS() const
   if (_PDG1 * _PDG2 == 0)
     return TVector3(-1000, -1000, -1000);
 
-  TLorentzVector first4momentum;
-  first4momentum.SetPtEtaPhiM(_first->pt(), _first->eta(), _first->phi(), particle_mass(_PDG1));
-  TLorentzVector second4momentum;
-  second4momentum.SetPtEtaPhiM(_second->pt(), _second->eta(), _second->phi(), particle_mass(_PDG2));
-
-  return GetQLCMSFrom4vectors(first4momentum, second4momentum);
+  double qOut, qSide, qLong;
+  o2::analysis::femto::getQLCMS(o2::analysis::femto::getFourMomentum(*_first, particle_mass(_PDG1)), o2::analysis::femto::getFourMomentum(*_second, particle_mass(_PDG2)), qOut, qSide, qLong);
+  return TVector3(qOut, qSide, qLong);
 }
 
 template <typename TrackType>
@@ -270,14 +265,11 @@ float FemtoPair<TrackType>::GetMt() const
   if (_PDG1 * _PDG2 == 0)
     return -1000;
 
-  TLorentzVector first4momentum;
-  first4momentum.SetPtEtaPhiM(_first->pt(), _first->eta(), _first->phi(), particle_mass(_PDG1));
-  TLorentzVector second4momentum;
-  second4momentum.SetPtEtaPhiM(_second->pt(), _second->eta(), _second->phi(), particle_mass(_PDG2));
-
-  TLorentzVector fourmomentasum = first4momentum + second4momentum;
+  const auto first4momentum = o2::analysis::femto::getFourMomentum(*_first, particle_mass(_PDG1));
+  const auto second4momentum = o2::analysis::femto::getFourMomentum(*_second, particle_mass(_PDG2));
+  const double sumE = first4momentum.e + second4momentum.e, sumPz = first4momentum.pz + second4momentum.pz;
 
-  return 0.5 * fourmomentasum.Mt();
+  return 0.5 * std::sqrt(sumE * sumE - sumPz * sumPz);
 }
 } // namespace o2::aod::singletrackselector
 
@@ -21,6 +21,7 @@
 #include <TParameter.h>
 #include <TH1F.h>
 
+#include "PWGCF/Core/FemtoPairKinematics.h"
 #include "PWGCF/Femto3D/Core/femto3dPairTask.h"
 #include "PWGCF/Femto3D/DataModel/singletrackselector.h"
 #include "TLorentzVector.h"
@@ -118,6 +119,10 @@ struct FemtoCorrelations {
 
   std::unique_ptr<o2::aod::singletrackselector::FemtoPair<trkType>> Pair = std::make_unique<o2::aod::singletrackselector::FemtoPair<trkType>>();
 
+  double mass_1 = 0, mass_2 = 0;
+  o2::analysis::femto::FourMomentumBlock fourMomenta_1, fourMomenta_2; // four-momenta of the tracks being mixed, computed once per collision
+  o2::analysis::femto::PairKinematics pairKinematics;                  // k*, kT and q LCMS of one track with the tracks of fourMomenta_2 (or fourMomenta_1 for SE identical)
+
   Filter pFilter = o2::aod::singletrackselector::p > _min_P&& o2::aod::singletrackselector::p < _max_P;
   Filter etaFilter = nabs(o2::aod::singletrackselector::eta) < _eta;
 
@@ -158,6 +163,9 @@ struct FemtoCorrelations {
     Pair->SetPDG1(_particlePDG_1);
     Pair->SetPDG2(_particlePDG_2);
 
+    mass_1 = particle_mass(_particlePDG_1);
+    mass_2 = particle_mass(_particlePDG_2);
+
     TPCcuts_1 = std::make_pair(_particlePDG_1, _tpcNSigma_1);
     TOFcuts_1 = std::make_pair(_particlePDG_1, _tofNSigma_1);
     TPCcuts_2 = std::make_pair(_particlePDG_2, _tpcNSigma_2);
@@ -217,6 +225,29 @@ struct FemtoCorrelations {
     }
   }
 
+  template <typename Type>
+  void fillFourMomenta(Type const& tracks, double mass, o2::analysis::femto::FourMomentumBlock& fourMomenta)
+  {
+    fourMomenta.clear();
+    fourMomenta.reserve(tracks.size());
+    for (auto const& track : tracks)
+      fourMomenta.add(*track, mass);
+  }
+
+  void computePairKinematics(o2::analysis::femto::FourMomentum const& first, double mass, o2::analysis::femto::FourMomentumBlock const& partners, int firstPartner = 0)
+  {
+    if (_fill3dCF)
+      o2::analysis::femto::getPairKinematics<true>(first, mass, partners, pairKinematics, firstPartner);
+    else
+      o2::analysis::femto::getPairKinematics<false>(first, mass, partners, pairKinematics, firstPartner);
+  }
+
+  float getPairMt(o2::analysis::femto::FourMomentum const& first, o2::analysis::femto::FourMomentum const& second) const
+  { // same definition as FemtoPair::GetMt (test)
+    const double sumE = first.e + second.e, sumPz = first.pz + second.pz;
+    return 0.5 * std::sqrt(sumE * sumE - sumPz * sumPz);
+  }
+
   template <typename Type>
   void mixTracks(Type const& tracks, int multBin)
   { // template for identical particles from the same collision
@@ -229,7 +260,11 @@ struct FemtoCorrelations {
       LOGF(fatal, "multBin value passed to the mixTracks function is less than 0");
     }
 
+    fillFourMomenta(tracks, mass_1, fourMomenta_1);
+
     for (int ii = 0; ii < tracks.size(); ii++) { // nested loop for all the combinations
+      computePairKinematics(fourMomenta_1.get(ii), mass_1, fourMomenta_1, ii + 1);
+
       for (int iii = ii + 1; iii < tracks.size(); iii++) {
 
         Pair->SetPair(tracks[ii], tracks[iii]);
@@ -250,12 +285,11 @@ struct FemtoCorrelations {
 
         if (!Pair->IsClosePair(_deta, _dphi, _radiusTPC)) {
           kThistos[multBin][kTbin]->Fill(pair_kT);
-          mThistos[multBin][kTbin]->Fill(Pair->GetMt());       // test
-          SEhistos_1D[multBin][kTbin]->Fill(Pair->GetKstar()); // close pair rejection and fillig the SE histo
+          mThistos[multBin][kTbin]->Fill(getPairMt(fourMomenta_1.get(ii), fourMomenta_1.get(iii))); // test
+          SEhistos_1D[multBin][kTbin]->Fill(pairKinematics.kstar[iii]);                           // close pair rejection and fillig the SE histo
 
           if (_fill3dCF) {
-            TVector3 qLCMS = Pair->GetQLCMS();
-            SEhistos_3D[multBin][kTbin]->Fill(qLCMS.X(), qLCMS.Y(), qLCMS.Z());
+            SEhistos_3D[multBin][kTbin]->Fill(pairKinematics.qOut[iii], pairKinematics.qSide[iii], pairKinematics.qLong[iii]);
           }
         }
         Pair->ResetPair();
@@ -275,10 +309,15 @@ struct FemtoCorrelations {
       LOGF(fatal, "multBin value passed to the mixTracks function is less than 0");
     }
 
-    for (auto ii : tracks1) {
-      for (auto iii : tracks2) {
+    fillFourMomenta(tracks1, mass_1, fourMomenta_1);
+    fillFourMomenta(tracks2, mass_2, fourMomenta_2);
+
+    for (int ii = 0; ii < tracks1.size(); ii++) {
+      computePairKinematics(fourMomenta_1.get(ii), mass_1, fourMomenta_2);
+
+      for (int iii = 0; iii < tracks2.size(); iii++) {
 
-        Pair->SetPair(ii, iii);
+        Pair->SetPair(tracks1[ii], tracks2[iii]);
         float pair_kT = Pair->GetKt();
 
         if (pair_kT < *_kTbins.value.begin() || pair_kT >= *(_kTbins.value.end() - 1))
@@ -296,21 +335,19 @@ struct FemtoCorrelations {
 
         if (!Pair->IsClosePair(_deta, _dphi, _radiusTPC)) {
           if (!SE_or_ME) {
-            SEhistos_1D[multBin][kTbin]->Fill(Pair->GetKstar());
+            SEhistos_1D[multBin][kTbin]->Fill(pairKinematics.kstar[iii]);
             kThistos[multBin][kTbin]->Fill(pair_kT);
-            mThistos[multBin][kTbin]->Fill(Pair->GetMt()); // test
+            mThistos[multBin][kTbin]->Fill(getPairMt(fourMomenta_1.get(ii), fourMomenta_2.get(iii))); // test
 
             if (_fill3dCF) {
-              TVector3 qLCMS = Pair->GetQLCMS();
-              SEhistos_3D[multBin][kTbin]->Fill(qLCMS.X(), qLCMS.Y(), qLCMS.Z());
+              SEhistos_3D[multBin][kTbin]->Fill(pairKinematics.qOut[iii], pairKinematics.qSide[iii], pairKinematics.qLong[iii]);
             }
           } else {
-            MEhistos_1D[multBin][kTbin]->Fill(Pair->GetKstar());
+            MEhistos_1D[multBin][kTbin]->Fill(pairKinematics.kstar[iii]);
 
             if (_fill3dCF) {
-              TVector3 qLCMS = Pair->GetQLCMS();
-              MEhistos_3D[multBin][kTbin]->Fill(qLCMS.X(), qLCMS.Y(), qLCMS.Z());
-              qLCMSvskStar[multBin][kTbin]->Fill(qLCMS.X(), qLCMS.Y(), qLCMS.Z(), Pair->GetKstar());
+              MEhistos_3D[multBin][kTbin]->Fill(pairKinematics.qOut[iii], pairKinematics.qSide[iii], pairKinematics.qLong[iii]);
+              qLCMSvskStar[multBin][kTbin]->Fill(pairKinematics.qOut[iii], pairKinematics.qSide[iii], pairKinematics.qLong[iii], pairKinematics.kstar[iii]);
             }
           }
         }
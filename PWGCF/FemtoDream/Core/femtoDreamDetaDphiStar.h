@@ -11,14 +11,24 @@
 
 /// \file FemtoDreamDetaDphiStar.h
 /// \brief FemtoDreamDetaDphiStar - Checks particles for the close pair rejection.
+///
+/// The phi* of a particle at the TPC radii only depends on the particle and on the magnetic field, so it is computed
+/// once and kept in a small direct-mapped cache indexed by the global index of the particle (tagged with the field,
+/// since mixed pairs use the field of the first collision). The pairs of an event and of its mixing partners then
+/// only subtract two contiguous rows of the cache. The global indices restart in every dataframe, so the tasks call
+/// resetCache() before processing the pairs of a new event or set of mixed events.
 /// \author Laura Serksnyte, TU München, laura.serksnyte@tum.de
 
 #ifndef PWGCF_FEMTODREAM_CORE_FEMTODREAMDETADPHISTAR_H_
 #define PWGCF_FEMTODREAM_CORE_FEMTODREAMDETADPHISTAR_H_
 
+#include <array>
+#include <cmath>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
+#include "TVector2.h"
 #include "PWGCF/DataModel/FemtoDerived.h"
 #include "Framework/HistogramRegistry.h"
 
@@ -48,6 +58,7 @@ class FemtoDreamDetaDphiStar
     plotForEveryRadii = lplotForEveryRadii;
     mHistogramRegistry = registry;
     mHistogramRegistryQA = registryQA;
+    resetCache();
 
     if constexpr (mPartOneType == o2::aod::femtodreamparticle::ParticleType::kTrack && mPartTwoType == o2::aod::femtodreamparticle::ParticleType::kTrack) {
       std::string dirName = static_cast<std::string>(dirNames[0]);
@@ -72,6 +83,11 @@ class FemtoDreamDetaDphiStar
       }
     }
   }
+  ///  Empty the phi* cache, to be called before the pairs of each event or set of mixed events
+  void resetCache()
+  {
+    mCacheIndex.fill(-1);
+  }
   ///  Check if pair is close or not
   template <typename Part, typename Parts>
   bool isClosePair(Part const& part1, Part const& part2, Parts const& particles, float lmagfield)
@@ -154,10 +170,17 @@ class FemtoDreamDetaDphiStar
   std::array<std::array<std::shared_ptr<TH2>, 2>, 2> histdetadpi{};
   std::array<std::array<std::shared_ptr<TH2>, 9>, 2> histdetadpiRadii{};
 
+  static constexpr int kNRadii = 9;
+  static constexpr int kCacheSize = 1024; ///< Number of particles in the phi* cache, a power of 2
+
+  std::array<int64_t, kCacheSize> mCacheIndex;           ///< global index of the particle of each cache slot, -1 if empty
+  std::array<float, kCacheSize> mCacheField;             ///< magnetic field used for each cache slot
+  std::array<float, kCacheSize * kNRadii> mCachePhiStar; ///< phi* at the radii tmpRadiiTPC, kNRadii consecutive values per slot
+
   ///  Calculate phi at all required radii stored in tmpRadiiTPC
   /// Magnetic field to be provided in Tesla
   template <typename T>
-  void PhiAtRadiiTPC(const T& part, std::vector<float>& tmpVec)
+  void PhiAtRadiiTPC(const T& part, float* phiStar)
   {
 
     float phi0 = part.phi();
@@ -174,30 +197,51 @@ class FemtoDreamDetaDphiStar
     }
     // End: Get the charge from cutcontainer using masks
     float pt = part.pt();
-    for (size_t i = 0; i < 9; i++) {
-      tmpVec.push_back(phi0 - std::asin(0.3 * charge * 0.1 * magfield * tmpRadiiTPC[i] * 0.01 / (2. * pt)));
+    for (int i = 0; i < kNRadii; i++) {
+      phiStar[i] = phi0 - std::asin(0.3 * charge * 0.1 * magfield * tmpRadiiTPC[i] * 0.01 / (2. * pt));
     }
   }
 
+  ///  Get phi* of a particle at all radii from the cache, computing it if needed
+  template <typename T>
+  const float* getPhiStar(const T& part)
+  {
+    int64_t index = part.globalIndex();
+    int slot = index & (kCacheSize - 1);
+    float* phiStar = mCachePhiStar.data() + slot * kNRadii;
+    if (mCacheIndex[slot] != index || mCacheField[slot] != magfield) {
+      PhiAtRadiiTPC(part, phiStar);
+      mCacheIndex[slot] = index;
+      mCacheField[slot] = magfield;
+    }
+    return phiStar;
+  }
+
   ///  Calculate average phi
   template <typename T1, typename T2>
   float AveragePhiStar(const T1& part1, const T2& part2, int iHist)
   {
-    std::vector<float> tmpVec1;
-    std::vector<float> tmpVec2;
-    PhiAtRadiiTPC(part1, tmpVec1);
-    PhiAtRadiiTPC(part2, tmpVec2);
-    int num = tmpVec1.size();
+    // copy the first row, the second particle may evict it from the cache
+    float dphi[kNRadii];
+    const float* phiStar1 = getPhiStar(part1);
+    for (int i = 0; i < kNRadii; i++) {
+      dphi[i] = phiStar1[i];
+    }
+    const float* phiStar2 = getPhiStar(part2);
+    for (int i = 0; i < kNRadii; i++) {
+      dphi[i] -= phiStar2[i];
+      dphi[i] = TVector2::Phi_mpi_pi(dphi[i]);
+    }
     float dPhiAvg = 0;
-    for (int i = 0; i < num; i++) {
-      float dphi = tmpVec1.at(i) - tmpVec2.at(i);
-      dphi = TVector2::Phi_mpi_pi(dphi);
-      dPhiAvg += dphi;
-      if (plotForEveryRadii) {
-        histdetadpiRadii[iHist][i]->Fill(part1.eta() - part2.eta(), dphi);
+    for (int i = 0; i < kNRadii; i++) {
+      dPhiAvg += dphi[i];
+    }
+    if (plotForEveryRadii) {
+      for (int i = 0; i < kNRadii; i++) {
+        histdetadpiRadii[iHist][i]->Fill(part1.eta() - part2.eta(), dphi[i]);
       }
     }
-    return dPhiAvg / num;
+    return dPhiAvg / kNRadii;
   }
 };
 
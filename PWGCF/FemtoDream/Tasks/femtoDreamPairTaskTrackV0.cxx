@@ -257,6 +257,9 @@ struct femtoDreamPairTaskTrackV0 {
   template <bool isMC, typename PartitionType, typename TableTracks, typename Collision>
   void doSameEvent(PartitionType& SliceTrk1, PartitionType& SliceV02, TableTracks const& parts, Collision const& col)
   {
+    if (ConfOptUseCPR.value) {
+      pairCloseRejection.resetCache();
+    }
     /// Histogramming same event
     for (auto const& part : SliceTrk1) {
       trackHistoPartOne.fillQA<isMC, false>(part, aod::femtodreamparticle::kPt, col.multNtr(), col.multV0M());
@@ -329,6 +332,9 @@ struct femtoDreamPairTaskTrackV0 {
   template <bool isMC, typename CollisionType, typename PartType, typename PartitionType, typename BinningType>
   void doMixedEvent_Masked(CollisionType const& cols, PartType const& parts, PartitionType& part1, PartitionType& part2, BinningType policy)
   {
+    if (ConfOptUseCPR.value) {
+      pairCloseRejection.resetCache();
+    }
     Partition<CollisionType> PartitionMaskedCol1 = (aod::femtodreamcollision::bitmaskTrackOne & BitMask) == BitMask && aod::femtodreamcollision::downsample == true;
     Partition<CollisionType> PartitionMaskedCol2 = (aod::femtodreamcollision::bitmaskTrackTwo & BitMask) == BitMask && aod::femtodreamcollision::downsample == true;
     PartitionMaskedCol1.bindTable(cols);
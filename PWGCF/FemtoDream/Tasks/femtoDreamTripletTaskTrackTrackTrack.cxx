@@ -176,6 +176,9 @@ struct femtoDreamTripletTaskTrackTrackTrack {
   template <bool isMC, typename PartitionType, typename PartType>
   void doSameEvent(PartitionType groupSelectedParts, PartType parts, float magFieldTesla, int multCol, float centCol)
   {
+    if (ConfIsCPR.value) {
+      pairCloseRejection.resetCache();
+    }
     /// Histogramming same event
     for (auto& part : groupSelectedParts) {
       trackHistoSelectedParts.fillQA<isMC, false>(part, aod::femtodreamparticle::kPt, multCol, centCol);
@@ -312,6 +315,9 @@ struct femtoDreamTripletTaskTrackTrackTrack {
   void processMixedEvent(o2::aod::FDCollisions& cols,
                          o2::aod::FDParticles& parts)
   {
+    if (ConfIsCPR.value) {
+      pairCloseRejection.resetCache();
+    }
     for (auto& [collision1, collision2, collision3] : soa::selfCombinations(colBinning, ConfNEventsMix, -1, cols, cols, cols)) {
       const int multiplicityCol = collision1.multNtr();
       ThreeBodyQARegistry.fill(HIST("TripletTaskQA/hMECollisionBins"), colBinning.getBin({collision1.posZ(), multiplicityCol}));
@@ -339,6 +345,9 @@ struct femtoDreamTripletTaskTrackTrackTrack {
   /// @param parts subscribe to the femtoDreamParticleTable
   void processMixedEventMasked(MaskedCollisions& cols, o2::aod::FDParticles& parts)
   {
+    if (ConfIsCPR.value) {
+      pairCloseRejection.resetCache();
+    }
     Partition<MaskedCollisions> PartitionMaskedCol1 = (ConfTracksInMixedEvent == 1 && (aod::femtodreamcollision::bitmaskTrackOne & MaskBit) == MaskBit) ||
                                                       (ConfTracksInMixedEvent == 2 && (aod::femtodreamcollision::bitmaskTrackTwo & MaskBit) == MaskBit) ||
                                                       (ConfTracksInMixedEvent == 3 && (aod::femtodreamcollision::bitmaskTrackThree & MaskBit) == MaskBit);
@@ -372,6 +381,9 @@ struct femtoDreamTripletTaskTrackTrackTrack {
                            soa::Join<o2::aod::FDParticles, o2::aod::FDMCLabels>& parts,
                            o2::aod::FDMCParticles&)
   {
+    if (ConfIsCPR.value) {
+      pairCloseRejection.resetCache();
+    }
     for (auto& [collision1, collision2, collision3] : soa::selfCombinations(colBinning, ConfNEventsMix, -1, cols, cols, cols)) {
 
       const int multiplicityCol = collision1.multNtr();
@@ -403,6 +415,9 @@ struct femtoDreamTripletTaskTrackTrackTrack {
                                  soa::Join<o2::aod::FDParticles, o2::aod::FDMCLabels>& parts,
                                  o2::aod::FDMCParticles&)
   {
+    if (ConfIsCPR.value) {
+      pairCloseRejection.resetCache();
+    }
     Partition<MaskedCollisions> PartitionMaskedCol1 = (ConfTracksInMixedEvent == 1 && (aod::femtodreamcollision::bitmaskTrackOne & MaskBit) == MaskBit) ||
                                                       (ConfTracksInMixedEvent == 2 && (aod::femtodreamcollision::bitmaskTrackTwo & MaskBit) == MaskBit) ||
                                                       (ConfTracksInMixedEvent == 3 && (aod::femtodreamcollision::bitmaskTrackThree & MaskBit) == MaskBit);
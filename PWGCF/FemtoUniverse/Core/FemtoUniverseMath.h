@@ -28,6 +28,8 @@
 #include "TLorentzVector.h"
 #include "TMath.h"
 
+#include "PWGCF/Core/FemtoPairKinematics.h"
+
 namespace o2::analysis::femtoUniverse
 {
 
@@ -45,24 +47,7 @@ class FemtoUniverseMath
   template <typename T>
   static float getkstar(const T& part1, const float mass1, const T& part2, const float mass2)
   {
-    const ROOT::Math::PtEtaPhiMVector vecpart1(part1.pt(), part1.eta(), part1.phi(), mass1);
-    const ROOT::Math::PtEtaPhiMVector vecpart2(part2.pt(), part2.eta(), part2.phi(), mass2);
-    const ROOT::Math::PtEtaPhiMVector trackSum = vecpart1 + vecpart2;
-
-    const float beta = trackSum.Beta();
-    const float betax = beta * std::cos(trackSum.Phi()) * std::sin(trackSum.Theta());
-    const float betay = beta * std::sin(trackSum.Phi()) * std::sin(trackSum.Theta());
-    const float betaz = beta * std::cos(trackSum.Theta());
-
-    ROOT::Math::PxPyPzMVector PartOneCMS(vecpart1);
-    ROOT::Math::PxPyPzMVector PartTwoCMS(vecpart2);
-
-    const ROOT::Math::Boost boostPRF = ROOT::Math::Boost(-betax, -betay, -betaz);
-    PartOneCMS = boostPRF(PartOneCMS);
-    PartTwoCMS = boostPRF(PartTwoCMS);
-
-    const ROOT::Math::PxPyPzMVector trackRelK = PartOneCMS - PartTwoCMS;
-    return 0.5 * trackRelK.P();
+    return femto::getKstar(femto::getFourMomentum(part1, mass1), femto::getFourMomentum(part2, mass2));
   }
 
   /// Compute the qij of a pair of particles
@@ -124,10 +109,7 @@ class FemtoUniverseMath
   template <typename T>
   static float getkT(const T& part1, const float mass1, const T& part2, const float mass2)
   {
-    const ROOT::Math::PtEtaPhiMVector vecpart1(part1.pt(), part1.eta(), part1.phi(), mass1);
-    const ROOT::Math::PtEtaPhiMVector vecpart2(part2.pt(), part2.eta(), part2.phi(), mass2);
-    const ROOT::Math::PtEtaPhiMVector trackSum = vecpart1 + vecpart2;
-    return 0.5 * trackSum.Pt();
+    return femto::getKt(femto::getFourMomentum(part1, mass1), femto::getFourMomentum(part2, mass2));
   }
 
   /// Compute the transverse mass of a pair of particles
@@ -106,6 +106,28 @@ void GFW::Fill(double eta, int ptin, double phi, double weight, int mask, double
       fCumulants.at(i).FillArray(ptin, phi, weight, SecondWeight);
   }
 };
+void GFW::Fill(int nPart, const double* eta, const int* ptin, const double* phi, const double* weight, const int* mask, const double* secondWeight)
+{
+  for (int i = 0; i < static_cast<int>(fRegions.size()); ++i) {
+    const Region& lRegion = fRegions.at(i);
+    fBlockPt.clear();
+    fBlockPhi.clear();
+    fBlockWeight.clear();
+    fBlockSecWeight.clear();
+    for (int j = 0; j < nPart; ++j) {
+      if (lRegion.EtaMin < eta[j] && lRegion.EtaMax > eta[j] && (lRegion.BitMask & mask[j])) {
+        fBlockPt.push_back(ptin[j]);
+        fBlockPhi.push_back(phi[j]);
+        fBlockWeight.push_back(weight[j]);
+        if (secondWeight)
+          fBlockSecWeight.push_back(secondWeight[j]);
+      }
+    }
+    if (fBlockPt.empty())
+      continue;
+    fCumulants.at(i).FillArray(static_cast<int>(fBlockPt.size()), fBlockPt.data(), fBlockPhi.data(), fBlockWeight.data(), secondWeight ? fBlockSecWeight.data() : nullptr);
+  }
+};
 complex<double> GFW::TwoRec(int n1, int n2, int p1, int p2, int ptbin, GFWCumulant* r1, GFWCumulant* r2, GFWCumulant* r3)
 {
   complex<double> part1 = r1->Vec(n1, p1, ptbin);
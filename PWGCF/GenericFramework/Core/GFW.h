@@ -62,8 +62,10 @@ class GFW
   void AddRegion(std::string refName, int lNhar, int* lNparVec, double lEtaMin, double lEtaMax, int lNpT, int BitMask);  // Legacy support, array instead of a vector
   int CreateRegions();
   void Fill(double eta, int ptin, double phi, double weight, int mask, double secondWeight = -1);
+  // Block version of Fill for nPart particles given as arrays (secondWeight can be omitted)
+  void Fill(int nPart, const double* eta, const int* ptin, const double* phi, const double* weight, const int* mask, const double* secondWeight = nullptr);
   void Clear();
-  GFWCumulant GetCumulant(int index) { return fCumulants.at(index); }
+  const GFWCumulant& GetCumulant(int index) const { return fCumulants.at(index); }
   CorrConfig GetCorrelatorConfig(std::string config, std::string head = "", bool ptdif = false);
   std::complex<double> Calculate(CorrConfig corconf, int ptbin, bool SetHarmsToZero);
   void InitializePowerArrays();
@@ -71,6 +73,11 @@ class GFW
  protected:
   bool fInitialized;
   std::vector<CorrConfig> fListOfCFGs;
+  // Scratch arrays of the block Fill: particles selected in a region
+  std::vector<int> fBlockPt;           //!
+  std::vector<double> fBlockPhi;       //!
+  std::vector<double> fBlockWeight;    //!
+  std::vector<double> fBlockSecWeight; //!
   std::complex<double> TwoRec(int n1, int n2, int p1, int p2, int ptbin, GFWCumulant*, GFWCumulant*, GFWCumulant*);
   std::complex<double> RecursiveCorr(GFWCumulant* qpoi, GFWCumulant* qref, GFWCumulant* qol, int ptbin, std::vector<int>& hars, std::vector<int>& pows); // POI, Ref. flow, overlapping region
   std::complex<double> RecursiveCorr(GFWCumulant* qpoi, GFWCumulant* qref, GFWCumulant* qol, int ptbin, std::vector<int>& hars);                         // POI, Ref. flow, overlapping region
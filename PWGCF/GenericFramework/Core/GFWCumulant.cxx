@@ -19,16 +19,59 @@ If used, modified, or distributed, please aknowledge the author of this code.
 
 #include "GFWCumulant.h"
 
+#include <algorithm>
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
 using std::complex;
 using std::vector;
 
-GFWCumulant::GFWCumulant() : fQvector(0),
+namespace
+{
+constexpr int kCacheLineQs = 64 / sizeof(complex<double>); // Q-vectors per cache line
+constexpr int kBlockSize = 256;                             // Particles processed at once by the block FillArray
+
+// Advance cos/sin(n*phi) to cos/sin((n+1)*phi) for an array of particles: (cn + i sn) *= (c1 + i s1)
+void AdvanceHarmonic(int nPart, const double* c1, const double* s1, double* cn, double* sn)
+{
+  int i = 0;
+#if defined(__AVX512F__)
+  for (; i + 8 <= nPart; i += 8) {
+    __m512d vc1 = _mm512_loadu_pd(c1 + i);
+    __m512d vs1 = _mm512_loadu_pd(s1 + i);
+    __m512d vcn = _mm512_loadu_pd(cn + i);
+    __m512d vsn = _mm512_loadu_pd(sn + i);
+    _mm512_storeu_pd(cn + i, _mm512_sub_pd(_mm512_mul_pd(vcn, vc1), _mm512_mul_pd(vsn, vs1)));
+    _mm512_storeu_pd(sn + i, _mm512_add_pd(_mm512_mul_pd(vsn, vc1), _mm512_mul_pd(vcn, vs1)));
+  }
+#elif defined(__AVX2__)
+  for (; i + 4 <= nPart; i += 4) {
+    __m256d vc1 = _mm256_loadu_pd(c1 + i);
+    __m256d vs1 = _mm256_loadu_pd(s1 + i);
+    __m256d vcn = _mm256_loadu_pd(cn + i);
+    __m256d vsn = _mm256_loadu_pd(sn + i);
+    _mm256_storeu_pd(cn + i, _mm256_sub_pd(_mm256_mul_pd(vcn, vc1), _mm256_mul_pd(vsn, vs1)));
+    _mm256_storeu_pd(sn + i, _mm256_add_pd(_mm256_mul_pd(vsn, vc1), _mm256_mul_pd(vcn, vs1)));
+  }
+#endif
+  for (; i < nPart; i++) {
+    double lCos = cn[i] * c1[i] - sn[i] * s1[i];
+    sn[i] = sn[i] * c1[i] + cn[i] * s1[i];
+    cn[i] = lCos;
+  }
+}
+} // namespace
+
+GFWCumulant::GFWCumulant() : fQvector(),
+                             fQOffsets(),
+                             fPtStride(0),
                              fUsed(kBlank),
                              fNEntries(-1),
                              fN(1),
                              fPow(1),
                              fPt(1),
-                             fFilledPts(0),
+                             fFilledPts(),
                              fInitialized(false) {}
 
 GFWCumulant::~GFWCumulant() {}
@@ -41,6 +84,7 @@ void GFWCumulant::FillArray(int ptin, double phi, double weight, double SecondWe
   else if (ptin < 0 || ptin >= fPt)
     return;
   fFilledPts[ptin] = true;
+  complex<double>* lQ = &fQvector[ptin * fPtStride];
   for (int lN = 0; lN < fN; lN++) {
     double lSin = sin(lN * phi); // No need to recalculate for each power
     double lCos = cos(lN * phi); // No need to recalculate for each power
@@ -55,39 +99,96 @@ void GFWCumulant::FillArray(int ptin, double phi, double weight, double SecondWe
         lPrefactor = pow(weight, lPow);
       double qsin = lPrefactor * lSin;
       double qcos = lPrefactor * lCos;
-      fQvector[ptin][lN][lPow] += complex<double>(qcos, qsin);
+      lQ[fQOffsets[lN] + lPow] += complex<double>(qcos, qsin);
     }
   }
   Inc();
 };
-void GFWCumulant::ResetQs()
+void GFWCumulant::FillArray(int nPart, const int* ptin, const double* phi, const double* weight, const double* secondWeight)
 {
-  if (!fNEntries)
-    return; // If 0 entries, then no need to reset. Otherwise, if -1, then just initialized and need to set to 0.
-  for (int i = 0; i < fPt; i++) {
-    fFilledPts[i] = false;
+  if (!fInitialized)
+    CreateComplexVectorArray(1, 1, 1);
+  fBlockCos.resize(kBlockSize);
+  fBlockSin.resize(kBlockSize);
+  fBlockCosN.resize(kBlockSize);
+  fBlockSinN.resize(kBlockSize);
+  fBlockPref.resize(kBlockSize);
+  int lBins[kBlockSize];
+  double* lCos1 = fBlockCos.data();
+  double* lSin1 = fBlockSin.data();
+  double* lCosN = fBlockCosN.data();
+  double* lSinN = fBlockSinN.data();
+  double* lPref = fBlockPref.data();
+  for (int lStart = 0; lStart < nPart; lStart += kBlockSize) {
+    const int lN1 = std::min(kBlockSize, nPart - lStart);
+    const double* lPhi = phi + lStart;
+    const double* lW = weight + lStart;
+    const double* lSW = secondWeight ? secondWeight + lStart : nullptr;
+    // pt bins, same convention as the single-particle FillArray: out-of-range particles are not filled
+    for (int i = 0; i < lN1; i++) {
+      int lBin = (fPt == 1) ? 0 : ptin[lStart + i];
+      lBins[i] = (lBin < 0 || lBin >= fPt) ? -1 : lBin;
+    }
+    for (int i = 0; i < lN1; i++) {
+      if (lBins[i] < 0)
+        continue;
+      fFilledPts[lBins[i]] = true;
+      Inc();
+    }
+    // a single sin/cos per particle, higher harmonics from the recurrence
+    for (int i = 0; i < lN1; i++) {
+      lCos1[i] = cos(lPhi[i]);
+      lSin1[i] = sin(lPhi[i]);
+      lCosN[i] = 1.;
+      lSinN[i] = 0.;
+    }
     for (int lN = 0; lN < fN; lN++) {
+      if (lN > 0)
+        AdvanceHarmonic(lN1, lCos1, lSin1, lCosN, lSinN);
       for (int lPow = 0; lPow < PW(lN); lPow++) {
-        fQvector[i][lN][lPow] = fNullQ;
+        // running product instead of pow: w^p, or SW^(p-1)*w if the second weight is specified
+        if (lPow == 0) {
+          std::fill(lPref, lPref + lN1, 1.);
+        } else if (lPow == 1 || !lSW) {
+          for (int i = 0; i < lN1; i++)
+            lPref[i] *= lW[i];
+        } else {
+          for (int i = 0; i < lN1; i++)
+            lPref[i] *= (lSW[i] > 0) ? lSW[i] : lW[i];
+        }
+        // accumulate in particle order, such that each Q-vector sums in the same order as the single-particle fill
+        const int lOffset = fQOffsets[lN] + lPow;
+        if (fPt == 1) {
+          complex<double>& lQ = fQvector[lOffset];
+          for (int i = 0; i < lN1; i++)
+            lQ += complex<double>(lPref[i] * lCosN[i], lPref[i] * lSinN[i]);
+        } else {
+          for (int i = 0; i < lN1; i++) {
+            if (lBins[i] < 0)
+              continue;
+            fQvector[lBins[i] * fPtStride + lOffset] += complex<double>(lPref[i] * lCosN[i], lPref[i] * lSinN[i]);
+          }
+        }
       }
     }
   }
+};
+void GFWCumulant::ResetQs()
+{
+  if (!fNEntries)
+    return; // If 0 entries, then no need to reset. Otherwise, if -1, then just initialized and need to set to 0.
+  std::fill(fFilledPts.begin(), fFilledPts.end(), false);
+  std::fill(fQvector.begin(), fQvector.end(), fNullQ);
   fNEntries = 0;
 };
 void GFWCumulant::DestroyComplexVectorArray()
 {
   if (!fInitialized)
     return;
-  for (int l_n = 0; l_n < fN; l_n++) {
-    for (int i = 0; i < fPt; i++) {
-      delete[] fQvector[i][l_n];
-    }
-  }
-  for (int i = 0; i < fPt; i++) {
-    delete[] fQvector[i];
-  }
-  delete[] fQvector;
-  delete[] fFilledPts;
+  fQvector.clear();
+  fQOffsets.clear();
+  fFilledPts.clear();
+  fPtStride = 0;
   fInitialized = false;
   fNEntries = -1;
 };
@@ -106,33 +207,32 @@ void GFWCumulant::CreateComplexVectorArrayVarPower(int N, vector<int> PowVec, in
   fN = N;
   fPow = 0;
   fPt = Pt;
-  fFilledPts = new bool[Pt];
+  fFilledPts.assign(Pt, false);
   fPowVec = PowVec;
-  fQvector = new complex<double>**[fPt];
-  for (int i = 0; i < fPt; i++) {
-    fQvector[i] = new complex<double>*[fN];
-  }
+  fQOffsets.resize(fN);
+  int lSize = 0;
   for (int l_n = 0; l_n < fN; l_n++) {
-    for (int i = 0; i < fPt; i++) {
-      fQvector[i][l_n] = new complex<double>[PW(l_n)];
-    }
+    fQOffsets[l_n] = lSize;
+    lSize += PW(l_n);
   }
+  fPtStride = ((lSize + kCacheLineQs - 1) / kCacheLineQs) * kCacheLineQs;
+  fQvector.assign(fPt * fPtStride, fNullQ);
   ResetQs();
   fInitialized = true;
 };
-complex<double> GFWCumulant::Vec(int n, int p, int ptbin)
+complex<double> GFWCumulant::Vec(int n, int p, int ptbin) const
 {
   if (!fInitialized)
     return 0;
   if (ptbin >= fPt || ptbin < 0)
     ptbin = 0;
   if (n >= 0)
-    return fQvector[ptbin][n][p];
-  return conj(fQvector[ptbin][-n][p]);
+    return Q(ptbin, n, p);
+  return conj(Q(ptbin, -n, p));
 };
 bool GFWCumulant::IsPtBinFilled(int ptb)
 {
-  if (!fFilledPts)
+  if (fFilledPts.empty())
     return false;
   if (ptb > 0) {
     if (fPt == 1)
@@ -30,6 +30,9 @@ class GFWCumulant
   ~GFWCumulant();
   void ResetQs();
   void FillArray(int ptin, double phi, double weight = 1, double SecondWeight = -1);
+  // Block version of FillArray for nPart particles given as arrays (secondWeight can be omitted)
+  // Harmonics are built by complex recurrence from a single sin/cos per particle; results agree with FillArray within rounding
+  void FillArray(int nPart, const int* ptin, const double* phi, const double* weight, const double* secondWeight = nullptr);
   enum UsedFlags_t { kBlank = 0,
                      kFull = 1,
                      kPt = 2 };
@@ -39,25 +42,37 @@ class GFWCumulant
     fUsed = infl;
   };
   void Inc() { fNEntries++; }
-  int GetN() { return fNEntries; }
+  int GetN() const { return fNEntries; }
   bool IsPtBinFilled(int ptb);
   void CreateComplexVectorArray(int N = 1, int P = 1, int Pt = 1);
   void CreateComplexVectorArrayVarPower(int N = 1, std::vector<int> Pvec = {1}, int Pt = 1);
   int PW(int ind) { return fPowVec.at(ind); }; // No checks to speed up, be carefull!!!
   void DestroyComplexVectorArray();
-  std::complex<double> Vec(int, int, int ptbin = 0); // envelope class to summarize pt-dif. Q-vec getter
+  std::complex<double> Vec(int, int, int ptbin = 0) const; // envelope class to summarize pt-dif. Q-vec getter
  protected:
-  std::complex<double>*** fQvector;
+  // Q-vectors of all pt bins, harmonics and powers in one contiguous array: [ptbin][harmonic][power]
+  // Each pt bin block is padded to a multiple of a cache line
+  std::vector<std::complex<double>> fQvector; //!
+  std::vector<int> fQOffsets;                 //! Offset of each harmonic within a pt bin block
+  int fPtStride;                              //! Size of a pt bin block
   uint fUsed;
   int fNEntries;
   // Q-vectors. Could be done recursively, but maybe defining each one of them explicitly is easier to read
-  int fN;                   //! Harmonics
-  int fPow;                 //! Power
-  std::vector<int> fPowVec; //! Powers array
-  int fPt;                  //! fPt bins
-  bool* fFilledPts;
-  bool fInitialized; // Arrays are initialized
+  int fN;                       //! Harmonics
+  int fPow;                     //! Power
+  std::vector<int> fPowVec;     //! Powers array
+  int fPt;                      //! fPt bins
+  std::vector<char> fFilledPts; //!
+  bool fInitialized;            // Arrays are initialized
   std::complex<double> fNullQ = 0;
+  // Scratch arrays of the block FillArray
+  std::vector<double> fBlockCos;  //!
+  std::vector<double> fBlockSin;  //!
+  std::vector<double> fBlockCosN; //!
+  std::vector<double> fBlockSinN; //!
+  std::vector<double> fBlockPref; //!
+  std::complex<double>& Q(int ptin, int lN, int lPow) { return fQvector[ptin * fPtStride + fQOffsets[lN] + lPow]; }
+  const std::complex<double>& Q(int ptin, int lN, int lPow) const { return fQvector[ptin * fPtStride + fQOffsets[lN] + lPow]; }
 };
 
 #endif // PWGCF_GENERICFRAMEWORK_CORE_GFWCUMULANT_H_
@@ -11,6 +11,8 @@
 
 #include "PWGDQ/Core/AnalysisCompositeCut.h"
 
+#include <algorithm>
+
 ClassImp(AnalysisCompositeCut)
 
   //____________________________________________________________________________
@@ -68,3 +70,36 @@ bool AnalysisCompositeCut::IsSelected(float* values)
     return false;
   }
 }
+
+void AnalysisCompositeCut::IsSelectedBatch(const ValuesBlock& block, uint8_t* decisions)
+{
+  //
+  // apply cuts on a block of candidates, combining the decisions of the AND / OR tree
+  //
+  const int n = block.GetSize();
+  const uint8_t init = (fOptionUseAND ? 1 : 0);
+  std::fill(decisions, decisions + n, init);
+  fBatchScratch.resize(n);
+  uint8_t* subDecisions = fBatchScratch.data();
+
+  auto combine = [&]() {
+    if (fOptionUseAND) {
+      for (int i = 0; i < n; ++i) {
+        decisions[i] &= subDecisions[i];
+      }
+    } else {
+      for (int i = 0; i < n; ++i) {
+        decisions[i] |= subDecisions[i];
+      }
+    }
+  };
+
+  for (auto& cut : fCutList) {
+    cut.IsSelectedBatch(block, subDecisions);
+    combine();
+  }
+  for (auto& cut : fCompositeCutList) {
+    cut.IsSelectedBatch(block, subDecisions);
+    combine();
+  }
+}
@@ -43,6 +43,7 @@ class AnalysisCompositeCut : public AnalysisCut
   int GetNCuts() const { return fCutList.size() + fCompositeCutList.size(); }
 
   bool IsSelected(float* values) override;
+  void IsSelectedBatch(const ValuesBlock& block, uint8_t* decisions) override;
 
  protected:
   bool fOptionUseAND;                                  // true (default): apply AND on all cuts; false: use OR
@@ -11,13 +11,20 @@
 
 #include "PWGDQ/Core/AnalysisCut.h"
 
+#include <algorithm>
+
+#include "Framework/Logger.h"
+
 ClassImp(AnalysisCut);
 
 std::vector<int> AnalysisCut::fgUsedVars = {};
 
 //____________________________________________________________________________
 AnalysisCut::AnalysisCut(const char* name, const char* title) : TNamed(name, title),
-                                                                fCuts()
+                                                                fCuts(),
+                                                                fBatchScratch(),
+                                                                fBatchLow(),
+                                                                fBatchHigh()
 {
   //
   // named constructor
@@ -39,3 +46,128 @@ AnalysisCut& AnalysisCut::operator=(const AnalysisCut& c)
 
 //____________________________________________________________________________
 AnalysisCut::~AnalysisCut() = default;
+
+//____________________________________________________________________________
+void AnalysisCut::ValuesBlock::Init(int nVars, const std::vector<int>& vars, int capacity)
+{
+  //
+  // allocate one column per stored variable
+  //
+  fVars.clear();
+  for (auto var : vars) {
+    if (var >= 0 && var < nVars && std::find(fVars.begin(), fVars.end(), var) == fVars.end()) {
+      fVars.push_back(var);
+    }
+  }
+  fCapacity = capacity;
+  fSize = 0;
+  fData.assign(fVars.size() * capacity, 0.0f);
+  fColumns.assign(nVars, nullptr);
+  for (std::size_t i = 0; i < fVars.size(); ++i) {
+    fColumns[fVars[i]] = fData.data() + i * capacity;
+  }
+}
+
+//____________________________________________________________________________
+bool AnalysisCut::ValuesBlock::Add(const float* values)
+{
+  //
+  // append one candidate to the block
+  //
+  if (fSize >= fCapacity) {
+    return false;
+  }
+  for (auto var : fVars) {
+    fColumns[var][fSize] = values[var];
+  }
+  ++fSize;
+  return true;
+}
+
+//____________________________________________________________________________
+void AnalysisCut::ValuesBlock::Get(int i, float* values) const
+{
+  //
+  // copy the stored variables of one candidate back into a values array
+  //
+  for (auto var : fVars) {
+    values[var] = fColumns[var][i];
+  }
+}
+
+//____________________________________________________________________________
+void AnalysisCut::IsSelectedBatch(const ValuesBlock& block, uint8_t* decisions)
+{
+  //
+  // apply the configured cuts on a block of candidates
+  //  The loops over candidates contain no branches, such that they can be vectorized by the compiler.
+  //  Function limits are evaluated exactly (TF1::Eval) in a separate pass, only for the cuts using them.
+  //
+  for (const auto& cut : fCuts) {
+    if (!block.HasColumn(cut.fVar) || (cut.fDepVar != -1 && !block.HasColumn(cut.fDepVar)) || (cut.fDepVar2 != -1 && !block.HasColumn(cut.fDepVar2))) {
+      LOGF(fatal, "AnalysisCut %s: variables %d, %d, %d are not all stored in the values block, build it from the used variables", GetName(), cut.fVar, cut.fDepVar, cut.fDepVar2);
+    }
+  }
+
+  const int n = block.GetSize();
+  std::fill(decisions, decisions + n, uint8_t(1));
+  fBatchScratch.resize(n);
+  uint8_t* applies = fBatchScratch.data();
+
+  for (const auto& cut : fCuts) {
+    // check whether the cut applies to the candidate, based on the dependent variables
+    std::fill(applies, applies + n, uint8_t(1));
+    if (cut.fDepVar != -1) {
+      const float* dep = block.Column(cut.fDepVar);
+      const float low = cut.fDepLow, high = cut.fDepHigh;
+      const uint8_t exclude = cut.fDepExclude;
+      for (int i = 0; i < n; ++i) {
+        uint8_t inRange = (dep[i] > low) & (dep[i] <= high);
+        applies[i] &= (inRange ^ exclude);
+      }
+    }
+    if (cut.fDepVar2 != -1) {
+      const float* dep = block.Column(cut.fDepVar2);
+      const float low = cut.fDep2Low, high = cut.fDep2High;
+      const uint8_t exclude = cut.fDep2Exclude;
+      for (int i = 0; i < n; ++i) {
+        uint8_t inRange = (dep[i] > low) & (dep[i] <= high);
+        applies[i] &= (inRange ^ exclude);
+      }
+    }
+
+    const float* x = block.Column(cut.fVar);
+    const uint8_t exclude = cut.fExclude;
+    if (!cut.fFuncLow && !cut.fFuncHigh) {
+      const float low = cut.fLow, high = cut.fHigh;
+      for (int i = 0; i < n; ++i) {
+        uint8_t inRange = (x[i] >= low) & (x[i] <= high);
+        decisions[i] &= ((inRange ^ exclude) | (applies[i] ^ uint8_t(1)));
+      }
+      continue;
+    }
+
+    // function limits depend on the first dependent variable
+    const float* dep = block.Column(cut.fDepVar);
+    fBatchLow.resize(n);
+    fBatchHigh.resize(n);
+    for (int i = 0; i < n; ++i) {
+      fBatchLow[i] = (cut.fFuncLow ? cut.fFuncLow->Eval(dep[i]) : cut.fLow);
+      fBatchHigh[i] = (cut.fFuncHigh ? cut.fFuncHigh->Eval(dep[i]) : cut.fHigh);
+    }
+    const float* low = fBatchLow.data();
+    const float* high = fBatchHigh.data();
+    for (int i = 0; i < n; ++i) {
+      uint8_t inRange = (x[i] >= low[i]) & (x[i] <= high[i]);
+      decisions[i] &= ((inRange ^ exclude) | (applies[i] ^ uint8_t(1)));
+    }
+  }
+}
+
+//____________________________________________________________________________
+void AnalysisCut::CheckNMaskedCuts(std::size_t nCuts)
+{
+  if (nCuts > 64) {
+    LOGF(fatal, "AnalysisCut::FillSelectionMasks: %zu cuts given, at most 64 can be packed in the selection masks", nCuts);
+  }
+}
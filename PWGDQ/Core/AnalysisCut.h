@@ -18,6 +18,7 @@
 #define AnalysisCut_H
 
 #include <TF1.h>
+#include <cstdint>
 #include <vector>
 
 //_________________________________________________________________________
@@ -40,6 +41,42 @@ class AnalysisCut : public TNamed
 
   virtual bool IsSelected(float* values);
 
+  // Structure-of-arrays block holding the values of the used variables for a set of candidates
+  // NOTE: Only the variables given at initialization are stored (e.g. all the VarManager used variables);
+  //       evaluating a cut on a variable which is not stored is a fatal error
+  class ValuesBlock
+  {
+   public:
+    ValuesBlock() = default;
+    // nVars is the size of the values array (e.g. VarManager::kNVars), vars are the variables to be stored
+    void Init(int nVars, const std::vector<int>& vars, int capacity);
+    // copy the stored variables of one candidate (e.g. from VarManager::fgValues), returns false if the block is full
+    bool Add(const float* values);
+    // copy the stored variables of candidate i back into a values array (e.g. VarManager::fgValues)
+    void Get(int i, float* values) const;
+    void Clear() { fSize = 0; }
+    int GetSize() const { return fSize; }
+    int GetCapacity() const { return fCapacity; }
+    bool IsFull() const { return fSize >= fCapacity; }
+    bool HasColumn(int var) const { return var >= 0 && var < static_cast<int>(fColumns.size()) && fColumns[var] != nullptr; }
+    const float* Column(int var) const { return fColumns[var]; }
+
+   private:
+    int fSize = 0;
+    int fCapacity = 0;
+    std::vector<int> fVars;        // stored variables
+    std::vector<float> fData;      // contiguous storage, one column of fCapacity values per stored variable
+    std::vector<float*> fColumns;  // column pointer for each variable, nullptr if not stored
+  };
+
+  // Batch mode: evaluate the cut for all the candidates of the block, decisions[i] is set to 1 if candidate i is selected
+  virtual void IsSelectedBatch(const ValuesBlock& block, uint8_t* decisions);
+
+  // Evaluate a list of at most 64 cuts on a block of candidates; bit icut of masks[i] is set if candidate i passes cuts[icut].
+  // decisions is a scratch buffer kept by the caller, such that its memory is reused from one block to the next
+  template <typename TCut>
+  static void FillSelectionMasks(std::vector<TCut>& cuts, const ValuesBlock& block, uint64_t* masks, std::vector<uint8_t>& decisions);
+
   static std::vector<int> fgUsedVars; //! vector of used variables
 
   struct CutContainer {
@@ -65,6 +102,12 @@ class AnalysisCut : public TNamed
  protected:
   std::vector<CutContainer> fCuts;
 
+  std::vector<uint8_t> fBatchScratch; //! scratch decisions used in batch mode
+  std::vector<float> fBatchLow;       //! per-candidate lower limits from functions, batch mode
+  std::vector<float> fBatchHigh;      //! per-candidate upper limits from functions, batch mode
+
+  static void CheckNMaskedCuts(std::size_t nCuts); // fatal if the cuts do not fit in the 64 bits of the selection masks
+
   ClassDef(AnalysisCut, 1);
 };
 
@@ -174,4 +217,25 @@ inline bool AnalysisCut::IsSelected(float* values)
   return true;
 }
 
+//____________________________________________________________________________
+template <typename TCut>
+void AnalysisCut::FillSelectionMasks(std::vector<TCut>& cuts, const ValuesBlock& block, uint64_t* masks, std::vector<uint8_t>& decisions)
+{
+  //
+  // evaluate a list of cuts on a block of candidates and pack the decisions in bit masks
+  //
+  CheckNMaskedCuts(cuts.size());
+  const int n = block.GetSize();
+  decisions.resize(n);
+  for (int i = 0; i < n; ++i) {
+    masks[i] = 0;
+  }
+  for (std::size_t icut = 0; icut < cuts.size(); ++icut) {
+    cuts[icut].IsSelectedBatch(block, decisions.data());
+    for (int i = 0; i < n; ++i) {
+      masks[i] |= (uint64_t(decisions[i]) << icut);
+    }
+  }
+}
+
 #endif
@@ -42,7 +42,12 @@ HistogramManager::HistogramManager() : TNamed("", ""),
                                        fUseDefaultVariableNames(false),
                                        fBinsAllocated(0),
                                        fVariableNames(nullptr),
-                                       fVariableUnits(nullptr)
+                                       fVariableUnits(nullptr),
+                                       fFillPlansCompiled(false),
+                                       fFillPlans(),
+                                       fFillEntries(),
+                                       fFillPlanVars(),
+                                       fHistClassHandles()
 {
   //
   // Constructor
@@ -58,7 +63,12 @@ HistogramManager::HistogramManager(const char* name, const char* title, const in
                                                                                               fUseDefaultVariableNames(kFALSE),
                                                                                               fBinsAllocated(0),
                                                                                               fVariableNames(),
-                                                                                              fVariableUnits()
+                                                                                              fVariableUnits(),
+                                                                                              fFillPlansCompiled(false),
+                                                                                              fFillPlans(),
+                                                                                              fFillEntries(),
+                                                                                              fFillPlanVars(),
+                                                                                              fHistClassHandles()
 {
   //
   // Constructor
@@ -110,6 +120,7 @@ void HistogramManager::AddHistClass(const char* histClass)
   fMainList->Add(hList);
   std::list<std::vector<int>> varList;
   fVariablesMap[histClass] = varList;
+  fFillPlansCompiled = false;
 }
 
 //_________________________________________________________________
@@ -180,6 +191,7 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   std::list varList = fVariablesMap[histClass];
   varList.push_back(varVector);
   fVariablesMap[histClass] = varList;
+  fFillPlansCompiled = false;
 
   // create and configure histograms according to required options
   TH1* h = nullptr;
@@ -377,6 +389,7 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   std::list varList = fVariablesMap[histClass];
   varList.push_back(varVector);
   fVariablesMap[histClass] = varList;
+  fFillPlansCompiled = false;
 
   TH1* h = nullptr;
   switch (dimension) {
@@ -543,6 +556,7 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   std::list varList = fVariablesMap[histClass];
   varList.push_back(varVector);
   fVariablesMap[histClass] = varList;
+  fFillPlansCompiled = false;
 
   uint32_t nbins = 1;
   THnBase* h = nullptr;
@@ -620,6 +634,7 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   std::list varList = fVariablesMap[histClass];
   varList.push_back(varVector);
   fVariablesMap[histClass] = varList;
+  fFillPlansCompiled = false;
 
   // get the min and max for each axis
   auto* xmin = new double[nDimensions];
@@ -674,126 +689,153 @@ void HistogramManager::FillHistClass(const char* className, Float_t* values)
 {
   //
   //  fill a class of histograms
+  //  NOTE: this resolves the class name on every call; in hot loops, cache the handle from GetHistClassHandle()
   //
+  FillHistClass(GetHistClassHandle(className), values);
+}
 
-  // get the needed histogram list
-  auto* hList = reinterpret_cast<TList*>(fMainList->FindObject(className));
-  if (!hList) {
-    // TODO: add some meaningfull error message
-    /*LOG(warn) << "HistogramManager::FillHistClass(): Histogram list " << className << " not found!";
-    LOG(warn) << "         Histogram list not filled" << endl; */
-    return;
-  }
-
-  // get the corresponding std::list containng identifiers to the needed variables to be filled
-  list varList = fVariablesMap[className];
-
-  TIter next(hList);
-
-  TObject* h = nullptr;
-  bool isProfile;
-  bool isTHn;
-  int dimension = 0;
-  bool isSparse = kFALSE;
-  // TODO: At the moment, maximum 20 dimensions are foreseen for the THn histograms. We should make this more dynamic
-  //       But maybe its better to have it like to avoid dynamically allocating this array in the histogram loop
-  double fillValues[20] = {0.0};
-  int varX = -1, varY = -1, varZ = -1, varT = -1, varW = -1;
-
-  // loop over the histogram and std::list
-  // NOTE: these two should contain the same number of elements and be synchronized, otherwise its a mess
-  for (auto varIter = varList.begin(); varIter != varList.end(); varIter++) {
-    h = next(); // get the histogram
-    // decode information from the vector of indices
-    isProfile = (varIter->at(0) == 1 ? true : false);
-    isTHn = (varIter->at(1) > 0 ? true : false);
-    if (isTHn) {
-      dimension = varIter->at(1);
-    } else {
-      dimension = (reinterpret_cast<TH1*>(h))->GetDimension();
+//____________________________________________________________________________________
+void HistogramManager::CompileFillPlans()
+{
+  //
+  // Translate the histogram lists and the variable map into flat fill plans
+  //  The histogram type is decoded here once, such that the fill loop does not need any lookup
+  //
+  fFillPlans.clear();
+  fFillEntries.clear();
+  fFillPlanVars.clear();
+  fHistClassHandles.clear();
+
+  for (int iClass = 0; iClass < fMainList->GetEntries(); ++iClass) {
+    auto* hList = reinterpret_cast<TList*>(fMainList->At(iClass));
+    HistFillPlan plan{static_cast<int>(fFillEntries.size()), 0};
+    const auto& varList = fVariablesMap[hList->GetName()];
+
+    TIter next(hList);
+    // NOTE: the histogram list and the std::list of variables are synchronized
+    for (const auto& varVector : varList) {
+      TObject* h = next();
+      HistFillEntry entry{h, kFillTH1, varVector[2], 0, static_cast<int>(fFillPlanVars.size())};
+      bool isProfile = (varVector[0] == 1);
+      if (varVector[1] > 0) { // THn
+        entry.fKind = kFillTHn;
+        entry.fNVars = varVector[1];
+        if (entry.fNVars > kMaxTHnDimensions) {
+          LOG(fatal) << "HistogramManager::CompileFillPlans(): Histogram " << h->GetName() << " has more than " << kMaxTHnDimensions << " dimensions";
+        }
+        for (int i = 0; i < entry.fNVars; ++i) {
+          fFillPlanVars.push_back(varVector[3 + i]);
+        }
+      } else {
+        int dimension = (reinterpret_cast<TH1*>(h))->GetDimension();
+        switch (dimension) {
+          case 1:
+            entry.fKind = (isProfile ? kFillProfile : kFillTH1);
+            entry.fNVars = (isProfile ? 2 : 1);
+            break;
+          case 2:
+            entry.fKind = (isProfile ? kFillProfile2D : kFillTH2);
+            entry.fNVars = (isProfile ? 3 : 2);
+            break;
+          case 3:
+            entry.fKind = (isProfile ? kFillProfile3D : kFillTH3);
+            entry.fNVars = (isProfile ? 4 : 3);
+            break;
+          default:
+            continue;
+        }
+        for (int i = 0; i < entry.fNVars; ++i) {
+          fFillPlanVars.push_back(varVector[3 + i]);
+        }
+      }
+      fFillEntries.push_back(entry);
     }
+    plan.fLast = static_cast<int>(fFillEntries.size());
+    fFillPlans.push_back(plan);
+    fHistClassHandles[hList->GetName()] = iClass;
+  }
+  fFillPlansCompiled = true;
+}
 
-    // get the various variable indices
-    varW = varIter->at(2);
-    if (isTHn) {
-      for (int i = 0; i < dimension; i++) {
-        fillValues[i] = values[varIter->at(3 + i)];
-      }
-    } else {
-      varX = varIter->at(3);
-      varY = varIter->at(4);
-      varZ = varIter->at(5);
-      varT = varIter->at(6);
-    }
+//____________________________________________________________________________________
+int HistogramManager::GetHistClassHandle(const char* className)
+{
+  //
+  // Get the handle of a histogram class, kNothing if the class does not exist
+  //
+  if (!fFillPlansCompiled) {
+    CompileFillPlans();
+  }
+  auto it = fHistClassHandles.find(std::string_view(className));
+  if (it == fHistClassHandles.end()) {
+    return kNothing;
+  }
+  return it->second;
+}
 
-    if (!isTHn) {
-      switch (dimension) {
-        case 1:
-          if (isProfile) {
-            if (varW > kNothing) {
-              (reinterpret_cast<TProfile*>(h))->Fill(values[varX], values[varY], values[varW]);
-            } else {
-              (reinterpret_cast<TProfile*>(h))->Fill(values[varX], values[varY]);
-            }
-          } else {
-            if (varW > kNothing) {
-              (reinterpret_cast<TH1F*>(h))->Fill(values[varX], values[varW]);
-            } else {
-              (reinterpret_cast<TH1F*>(h))->Fill(values[varX]);
-            }
-          }
-          break;
-        case 2:
-          if (isProfile) {
-            if (varW > kNothing) {
-              (reinterpret_cast<TProfile2D*>(h))->Fill(values[varX], values[varY], values[varZ], values[varW]);
-            } else {
-              (reinterpret_cast<TProfile2D*>(h))->Fill(values[varX], values[varY], values[varZ]);
-            }
-          } else {
-            if (varW > kNothing) {
-              (reinterpret_cast<TH2F*>(h))->Fill(values[varX], values[varY], values[varW]);
-            } else {
-              (reinterpret_cast<TH2F*>(h))->Fill(values[varX], values[varY]);
-            }
-          }
-          break;
-        case 3:
-          if (isProfile) {
-            if (varW > kNothing) {
-              (reinterpret_cast<TProfile3D*>(h))->Fill(values[varX], values[varY], values[varZ], values[varT], values[varW]);
-            } else {
-              (reinterpret_cast<TProfile3D*>(h))->Fill(values[varX], values[varY], values[varZ], values[varT]);
-            }
-          } else {
-            if (varW > kNothing) {
-              (reinterpret_cast<TH3F*>(h))->Fill(values[varX], values[varY], values[varZ], values[varW]);
-            } else {
-              (reinterpret_cast<TH3F*>(h))->Fill(values[varX], values[varY], values[varZ]);
-            }
-          }
-          break;
-
-        default:
-          break;
-      } // end switch
-      // end if(!isTHn)
-    } else {
-      if (varW > kNothing) {
-        if (isSparse) {
-          (reinterpret_cast<THnSparseF*>(h))->Fill(fillValues, values[varW]);
+//____________________________________________________________________________________
+void HistogramManager::FillHistClass(int handle, Float_t* values)
+{
+  //
+  // fill a class of histograms using its precompiled fill plan
+  //
+  if (handle < 0) {
+    return;
+  }
+  if (!fFillPlansCompiled) {
+    CompileFillPlans();
+  }
+
+  double fillValues[kMaxTHnDimensions] = {0.0};
+  const HistFillPlan& plan = fFillPlans[handle];
+  for (int iEntry = plan.fFirst; iEntry < plan.fLast; ++iEntry) {
+    const HistFillEntry& entry = fFillEntries[iEntry];
+    const int* vars = &fFillPlanVars[entry.fVarsOffset];
+    TObject* h = entry.fHist;
+    const bool weighted = (entry.fVarW > kNothing);
+    const double w = (weighted ? values[entry.fVarW] : 1.0);
+
+    switch (entry.fKind) {
+      case kFillTH1:
+        (reinterpret_cast<TH1*>(h))->Fill(values[vars[0]], w);
+        break;
+      case kFillTH2:
+        (reinterpret_cast<TH2*>(h))->Fill(values[vars[0]], values[vars[1]], w);
+        break;
+      case kFillTH3:
+        (reinterpret_cast<TH3*>(h))->Fill(values[vars[0]], values[vars[1]], values[vars[2]], w);
+        break;
+      case kFillProfile:
+        if (weighted) {
+          (reinterpret_cast<TProfile*>(h))->Fill(values[vars[0]], values[vars[1]], w);
         } else {
-          (reinterpret_cast<THnF*>(h))->Fill(fillValues, values[varW]);
+          (reinterpret_cast<TProfile*>(h))->Fill(values[vars[0]], values[vars[1]]);
         }
-      } else {
-        if (isSparse) {
-          (reinterpret_cast<THnSparseF*>(h))->Fill(fillValues);
+        break;
+      case kFillProfile2D:
+        if (weighted) {
+          (reinterpret_cast<TProfile2D*>(h))->Fill(values[vars[0]], values[vars[1]], values[vars[2]], w);
         } else {
-          (reinterpret_cast<THnF*>(h))->Fill(fillValues);
+          (reinterpret_cast<TProfile2D*>(h))->Fill(values[vars[0]], values[vars[1]], values[vars[2]]);
         }
-      }
-    } // end else
-  }   // end loop over histograms
+        break;
+      case kFillProfile3D:
+        if (weighted) {
+          (reinterpret_cast<TProfile3D*>(h))->Fill(values[vars[0]], values[vars[1]], values[vars[2]], values[vars[3]], w);
+        } else {
+          (reinterpret_cast<TProfile3D*>(h))->Fill(values[vars[0]], values[vars[1]], values[vars[2]], values[vars[3]]);
+        }
+        break;
+      case kFillTHn:
+        for (int i = 0; i < entry.fNVars; ++i) {
+          fillValues[i] = values[vars[i]];
+        }
+        (reinterpret_cast<THnBase*>(h))->Fill(fillValues, w);
+        break;
+      default:
+        break;
+    }
+  }
 }
 
 //____________________________________________________________________________________
@@ -25,7 +25,9 @@
 #include <TArrayD.h>
 
 #include <string>
+#include <string_view>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <list>
 
@@ -85,6 +87,11 @@ class HistogramManager : public TNamed
                     TString* axLabels = nullptr, int varW = -1, bool useSparse = kFALSE);
 
   void FillHistClass(const char* className, float* values);
+  // Resolve a histogram class to an integer handle which can be used with the fast FillHistClass(int, float*)
+  // Handles stay valid when new histogram classes or histograms are added
+  int GetHistClassHandle(const char* className);
+  // Fill all histograms of the class corresponding to the handle, using the precompiled fill plan
+  void FillHistClass(int handle, float* values);
 
   void SetUseDefaultVariableNames(bool flag) { fUseDefaultVariableNames = flag; };
   void SetDefaultVarNames(TString* vars, TString* units);
@@ -108,6 +115,39 @@ class HistogramManager : public TNamed
   TString* fVariableNames;          //! variable names
   TString* fVariableUnits;          //! variable units
 
+  // precompiled fill plans, one per histogram class (handle = position of the class in fMainList)
+  enum HistFillKind {
+    kFillTH1 = 0,
+    kFillTH2,
+    kFillTH3,
+    kFillProfile,
+    kFillProfile2D,
+    kFillProfile3D,
+    kFillTHn
+  };
+  static constexpr int kMaxTHnDimensions = 20;
+  struct HistFillEntry {
+    TObject* fHist;  // histogram to be filled
+    int fKind;       // HistFillKind
+    int fVarW;       // variable used for weighting (kNothing if none)
+    int fNVars;      // number of variables to fill
+    int fVarsOffset; // offset of the variable indices in fFillPlanVars
+  };
+  struct HistFillPlan {
+    int fFirst; // first entry in fFillEntries
+    int fLast;  // one past the last entry in fFillEntries
+  };
+  bool fFillPlansCompiled;                                  //! whether the fill plans are in sync with the histogram lists
+  std::vector<HistFillPlan> fFillPlans;                     //! fill plan of each histogram class
+  std::vector<HistFillEntry> fFillEntries;                  //! flat array of histogram fill entries
+  std::vector<int> fFillPlanVars;                           //! flat array of variable indices used by the fill entries
+  struct HistClassNameHash {
+    using is_transparent = void; // lookup by const char* / string_view without building a std::string
+    std::size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+  };
+  std::unordered_map<std::string, int, HistClassNameHash, std::equal_to<>> fHistClassHandles; //! handle of each histogram class
+
+  void CompileFillPlans();
   void MakeAxisLabels(TAxis* ax, const char* labels);
 
   HistogramManager& operator=(const HistogramManager& c);
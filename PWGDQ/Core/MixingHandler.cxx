@@ -12,6 +12,7 @@
 #include "PWGDQ/Core/MixingHandler.h"
 #include "PWGDQ/Core/VarManager.h"
 
+#include <cmath>
 #include <iostream>
 #include <fstream>
 using namespace std;
@@ -26,7 +27,13 @@ ClassImp(MixingHandler);
 MixingHandler::MixingHandler() : TNamed(),
                                  fIsInitialized(kFALSE),
                                  fVariableLimits(),
-                                 fVariables()
+                                 fVariables(),
+                                 fIsUniform(),
+                                 fLowEdge(),
+                                 fInvBinWidth(),
+                                 fNBins(),
+                                 fCategoryStrides(),
+                                 fNCategories(0)
 {
   //
   // default constructor
@@ -37,7 +44,13 @@ MixingHandler::MixingHandler() : TNamed(),
 MixingHandler::MixingHandler(const char* name, const char* title) : TNamed(name, title),
                                                                     fIsInitialized(kFALSE),
                                                                     fVariableLimits(),
-                                                                    fVariables()
+                                                                    fVariables(),
+                                                                    fIsUniform(),
+                                                                    fLowEdge(),
+                                                                    fInvBinWidth(),
+                                                                    fNBins(),
+                                                                    fCategoryStrides(),
+                                                                    fNCategories(0)
 {
   //
   // Named constructor
@@ -63,6 +76,7 @@ void MixingHandler::AddMixingVariable(int var, int nBins, float* binLims)
   varBins.Set(nBins, binLims);
   fVariableLimits.push_back(varBins);
   VarManager::SetUseVariable(var);
+  fIsInitialized = kFALSE; // the category lookup needs to be recomputed
 }
 
 //_________________________________________________________________________
@@ -108,17 +122,48 @@ std::vector<float> MixingHandler::GetMixingVariableLimits(VarManager::Variables
 void MixingHandler::Init()
 {
   //
-  // Initialization of pools
+  // Initialization of the category lookup
   //       The correct event category will be retrieved using the function FindEventCategory()
+  //       For equidistant bin limits the bin is computed directly instead of a binary search
   //
-  int size = 1;
-  for (auto v : fVariableLimits) {
-    size *= (v.GetSize() - 1);
+  const int nVars = fVariables.size();
+  fIsUniform.assign(nVars, false);
+  fLowEdge.assign(nVars, 0.0);
+  fInvBinWidth.assign(nVars, 0.0);
+  fNBins.assign(nVars, 0);
+  fCategoryStrides.assign(nVars, 1);
+
+  fNCategories = 1;
+  for (int iVar = nVars - 1; iVar >= 0; --iVar) {
+    const TArrayF& limits = fVariableLimits[iVar];
+    const int nBins = limits.GetSize() - 1;
+    fNBins[iVar] = nBins;
+    fCategoryStrides[iVar] = fNCategories;
+    fNCategories *= nBins;
+    if (nBins < 1) {
+      continue;
+    }
+    const double width = (static_cast<double>(limits[nBins]) - limits[0]) / nBins;
+    bool isUniform = (width > 0.0);
+    for (int i = 1; i < nBins && isUniform; ++i) {
+      isUniform = std::abs(limits[i] - (limits[0] + i * width)) < 1.0e-3 * width;
+    }
+    fIsUniform[iVar] = isUniform;
+    fLowEdge[iVar] = limits[0];
+    fInvBinWidth[iVar] = (isUniform ? 1.0 / width : 0.0);
   }
-  (void)size;
   fIsInitialized = kTRUE;
 }
 
+//_________________________________________________________________________
+int MixingHandler::GetNCategories()
+{
+  if (!fIsInitialized) {
+    Init();
+  }
+  return fNCategories;
+}
+
 //_________________________________________________________________________
 int MixingHandler::FindEventCategory(float* values)
 {
@@ -132,31 +177,32 @@ int MixingHandler::FindEventCategory(float* values)
     Init();
   }
 
-  std::vector<int> bin;
-  int iVar = 0;
-  for (auto v = fVariableLimits.begin(); v != fVariableLimits.end(); v++, iVar++) {
-    int binValue = TMath::BinarySearch((*v).GetSize(), (*v).GetArray(), values[fVariables[iVar]]);
-    bin.push_back(binValue);
-    if (bin[iVar] == -1 || bin[iVar] == (*v).GetSize() - 1) {
-      return -1; // all variables must be inside limits
-    }
-  }
-
   int category = 0;
-  int tempCategory = 1;
-  int iv1 = 0;
-  int iv2 = 0;
-  for (auto v1 = fVariables.begin(); v1 != fVariables.end(); v1++, iv1++) {
-    tempCategory = 1;
-    iv2 = iv1;
-    for (auto v2 = v1; v2 != fVariables.end(); v2++, iv2++) {
-      if (iv2 == iv1) {
-        tempCategory *= bin[iv2];
-      } else {
-        tempCategory *= (fVariableLimits[iv2].GetSize() - 1);
+  const int nVars = fVariables.size();
+  for (int iVar = 0; iVar < nVars; ++iVar) {
+    const float value = values[fVariables[iVar]];
+    const TArrayF& limits = fVariableLimits[iVar];
+    const int nBins = fNBins[iVar];
+    int bin = -1;
+    if (fIsUniform[iVar]) {
+      if (std::isnan(value)) {
+        return -1;
+      }
+      // direct computation, then corrected against the actual limits such that the result is the same as for the binary search
+      const float x = (value - fLowEdge[iVar]) * fInvBinWidth[iVar];
+      bin = (x < 0.0f ? 0 : (x >= nBins ? nBins - 1 : static_cast<int>(x)));
+      if (value < limits[bin]) {
+        bin--;
+      } else if (value >= limits[bin + 1]) {
+        bin++;
       }
+    } else {
+      bin = TMath::BinarySearch(limits.GetSize(), limits.GetArray(), value);
+    }
+    if (bin < 0 || bin >= nBins) {
+      return -1; // all variables must be inside limits
     }
-    category += tempCategory;
+    category += bin * fCategoryStrides[iVar];
   }
   return category;
 }
@@ -24,6 +24,8 @@
 #include <TList.h>
 #include <TString.h>
 
+#include <vector>
+
 #include "PWGDQ/Core/HistogramManager.h"
 #include "PWGDQ/Core/VarManager.h"
 
@@ -47,6 +49,7 @@ class MixingHandler : public TNamed
   void Init();
   int FindEventCategory(float* values);
   int GetBinFromCategory(VarManager::Variables var, int category) const;
+  int GetNCategories();
 
  private:
   MixingHandler(const MixingHandler& handler);
@@ -58,6 +61,14 @@ class MixingHandler : public TNamed
   std::vector<TArrayF> fVariableLimits;
   std::vector<int> fVariables;
 
+  // Category lookup precomputed in Init()
+  std::vector<bool> fIsUniform;      //! variables with equidistant bin limits, for which the bin is computed directly
+  std::vector<float> fLowEdge;       //! lower edge of the first bin
+  std::vector<float> fInvBinWidth;   //! inverse bin width, for the uniform binnings
+  std::vector<int> fNBins;           //! number of bins per variable
+  std::vector<int> fCategoryStrides; //! contribution of one bin of the variable to the category number
+  int fNCategories;                  //! total number of categories
+
   ClassDef(MixingHandler, 1);
 };
 
@@ -0,0 +1,155 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//
+// Contact: iarsene@cern.ch, i.c.arsene@fys.uio.no
+//
+// Event mixing pools: one ring buffer of events per mixing category (see MixingHandler),
+// each event keeping a compact copy of its tracks. Events are mixed in streaming mode against
+// the last N events of the same category, such that the memory does not depend on the dataset size.
+//
+
+#ifndef MixingPool_H
+#define MixingPool_H
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Compact event record kept in the mixing pools, with the accessors used by VarManager::FillTwoMixEvents()
+struct MixingEventRecord {
+  float fPosX = 0.0;
+  float fPosY = 0.0;
+  float fPosZ = 0.0;
+  int fNumContrib = 0;
+
+  float posX() const { return fPosX; }
+  float posY() const { return fPosY; }
+  float posZ() const { return fPosZ; }
+  int numContrib() const { return fNumContrib; }
+};
+
+// Compact track record kept in the mixing pools, with the accessors used by VarManager::FillPairME()
+struct MixingTrackRecord {
+  float fPt = 0.0;
+  float fEta = 0.0;
+  float fPhi = 0.0;
+  int fSign = 0;
+  uint32_t fFilterMap = 0; // selection bit map of the track (barrel or muon selection, depending on the pool)
+
+  float pt() const { return fPt; }
+  float eta() const { return fEta; }
+  float phi() const { return fPhi; }
+  int sign() const { return fSign; }
+  uint32_t isBarrelSelected() const { return fFilterMap; }
+  uint32_t isMuonSelected() const { return fFilterMap; }
+};
+
+template <typename TEvent, typename TRecord>
+class MixingPool
+{
+ public:
+  MixingPool() = default;
+  ~MixingPool() = default;
+
+  // depth: number of events kept per category; maxRecords: maximum number of records kept per event (0 = no limit).
+  // Events with more records keep a uniform random subsample of them (reservoir sampling), independent of the record order
+  void Init(int depth, int maxRecords = 0)
+  {
+    fDepth = depth;
+    fMaxRecords = maxRecords;
+    fPools.clear();
+    fCurrent = nullptr;
+    fNOffered = 0;
+    fRandom.seed(std::minstd_rand::default_seed);
+  }
+
+  int GetDepth() const { return fDepth; }
+  int GetNEvents(int category) const
+  {
+    return (category >= 0 && category < static_cast<int>(fPools.size())) ? fPools[category].fNEvents : 0;
+  }
+
+  // Call f(const TEvent& event, const std::vector<TRecord>& records) for the stored events of the category, oldest first
+  template <typename F>
+  void ForEachEvent(int category, F&& f) const
+  {
+    if (category < 0 || category >= static_cast<int>(fPools.size())) {
+      return;
+    }
+    const Pool& pool = fPools[category];
+    const int first = (pool.fNEvents < fDepth) ? 0 : pool.fNext;
+    for (int i = 0; i < pool.fNEvents; ++i) {
+      const Slot& slot = pool.fSlots[(first + i) % fDepth];
+      f(slot.fEvent, slot.fRecords);
+    }
+  }
+
+  // Start a new event in the pool of the category, overwriting the oldest event if the pool is full.
+  // The records are then added with AddRecord(); the memory of the overwritten event is reused.
+  void StartEvent(int category, const TEvent& event)
+  {
+    fCurrent = nullptr;
+    fNOffered = 0;
+    if (category < 0 || fDepth <= 0) {
+      return;
+    }
+    if (category >= static_cast<int>(fPools.size())) {
+      fPools.resize(category + 1);
+    }
+    Pool& pool = fPools[category];
+    if (static_cast<int>(pool.fSlots.size()) < fDepth) {
+      pool.fSlots.resize(fDepth);
+    }
+    fCurrent = &pool.fSlots[pool.fNext];
+    fCurrent->fEvent = event;
+    fCurrent->fRecords.clear();
+    pool.fNext = (pool.fNext + 1) % fDepth;
+    if (pool.fNEvents < fDepth) {
+      pool.fNEvents++;
+    }
+  }
+  void AddRecord(const TRecord& record)
+  {
+    if (fCurrent == nullptr) {
+      return;
+    }
+    fNOffered++;
+    if (fMaxRecords <= 0 || static_cast<int>(fCurrent->fRecords.size()) < fMaxRecords) {
+      fCurrent->fRecords.push_back(record);
+      return;
+    }
+    // the n-th record replaces a kept one with probability maxRecords / n
+    const auto index = fRandom() % fNOffered;
+    if (index < static_cast<uint64_t>(fMaxRecords)) {
+      fCurrent->fRecords[index] = record;
+    }
+  }
+
+ private:
+  struct Slot {
+    TEvent fEvent;
+    std::vector<TRecord> fRecords;
+  };
+  struct Pool {
+    std::vector<Slot> fSlots; // ring buffer, allocated when the first event of the category arrives
+    int fNext = 0;            // slot to be written next
+    int fNEvents = 0;         // number of stored events
+  };
+
+  int fDepth = 0;
+  int fMaxRecords = 0;
+  std::vector<Pool> fPools; // indexed by the mixing category
+  Slot* fCurrent = nullptr; // event being filled
+  uint64_t fNOffered = 0;   // number of records offered to the current event
+  std::minstd_rand fRandom; // subsampling of the records, with a fixed seed for reproducible pools
+};
+
+#endif
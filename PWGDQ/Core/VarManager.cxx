@@ -9,6 +9,7 @@
 // granted to it by virtue of its status as an Intergovernmental Organization
 // or submit itself to any jurisdiction.
 #include <cmath>
+#include <initializer_list>
 #include "PWGDQ/Core/VarManager.h"
 #include "Tools/KFparticle/KFUtilities.h"
 
@@ -21,6 +22,7 @@ ClassImp(VarManager);
 TString VarManager::fgVariableNames[VarManager::kNVars] = {""};
 TString VarManager::fgVariableUnits[VarManager::kNVars] = {""};
 bool VarManager::fgUsedVars[VarManager::kNVars] = {false};
+uint32_t VarManager::fgUsedVarGroups = 0;
 bool VarManager::fgUsedKF = false;
 float VarManager::fgMagField = 0.5;
 float VarManager::fgValues[VarManager::kNVars] = {0.0f};
@@ -80,6 +82,40 @@ void VarManager::SetVariableDependencies()
     fgUsedVars[kKFTrack0DCAxy] = kTRUE;
     fgUsedVars[kKFTrack1DCAxy] = kTRUE;
   }
+
+  SetUsedVarGroups();
+}
+
+//__________________________________________________________________
+void VarManager::SetUsedVarGroups()
+{
+  //
+  // Flag the groups of variables which the Fill functions compute together,
+  // so that they check a single bit instead of each variable of an unused group
+  //
+  auto flagGroup = [](uint32_t group, std::initializer_list<int> vars) {
+    for (auto var : vars) {
+      if (fgUsedVars[var]) {
+        fgUsedVarGroups |= group;
+        return;
+      }
+    }
+  };
+  flagGroup(kVarGroupTrackFlags, {kIsITSrefit, kTrackTimeResIsRange, kIsTPCrefit, kPVContributor, kIsGoldenChi2, kOrphanTrack,
+                                  kIsSPDfirst, kIsSPDboth, kIsSPDany, kITSClusterMap, kIsITSibFirst, kIsITSibAny, kIsITSibAll});
+  flagGroup(kVarGroupTrackDCASig, {kTrackDCAsigXY, kTrackDCAsigZ, kTrackDCAresXY, kTrackDCAresZ});
+  flagGroup(kVarGroupPairPolarization, {kCosThetaHE, kPhiHE, kCosThetaCS, kPhiCS});
+  flagGroup(kVarGroupPairQuadDCA, {kQuadDCAabsXY, kQuadDCAsigXY, kQuadDCAabsZ, kQuadDCAsigZ, kQuadDCAsigXYZ, kSignQuadDCAsigXY});
+  flagGroup(kVarGroupPairCumulants, {kCORR2REF, kCORR2POI, kCORR4REF, kCORR4POI, kC4REF, kC4POI, kV4});
+
+  // the vertexing variables are contiguous in the enum, apart from the cosine of the pointing angle and the KF mass
+  flagGroup(kVarGroupPairVertexing, {kCosPointingAngle, kKFMass});
+  for (int var = kVertexingLxy; var <= kVertexingChi2PCA; ++var) {
+    flagGroup(kVarGroupPairVertexing, {var});
+  }
+  for (int var = kVertexingLxyOverErr; var <= kKFCosPA; ++var) {
+    flagGroup(kVarGroupPairVertexing, {var});
+  }
 }
 
 //__________________________________________________________________
@@ -601,6 +601,17 @@ class VarManager : public TObject
     kToRabs
   };
 
+  // Groups of variables computed together in the Fill functions. A group is flagged as used as soon as one of its
+  // variables is used, such that the Fill functions skip the whole computation of unused groups with a single check
+  enum UsedVarGroups {
+    kVarGroupTrackFlags = BIT(0),       // track flags and ITS cluster map based quantities
+    kVarGroupTrackDCASig = BIT(1),      // track DCA significances and resolutions
+    kVarGroupPairPolarization = BIT(2), // helicity and Collins-Soper frame angles of the pair
+    kVarGroupPairQuadDCA = BIT(3),      // quadratic sums of the leg DCAs
+    kVarGroupPairVertexing = BIT(4),    // secondary vertex reconstruction (DCA fitter or KF) of pairs and dilepton-track triplets
+    kVarGroupPairCumulants = BIT(5)     // two- and four-particle cumulants of the dilepton flow
+  };
+
   static TString fgVariableNames[kNVars]; // variable names
   static TString fgVariableUnits[kNVars]; // variable units
   static void SetDefaultVarNames();
@@ -626,6 +637,7 @@ class VarManager : public TObject
     for (auto& var : usedVars) {
       fgUsedVars[var] = true;
     }
+    SetVariableDependencies();
   }
   static bool GetUsedVar(int var)
   {
@@ -634,6 +646,10 @@ class VarManager : public TObject
     }
     return false;
   }
+  static bool IsVarGroupUsed(uint32_t group)
+  {
+    return (fgUsedVarGroups & group) > 0;
+  }
 
   static void SetRunNumbers(int n, int* runs);
   static void SetRunNumbers(std::vector<int> runs);
@@ -836,8 +852,10 @@ class VarManager : public TObject
 
  private:
   static bool fgUsedVars[kNVars]; // holds flags for when the corresponding variable is needed (e.g., in the histogram manager, in cuts, mixing handler, etc.)
+  static uint32_t fgUsedVarGroups; // bit map of the used variable groups (UsedVarGroups), updated together with fgUsedVars
   static bool fgUsedKF;
   static void SetVariableDependencies(); // toggle those variables on which other used variables might depend
+  static void SetUsedVarGroups();        // flag the variable groups containing at least one used variable
 
   static float fgMagField;
   static std::map<int, int> fgRunMap;     // map of runs to be used in histogram axes
@@ -1468,45 +1486,47 @@ void VarManager::FillTrack(T const& track, float* values)
   if constexpr ((fillMap & TrackExtra) > 0 || (fillMap & ReducedTrackBarrel) > 0) {
     values[kPin] = track.tpcInnerParam();
     values[kSignedPin] = track.tpcInnerParam() * track.sign();
-    if (fgUsedVars[kIsITSrefit]) {
-      values[kIsITSrefit] = (track.flags() & o2::aod::track::ITSrefit) > 0; // NOTE: This is just for Run-2
-    }
-    if (fgUsedVars[kTrackTimeResIsRange]) {
-      values[kTrackTimeResIsRange] = (track.flags() & o2::aod::track::TrackTimeResIsRange) > 0; // NOTE: This is NOT for Run-2
-    }
-    if (fgUsedVars[kIsTPCrefit]) {
-      values[kIsTPCrefit] = (track.flags() & o2::aod::track::TPCrefit) > 0; // NOTE: This is just for Run-2
-    }
-    if (fgUsedVars[kPVContributor]) {
-      values[kPVContributor] = (track.flags() & o2::aod::track::PVContributor) > 0; // NOTE: This is NOT for Run-2
-    }
-    if (fgUsedVars[kIsGoldenChi2]) {
-      values[kIsGoldenChi2] = (track.flags() & o2::aod::track::GoldenChi2) > 0; // NOTE: This is just for Run-2
-    }
-    if (fgUsedVars[kOrphanTrack]) {
-      values[kOrphanTrack] = (track.flags() & o2::aod::track::OrphanTrack) > 0; // NOTE: This is NOT for Run-2
-    }
-    if (fgUsedVars[kIsSPDfirst]) {
-      values[kIsSPDfirst] = (track.itsClusterMap() & uint8_t(1)) > 0;
-    }
-    if (fgUsedVars[kIsSPDboth]) {
-      values[kIsSPDboth] = (track.itsClusterMap() & uint8_t(3)) > 0;
-    }
-    if (fgUsedVars[kIsSPDany]) {
-      values[kIsSPDany] = (track.itsClusterMap() & uint8_t(1)) || (track.itsClusterMap() & uint8_t(2));
-    }
-    if (fgUsedVars[kITSClusterMap]) {
-      values[kITSClusterMap] = track.itsClusterMap();
-    }
+    if (IsVarGroupUsed(kVarGroupTrackFlags)) {
+      if (fgUsedVars[kIsITSrefit]) {
+        values[kIsITSrefit] = (track.flags() & o2::aod::track::ITSrefit) > 0; // NOTE: This is just for Run-2
+      }
+      if (fgUsedVars[kTrackTimeResIsRange]) {
+        values[kTrackTimeResIsRange] = (track.flags() & o2::aod::track::TrackTimeResIsRange) > 0; // NOTE: This is NOT for Run-2
+      }
+      if (fgUsedVars[kIsTPCrefit]) {
+        values[kIsTPCrefit] = (track.flags() & o2::aod::track::TPCrefit) > 0; // NOTE: This is just for Run-2
+      }
+      if (fgUsedVars[kPVContributor]) {
+        values[kPVContributor] = (track.flags() & o2::aod::track::PVContributor) > 0; // NOTE: This is NOT for Run-2
+      }
+      if (fgUsedVars[kIsGoldenChi2]) {
+        values[kIsGoldenChi2] = (track.flags() & o2::aod::track::GoldenChi2) > 0; // NOTE: This is just for Run-2
+      }
+      if (fgUsedVars[kOrphanTrack]) {
+        values[kOrphanTrack] = (track.flags() & o2::aod::track::OrphanTrack) > 0; // NOTE: This is NOT for Run-2
+      }
+      if (fgUsedVars[kIsSPDfirst]) {
+        values[kIsSPDfirst] = (track.itsClusterMap() & uint8_t(1)) > 0;
+      }
+      if (fgUsedVars[kIsSPDboth]) {
+        values[kIsSPDboth] = (track.itsClusterMap() & uint8_t(3)) > 0;
+      }
+      if (fgUsedVars[kIsSPDany]) {
+        values[kIsSPDany] = (track.itsClusterMap() & uint8_t(1)) || (track.itsClusterMap() & uint8_t(2));
+      }
+      if (fgUsedVars[kITSClusterMap]) {
+        values[kITSClusterMap] = track.itsClusterMap();
+      }
 
-    if (fgUsedVars[kIsITSibFirst]) {
-      values[kIsITSibFirst] = (track.itsClusterMap() & uint8_t(1)) > 0;
-    }
-    if (fgUsedVars[kIsITSibAny]) {
-      values[kIsITSibAny] = (track.itsClusterMap() & (1 << uint8_t(0))) > 0 || (track.itsClusterMap() & (1 << uint8_t(1))) > 0 || (track.itsClusterMap() & (1 << uint8_t(2))) > 0;
-    }
-    if (fgUsedVars[kIsITSibAll]) {
-      values[kIsITSibAll] = (track.itsClusterMap() & (1 << uint8_t(0))) > 0 && (track.itsClusterMap() & (1 << uint8_t(1))) > 0 && (track.itsClusterMap() & (1 << uint8_t(2))) > 0;
+      if (fgUsedVars[kIsITSibFirst]) {
+        values[kIsITSibFirst] = (track.itsClusterMap() & uint8_t(1)) > 0;
+      }
+      if (fgUsedVars[kIsITSibAny]) {
+        values[kIsITSibAny] = (track.itsClusterMap() & (1 << uint8_t(0))) > 0 || (track.itsClusterMap() & (1 << uint8_t(1))) > 0 || (track.itsClusterMap() & (1 << uint8_t(2))) > 0;
+      }
+      if (fgUsedVars[kIsITSibAll]) {
+        values[kIsITSibAll] = (track.itsClusterMap() & (1 << uint8_t(0))) > 0 && (track.itsClusterMap() & (1 << uint8_t(1))) > 0 && (track.itsClusterMap() & (1 << uint8_t(2))) > 0;
+      }
     }
 
     values[kTrackTime] = track.trackTime();
@@ -1555,6 +1575,30 @@ void VarManager::FillTrack(T const& track, float* values)
       values[kTrackDCAxy] = track.dcaXY();
       values[kTrackDCAz] = track.dcaZ();
       if constexpr ((fillMap & ReducedTrackBarrelCov) > 0) {
+        if (IsVarGroupUsed(kVarGroupTrackDCASig)) {
+          if (fgUsedVars[kTrackDCAsigXY]) {
+            values[kTrackDCAsigXY] = track.dcaXY() / std::sqrt(track.cYY());
+          }
+          if (fgUsedVars[kTrackDCAsigZ]) {
+            values[kTrackDCAsigZ] = track.dcaZ() / std::sqrt(track.cZZ());
+          }
+          if (fgUsedVars[kTrackDCAresXY]) {
+            values[kTrackDCAresXY] = std::sqrt(track.cYY());
+          }
+          if (fgUsedVars[kTrackDCAresZ]) {
+            values[kTrackDCAresZ] = std::sqrt(track.cZZ());
+          }
+        }
+      }
+    }
+  }
+
+  // Quantities based on the barrel track selection table
+  if constexpr ((fillMap & TrackDCA) > 0) {
+    values[kTrackDCAxy] = track.dcaXY();
+    values[kTrackDCAz] = track.dcaZ();
+    if constexpr ((fillMap & TrackCov) > 0) {
+      if (IsVarGroupUsed(kVarGroupTrackDCASig)) {
         if (fgUsedVars[kTrackDCAsigXY]) {
           values[kTrackDCAsigXY] = track.dcaXY() / std::sqrt(track.cYY());
         }
@@ -1571,26 +1615,6 @@ void VarManager::FillTrack(T const& track, float* values)
     }
   }
 
-  // Quantities based on the barrel track selection table
-  if constexpr ((fillMap & TrackDCA) > 0) {
-    values[kTrackDCAxy] = track.dcaXY();
-    values[kTrackDCAz] = track.dcaZ();
-    if constexpr ((fillMap & TrackCov) > 0) {
-      if (fgUsedVars[kTrackDCAsigXY]) {
-        values[kTrackDCAsigXY] = track.dcaXY() / std::sqrt(track.cYY());
-      }
-      if (fgUsedVars[kTrackDCAsigZ]) {
-        values[kTrackDCAsigZ] = track.dcaZ() / std::sqrt(track.cZZ());
-      }
-      if (fgUsedVars[kTrackDCAresXY]) {
-        values[kTrackDCAresXY] = std::sqrt(track.cYY());
-      }
-      if (fgUsedVars[kTrackDCAresZ]) {
-        values[kTrackDCAresZ] = std::sqrt(track.cZZ());
-      }
-    }
-  }
-
   // Quantities based on the barrel track selection table
   if constexpr ((fillMap & TrackSelection) > 0) {
     values[kIsGlobalTrack] = track.isGlobalTrack();
@@ -1824,11 +1848,13 @@ void VarManager::FillTrackCollision(T const& track, C const& collision, float* v
     values[kTrackDCAz] = dca[1];
 
     if constexpr ((fillMap & ReducedTrackBarrelCov) > 0 || (fillMap & TrackCov) > 0) {
-      if (fgUsedVars[kTrackDCAsigXY]) {
-        values[kTrackDCAsigXY] = dca[0] / std::sqrt(track.cYY());
-      }
-      if (fgUsedVars[kTrackDCAsigZ]) {
-        values[kTrackDCAsigZ] = dca[1] / std::sqrt(track.cZZ());
+      if (IsVarGroupUsed(kVarGroupTrackDCASig)) {
+        if (fgUsedVars[kTrackDCAsigXY]) {
+          values[kTrackDCAsigXY] = dca[0] / std::sqrt(track.cYY());
+        }
+        if (fgUsedVars[kTrackDCAsigZ]) {
+          values[kTrackDCAsigZ] = dca[1] / std::sqrt(track.cZZ());
+        }
       }
     }
   }
@@ -1852,11 +1878,13 @@ void VarManager::FillTrackCollisionMatCorr(T const& track, C const& collision, M
     values[kTrackDCAz] = dca[1];
 
     if constexpr ((fillMap & ReducedTrackBarrelCov) > 0 || (fillMap & TrackCov) > 0) {
-      if (fgUsedVars[kTrackDCAsigXY]) {
-        values[kTrackDCAsigXY] = dca[0] / std::sqrt(track.cYY());
-      }
-      if (fgUsedVars[kTrackDCAsigZ]) {
-        values[kTrackDCAsigZ] = dca[1] / std::sqrt(track.cZZ());
+      if (IsVarGroupUsed(kVarGroupTrackDCASig)) {
+        if (fgUsedVars[kTrackDCAsigXY]) {
+          values[kTrackDCAsigXY] = dca[0] / std::sqrt(track.cYY());
+        }
+        if (fgUsedVars[kTrackDCAsigZ]) {
+          values[kTrackDCAsigZ] = dca[1] / std::sqrt(track.cZZ());
+        }
       }
     }
   }
@@ -1974,47 +2002,49 @@ void VarManager::FillPair(T1 const& t1, T2 const& t2, float* values)
     }
   }
 
-  // TO DO: get the correct values from CCDB
-  double BeamMomentum = TMath::Sqrt(fgCenterOfMassEnergy * fgCenterOfMassEnergy / 4 - fgMassofCollidingParticle * fgMassofCollidingParticle); // GeV
-  ROOT::Math::PxPyPzEVector Beam1(0., 0., -BeamMomentum, fgCenterOfMassEnergy / 2);
-  ROOT::Math::PxPyPzEVector Beam2(0., 0., BeamMomentum, fgCenterOfMassEnergy / 2);
+  if (IsVarGroupUsed(kVarGroupPairPolarization)) {
+    // TO DO: get the correct values from CCDB
+    double BeamMomentum = TMath::Sqrt(fgCenterOfMassEnergy * fgCenterOfMassEnergy / 4 - fgMassofCollidingParticle * fgMassofCollidingParticle); // GeV
+    ROOT::Math::PxPyPzEVector Beam1(0., 0., -BeamMomentum, fgCenterOfMassEnergy / 2);
+    ROOT::Math::PxPyPzEVector Beam2(0., 0., BeamMomentum, fgCenterOfMassEnergy / 2);
 
-  // Boost to center of mass frame
-  ROOT::Math::Boost boostv12{v12.BoostToCM()};
-  ROOT::Math::XYZVectorF v1_CM{(boostv12(v1).Vect()).Unit()};
-  ROOT::Math::XYZVectorF v2_CM{(boostv12(v2).Vect()).Unit()};
-  ROOT::Math::XYZVectorF Beam1_CM{(boostv12(Beam1).Vect()).Unit()};
-  ROOT::Math::XYZVectorF Beam2_CM{(boostv12(Beam2).Vect()).Unit()};
+    // Boost to center of mass frame
+    ROOT::Math::Boost boostv12{v12.BoostToCM()};
+    ROOT::Math::XYZVectorF v1_CM{(boostv12(v1).Vect()).Unit()};
+    ROOT::Math::XYZVectorF v2_CM{(boostv12(v2).Vect()).Unit()};
+    ROOT::Math::XYZVectorF Beam1_CM{(boostv12(Beam1).Vect()).Unit()};
+    ROOT::Math::XYZVectorF Beam2_CM{(boostv12(Beam2).Vect()).Unit()};
 
-  // Helicity frame
-  ROOT::Math::XYZVectorF zaxis_HE{(v12.Vect()).Unit()};
-  ROOT::Math::XYZVectorF yaxis_HE{(Beam1_CM.Cross(Beam2_CM)).Unit()};
-  ROOT::Math::XYZVectorF xaxis_HE{(yaxis_HE.Cross(zaxis_HE)).Unit()};
+    // Helicity frame
+    ROOT::Math::XYZVectorF zaxis_HE{(v12.Vect()).Unit()};
+    ROOT::Math::XYZVectorF yaxis_HE{(Beam1_CM.Cross(Beam2_CM)).Unit()};
+    ROOT::Math::XYZVectorF xaxis_HE{(yaxis_HE.Cross(zaxis_HE)).Unit()};
 
-  // Collins-Soper frame
-  ROOT::Math::XYZVectorF zaxis_CS{((Beam1_CM.Unit() - Beam2_CM.Unit()).Unit())};
-  ROOT::Math::XYZVectorF yaxis_CS{(Beam1_CM.Cross(Beam2_CM)).Unit()};
-  ROOT::Math::XYZVectorF xaxis_CS{(yaxis_CS.Cross(zaxis_CS)).Unit()};
+    // Collins-Soper frame
+    ROOT::Math::XYZVectorF zaxis_CS{((Beam1_CM.Unit() - Beam2_CM.Unit()).Unit())};
+    ROOT::Math::XYZVectorF yaxis_CS{(Beam1_CM.Cross(Beam2_CM)).Unit()};
+    ROOT::Math::XYZVectorF xaxis_CS{(yaxis_CS.Cross(zaxis_CS)).Unit()};
 
-  if (fgUsedVars[kCosThetaHE]) {
-    values[kCosThetaHE] = (t1.sign() > 0 ? zaxis_HE.Dot(v1_CM) : zaxis_HE.Dot(v2_CM));
-  }
+    if (fgUsedVars[kCosThetaHE]) {
+      values[kCosThetaHE] = (t1.sign() > 0 ? zaxis_HE.Dot(v1_CM) : zaxis_HE.Dot(v2_CM));
+    }
 
-  if (fgUsedVars[kPhiHE]) {
-    values[kPhiHE] = (t1.sign() > 0 ? TMath::ATan2(yaxis_HE.Dot(v1_CM), xaxis_HE.Dot(v1_CM)) : TMath::ATan2(yaxis_HE.Dot(v2_CM), xaxis_HE.Dot(v2_CM)));
-  }
+    if (fgUsedVars[kPhiHE]) {
+      values[kPhiHE] = (t1.sign() > 0 ? TMath::ATan2(yaxis_HE.Dot(v1_CM), xaxis_HE.Dot(v1_CM)) : TMath::ATan2(yaxis_HE.Dot(v2_CM), xaxis_HE.Dot(v2_CM)));
+    }
 
-  if (fgUsedVars[kCosThetaCS]) {
-    values[kCosThetaCS] = (t1.sign() > 0 ? zaxis_CS.Dot(v1_CM) : zaxis_CS.Dot(v2_CM));
-  }
+    if (fgUsedVars[kCosThetaCS]) {
+      values[kCosThetaCS] = (t1.sign() > 0 ? zaxis_CS.Dot(v1_CM) : zaxis_CS.Dot(v2_CM));
+    }
 
-  if (fgUsedVars[kPhiCS]) {
-    values[kPhiCS] = (t1.sign() > 0 ? TMath::ATan2(yaxis_CS.Dot(v1_CM), xaxis_CS.Dot(v1_CM)) : TMath::ATan2(yaxis_CS.Dot(v2_CM), xaxis_CS.Dot(v2_CM)));
+    if (fgUsedVars[kPhiCS]) {
+      values[kPhiCS] = (t1.sign() > 0 ? TMath::ATan2(yaxis_CS.Dot(v1_CM), xaxis_CS.Dot(v1_CM)) : TMath::ATan2(yaxis_CS.Dot(v2_CM), xaxis_CS.Dot(v2_CM)));
+    }
   }
 
   if constexpr ((pairType == kDecayToEE) && ((fillMap & TrackCov) > 0 || (fillMap & ReducedTrackBarrelCov) > 0)) {
 
-    if (fgUsedVars[kQuadDCAabsXY] || fgUsedVars[kQuadDCAsigXY] || fgUsedVars[kQuadDCAabsZ] || fgUsedVars[kQuadDCAsigZ] || fgUsedVars[kQuadDCAsigXYZ] || fgUsedVars[kSignQuadDCAsigXY]) {
+    if (IsVarGroupUsed(kVarGroupPairQuadDCA)) {
       // Quantities based on the barrel tables
       double dca1XY = t1.dcaXY();
       double dca2XY = t2.dcaXY();
@@ -2236,7 +2266,9 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
   ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
 
   values[kUsedKF] = fgUsedKF;
-  if (!fgUsedKF) {
+  // the secondary vertex is needed to propagate the legs to it, otherwise only if one of its variables is used
+  const bool doVertexing = propToSV || IsVarGroupUsed(kVarGroupPairVertexing);
+  if (doVertexing && !fgUsedKF) {
     int procCode = 0;
 
     // TODO: use trackUtilities functions to initialize the various matrices to avoid code duplication
@@ -2380,7 +2412,7 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
       values[kVertexingTauxyProjectedNs] = values[kVertexingTauxyProjected] / o2::constants::physics::LightSpeedCm2NS;
       values[kVertexingTauzProjected] = values[kVertexingLzProjected] * v12.M() / (v12.P());
     }
-  } else {
+  } else if (doVertexing) {
     KFParticle trk0KF;
     KFParticle trk1KF;
     KFParticle KFGeoTwoProng;
@@ -2580,6 +2612,8 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
   int procCodeJpsi = 0;
 
   values[kUsedKF] = fgUsedKF;
+  // the triplet kinematics are always filled, the secondary vertex only if one of its variables is used
+  const bool doVertexing = IsVarGroupUsed(kVarGroupPairVertexing);
   if (!fgUsedKF) {
     if constexpr ((candidateType == kBcToThreeMuons) && muonHasCov) {
       mlepton = o2::constants::physics::MassMuon;
@@ -2608,8 +2642,10 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
                              track.c1PtX(), track.c1PtY(), track.c1PtPhi(), track.c1PtTgl(), track.c1Pt21Pt2()};
       SMatrix55 t3covs(v3.begin(), v3.end());
       o2::track::TrackParCovFwd pars3{track.z(), t3pars, t3covs, chi23};
-      procCode = VarManager::fgFitterThreeProngFwd.process(pars1, pars2, pars3);
-      procCodeJpsi = VarManager::fgFitterTwoProngFwd.process(pars1, pars2);
+      if (doVertexing) {
+        procCode = VarManager::fgFitterThreeProngFwd.process(pars1, pars2, pars3);
+        procCodeJpsi = VarManager::fgFitterTwoProngFwd.process(pars1, pars2);
+      }
     } else if constexpr ((candidateType == kBtoJpsiEEK) && trackHasCov) {
       mlepton = o2::constants::physics::MassElectron;
       mtrack = o2::constants::physics::MassKaonCharged;
@@ -2628,8 +2664,10 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
                                            track.cSnpSnp(), track.cTglY(), track.cTglZ(), track.cTglSnp(), track.cTglTgl(),
                                            track.c1PtY(), track.c1PtZ(), track.c1PtSnp(), track.c1PtTgl(), track.c1Pt21Pt2()};
       o2::track::TrackParCov pars3{track.x(), track.alpha(), lepton3pars, lepton3covs};
-      procCode = VarManager::fgFitterThreeProngBarrel.process(pars1, pars2, pars3);
-      procCodeJpsi = VarManager::fgFitterTwoProngBarrel.process(pars1, pars2);
+      if (doVertexing) {
+        procCode = VarManager::fgFitterThreeProngBarrel.process(pars1, pars2, pars3);
+        procCodeJpsi = VarManager::fgFitterTwoProngBarrel.process(pars1, pars2);
+      }
     } else {
       return;
     }
@@ -2648,6 +2686,9 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
       values[VarManager::kPairPtDau] = v12.Pt();
     }
     values[VarManager::kPt] = track.pt();
+    if (!doVertexing) {
+      return;
+    }
 
     values[VarManager::kVertexingProcCode] = procCode;
     if (procCode == 0 || procCodeJpsi == 0) {
@@ -2764,6 +2805,9 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
         values[VarManager::kPairMassDau] = KFGeoTwoLeptons.GetMass();
         values[VarManager::kPairPtDau] = KFGeoTwoLeptons.GetPt();
       }
+      if (!doVertexing) {
+        return;
+      }
 
       // Quantities between 3rd prong and candidate
       if (fgUsedVars[kKFDCAxyzBetweenProngs])
@@ -3034,6 +3078,9 @@ void VarManager::FillPairVn(T1 const& t1, T2 const& t2, float* values)
   values[kQ4Y0A] = values[kQ4Y0A] * values[kMultA];
 
   //  kV4, kC4POI, kC4REF etc.
+  if (!IsVarGroupUsed(kVarGroupPairCumulants)) {
+    return;
+  }
   values[kCORR2REF] = (values[kQ2X0A] * values[kQ2X0A] + values[kQ2Y0A] * values[kQ2Y0A] - values[kMultA]) / (values[kMultA] * (values[kMultA] - 1));
   values[kCORR2POI] = (values[kQ2X0A] * std::cos(2 * v12.Phi()) + values[kQ2Y0A] * std::sin(2 * v12.Phi())) / (values[kMultA] * values[kMultDimuons]);
   values[kCORR4REF] = (std::pow((values[kQ2X0A] * values[kQ2X0A] + values[kQ2Y0A] * values[kQ2Y0A]), 2.0) + values[kQ4X0A] * values[kQ4X0A] + values[kQ4Y0A] * values[kQ4Y0A] - 2 * (values[kQ4X0A] * values[kQ2X0A] * values[kQ2X0A] - values[kQ4X0A] * values[kQ2Y0A] * values[kQ2Y0A] + 2 * values[kQ4Y0A] * values[kQ2Y0A] * values[kQ2X0A])) / (values[kMultA] * (values[kMultA] - 1) * (values[kMultA] - 2) * (values[kMultA] - 3)) - 2 * (2 * (values[kMultA] - 2) * (values[kQ2X0A] * values[kQ2X0A] + values[kQ2Y0A] * values[kQ2Y0A]) - values[kMultA] * (values[kMultA] - 3)) / (values[kMultA] * (values[kMultA] - 1) * (values[kMultA] - 2) * (values[kMultA] - 3));
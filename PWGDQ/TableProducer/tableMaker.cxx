@@ -185,6 +185,11 @@ struct TableMaker {
   std::vector<AnalysisCompositeCut> fTrackCuts; //! Barrel track cuts
   std::vector<AnalysisCompositeCut> fMuonCuts;  //! Muon track cuts
 
+  std::vector<int> fUsedVarsList;         //! VarManager used variables, stored in fTrackValues
+  AnalysisCut::ValuesBlock fTrackValues;  //! used variables of the barrel tracks of the current collision, for the batch evaluation of the track cuts
+  std::vector<uint64_t> fTrackFilterMaps; //! track cut decisions for the barrel tracks of the current collision
+  std::vector<uint8_t> fTrackDecisions;   //! scratch decisions of a single cut, reused for all the collisions
+
   Preslice<MyBarrelTracks> perCollisionTracks = aod::track::collisionId;
   Preslice<MyMuons> perCollisionMuons = aod::fwdtrack::collisionId;
   Preslice<aod::TrackAssoc> trackIndicesPerCollision = aod::track_association::collisionId;
@@ -335,6 +340,26 @@ struct TableMaker {
     VarManager::SetUseVars(AnalysisCut::fgUsedVars); // provide the list of required variables so that VarManager knows what to fill
   }
 
+  // Prepare the values block for the batch evaluation of the track cuts on nTracks barrel tracks
+  void InitTrackValues(int nTracks)
+  {
+    if (fUsedVarsList.empty()) { // done at the first collision, when all the tasks of the workflow have set their used variables
+      for (int var = 0; var < VarManager::kNVars; ++var) {
+        if (VarManager::GetUsedVar(var)) {
+          fUsedVarsList.push_back(var);
+        }
+      }
+    }
+    fTrackValues.Init(VarManager::kNVars, fUsedVarsList, nTracks);
+  }
+
+  // Evaluate the track cuts on all the tracks of the values block, bit i of fTrackFilterMaps[j] is set if track j passes fTrackCuts[i]
+  void RunTrackCuts()
+  {
+    fTrackFilterMaps.resize(fTrackValues.GetSize());
+    AnalysisCut::FillSelectionMasks(fTrackCuts, fTrackValues, fTrackFilterMaps.data(), fTrackDecisions);
+  }
+
   // Templated function instantianed for all of the process functions
   template <uint32_t TEventFillMap, uint32_t TTrackFillMap, uint32_t TMuonFillMap, uint32_t TMFTFillMap = 0u, typename TEvent, typename TTracks, typename TMuons, typename TAmbiTracks, typename TAmbiMuons, typename TMFTTracks = std::nullptr_t>
   void fullSkimming(TEvent const& collision, aod::BCsWithTimestamps const&, TTracks const& tracksBarrel, TMuons const& tracksMuon, TAmbiTracks const& ambiTracksMid, TAmbiMuons const& ambiTracksFwd, TMFTTracks const& mftTracks = nullptr)
@@ -452,8 +477,21 @@ struct TableMaker {
       }
       trackBarrelPID.reserve(tracksBarrel.size());
 
+      // compute the track variables and evaluate the track cuts on all the tracks at once
+      InitTrackValues(tracksBarrel.size());
+      for (auto& track : tracksBarrel) {
+        VarManager::FillTrack<TTrackFillMap>(track);
+        fTrackValues.Add(VarManager::fgValues);
+      }
+      RunTrackCuts();
+
       // loop over tracks
+      int iTrack = -1;
       for (auto& track : tracksBarrel) {
+        ++iTrack;
+        if (!fTrackFilterMaps[iTrack] && !fDoDetailedQA) {
+          continue;
+        }
         if constexpr ((TTrackFillMap & VarManager::ObjTypes::AmbiTrack) > 0) {
           if (fIsAmbiguous) {
             isAmbiguous = 0;
@@ -468,7 +506,7 @@ struct TableMaker {
 
         trackFilteringTag = uint64_t(0);
         trackTempFilterMap = uint8_t(0);
-        VarManager::FillTrack<TTrackFillMap>(track);
+        fTrackValues.Get(iTrack, VarManager::fgValues);
         if (fDoDetailedQA) {
           fHistMan->FillHistClass("TrackBarrel_BeforeCuts", VarManager::fgValues);
           if (fIsAmbiguous && isAmbiguous == 1) {
@@ -479,7 +517,7 @@ struct TableMaker {
         // apply track cuts and fill stats histogram
         int i = 0;
         for (auto cut = fTrackCuts.begin(); cut != fTrackCuts.end(); cut++, i++) {
-          if ((*cut).IsSelected(VarManager::fgValues)) {
+          if (fTrackFilterMaps[iTrack] & (uint64_t(1) << i)) {
             trackTempFilterMap |= (uint8_t(1) << i);
             if (fConfigQA) {
               fHistMan->FillHistClass(Form("TrackBarrel_%s", (*cut).GetName()), VarManager::fgValues);
@@ -888,8 +926,21 @@ struct TableMaker {
       }
       trackBarrelPID.reserve(tracksBarrel.size());
 
+      // compute the track variables and evaluate the track cuts on all the tracks at once
+      InitTrackValues(trackIndices.size());
+      for (const auto& trackId : trackIndices) {
+        VarManager::FillTrack<TTrackFillMap>(trackId.template track_as<TTracks>());
+        fTrackValues.Add(VarManager::fgValues);
+      }
+      RunTrackCuts();
+
       // loop over tracks
+      int iTrack = -1;
       for (const auto& trackId : trackIndices) { // start loop over tracks
+        ++iTrack;
+        if (!fTrackFilterMaps[iTrack] && !fDoDetailedQA) {
+          continue;
+        }
         auto track = trackId.template track_as<TTracks>();
         if constexpr ((TTrackFillMap & VarManager::ObjTypes::AmbiTrack) > 0) {
           if (fIsAmbiguous) {
@@ -898,7 +949,7 @@ struct TableMaker {
         }
         trackFilteringTag = uint64_t(0);
         trackTempFilterMap = uint8_t(0);
-        VarManager::FillTrack<TTrackFillMap>(track);
+        fTrackValues.Get(iTrack, VarManager::fgValues);
         if (fDoDetailedQA) {
           fHistMan->FillHistClass("TrackBarrel_BeforeCuts", VarManager::fgValues);
           if (fIsAmbiguous && isAmbiguous == 1) {
@@ -909,7 +960,7 @@ struct TableMaker {
         // apply track cuts and fill stats histogram
         int i = 0;
         for (auto cut = fTrackCuts.begin(); cut != fTrackCuts.end(); cut++, i++) {
-          if ((*cut).IsSelected(VarManager::fgValues)) {
+          if (fTrackFilterMaps[iTrack] & (uint64_t(1) << i)) {
             trackTempFilterMap |= (uint8_t(1) << i);
             if (fConfigQA) {
               fHistMan->FillHistClass(Form("TrackBarrel_%s", (*cut).GetName()), VarManager::fgValues);
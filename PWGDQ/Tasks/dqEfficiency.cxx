@@ -681,6 +681,8 @@ struct AnalysisSameEventPairing {
 
     DefineHistograms(fHistMan, histNames.Data());    // define all histograms
     VarManager::SetUseVars(fHistMan->GetUsedVars()); // provide the list of required variables so that VarManager knows what to fill
+    // the dilepton extra tables are filled directly from the vertexing variables
+    VarManager::SetUseVars(std::vector<int>{VarManager::kVertexingTauz, VarManager::kVertexingLz, VarManager::kVertexingLxy});
     fOutputList.setObject(fHistMan->GetMainHistogramList());
   }
 
@@ -1080,6 +1082,11 @@ struct AnalysisDileptonTrack {
     } else {
       fNHadronCutBit = 0;
     }
+
+    // the candidate table is filled directly from the vertexing variables
+    if (fConfigFillCandidateTable.value) {
+      VarManager::SetUseVars(std::vector<int>{VarManager::kVertexingTauz, VarManager::kVertexingLz, VarManager::kVertexingLxy, VarManager::kVertexingTauxy});
+    }
   }
 
   // Template function to run pair - track combinations
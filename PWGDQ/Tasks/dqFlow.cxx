@@ -137,6 +137,12 @@ struct DQEventQvector {
 
   // Define global variables for generic framework
   GFW* fGFW = new GFW();
+  // Tracks of the current event passed to the GFW in one block: eta, pt bin, phi, weight and mask
+  std::vector<double> fGFWEta;
+  std::vector<int> fGFWPtBin;
+  std::vector<double> fGFWPhi;
+  std::vector<double> fGFWWeight;
+  std::vector<int> fGFWMask;
   std::vector<GFW::CorrConfig> corrconfigs;
   TRandom3* fRndm = new TRandom3(0);
   TAxis* fPtAxis;
@@ -317,7 +323,12 @@ struct DQEventQvector {
     // Acceptance and efficiency weights
     float weff = 1.0, wacc = 1.0;
 
-    // Fill the GFW object in the track loop
+    // Collect the tracks and their weights, the GFW object is filled with all the tracks at once
+    fGFWEta.clear();
+    fGFWPtBin.clear();
+    fGFWPhi.clear();
+    fGFWWeight.clear();
+    fGFWMask.clear();
     for (auto& track : tracks1) {
 
       // Fill weights for Q-vector correction: this should be enabled for a first run to get weights
@@ -339,9 +350,14 @@ struct DQEventQvector {
       } else {
         wacc = 1.0;
       }
-      // Fill the GFW for each track to compute Q vector and correction using weights
-      fGFW->Fill(track.eta(), 0, track.phi(), wacc * weff, 3); // using default values for ptin = 0 and mask = 3
+      // Q vector and correction using weights, with the default values ptin = 0 and mask = 3
+      fGFWEta.push_back(track.eta());
+      fGFWPtBin.push_back(0);
+      fGFWPhi.push_back(track.phi());
+      fGFWWeight.push_back(wacc * weff);
+      fGFWMask.push_back(3);
     }
+    fGFW->Fill(fGFWEta.size(), fGFWEta.data(), fGFWPtBin.data(), fGFWPhi.data(), fGFWWeight.data(), fGFWMask.data());
 
     float l_Random = fRndm->Rndm(); // used only to compute correlators
     bool fillFlag = kFALSE;         // could be used later
@@ -373,9 +389,9 @@ struct DQEventQvector {
 
     if (fGFW && (tracks1.size() > 0)) {
       // Obtain the GFWCumulant where Q is calculated (index=region, with different eta gaps)
-      GFWCumulant gfwCumN = fGFW->GetCumulant(0);
-      GFWCumulant gfwCumP = fGFW->GetCumulant(1);
-      GFWCumulant gfwCumFull = fGFW->GetCumulant(2);
+      const GFWCumulant& gfwCumN = fGFW->GetCumulant(0);
+      const GFWCumulant& gfwCumP = fGFW->GetCumulant(1);
+      const GFWCumulant& gfwCumFull = fGFW->GetCumulant(2);
 
       // and the multiplicity of the event in each region
       nentriesN = gfwCumN.GetN();
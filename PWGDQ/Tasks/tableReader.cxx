@@ -13,6 +13,7 @@
 //
 #include <iostream>
 #include <vector>
+#include <array>
 #include <algorithm>
 #include <TH1F.h>
 #include <TH3F.h>
@@ -29,6 +30,7 @@
 #include "PWGDQ/Core/VarManager.h"
 #include "PWGDQ/Core/HistogramManager.h"
 #include "PWGDQ/Core/MixingHandler.h"
+#include "PWGDQ/Core/MixingPool.h"
 #include "PWGDQ/Core/AnalysisCut.h"
 #include "PWGDQ/Core/AnalysisCompositeCut.h"
 #include "PWGDQ/Core/HistogramsLibrary.h"
@@ -234,6 +236,11 @@ struct AnalysisTrackSelection {
   HistogramManager* fHistMan;
   std::vector<AnalysisCompositeCut> fTrackCuts;
 
+  std::vector<int> fUsedVarsList;         //! VarManager used variables, stored in fTrackValues
+  AnalysisCut::ValuesBlock fTrackValues;  //! used variables of the tracks of the current event, for the batch evaluation of the track cuts
+  std::vector<uint64_t> fTrackFilterMaps; //! track cut decisions for the tracks of the current event
+  std::vector<uint8_t> fTrackDecisions;   //! scratch decisions of a single cut, reused for all the events
+
   int fCurrentRun; // needed to detect if the run changed and trigger update of calibrations etc.
 
   void init(o2::framework::InitContext&)
@@ -304,21 +311,37 @@ struct AnalysisTrackSelection {
       fCurrentRun = event.runNumber();
     }
 
+    // compute the track variables and evaluate the track cuts on all the tracks at once
+    if (fUsedVarsList.empty()) { // done at the first event, when all the tasks of the workflow have set their used variables
+      for (int var = 0; var < VarManager::kNVars; ++var) {
+        if (VarManager::GetUsedVar(var)) {
+          fUsedVarsList.push_back(var);
+        }
+      }
+    }
+    fTrackValues.Init(VarManager::kNVars, fUsedVarsList, tracks.size());
+    for (auto& track : tracks) {
+      VarManager::FillTrack<TTrackFillMap>(track);
+      fTrackValues.Add(VarManager::fgValues);
+    }
+    fTrackFilterMaps.resize(fTrackValues.GetSize());
+    AnalysisCut::FillSelectionMasks(fTrackCuts, fTrackValues, fTrackFilterMaps.data(), fTrackDecisions);
+
     trackSel.reserve(tracks.size());
     uint32_t filterMap = 0;
     bool prefilterSelected = false;
     int iCut = 0;
 
-    for (auto& track : tracks) {
+    for (int iTrack = 0; iTrack < fTrackValues.GetSize(); ++iTrack) {
       filterMap = 0;
       prefilterSelected = false;
-      VarManager::FillTrack<TTrackFillMap>(track);
       if (fConfigQA) { // TODO: make this compile time
+        fTrackValues.Get(iTrack, VarManager::fgValues);
         fHistMan->FillHistClass("TrackBarrel_BeforeCuts", VarManager::fgValues);
       }
       iCut = 0;
       for (auto cut = fTrackCuts.begin(); cut != fTrackCuts.end(); cut++, iCut++) {
-        if ((*cut).IsSelected(VarManager::fgValues)) {
+        if (fTrackFilterMaps[iTrack] & (uint64_t(1) << iCut)) {
           if (iCut != fConfigPrefilterCutId) {
             filterMap |= (uint32_t(1) << iCut);
           }
@@ -519,6 +542,7 @@ struct AnalysisEventMixing {
   Configurable<string> fConfigTrackCuts{"cfgTrackCuts", "", "Comma separated list of barrel track cuts"};
   Configurable<string> fConfigMuonCuts{"cfgMuonCuts", "", "Comma separated list of muon cuts"};
   Configurable<int> fConfigMixingDepth{"cfgMixingDepth", 100, "Number of Events stored for event mixing"};
+  Configurable<int> fConfigMixingPoolMaxTracks{"cfgMixingPoolMaxTracks", 0, "Streaming mixing: maximum number of tracks kept per pooled event, as a uniform random subsample (0 = no limit)"};
   Configurable<std::string> fConfigAddEventMixingHistogram{"cfgAddEventMixingHistogram", "", "Comma separated list of histograms"};
 
   Filter filterEventSelected = aod::dqanalysisflags::isEventSelected == 1;
@@ -535,8 +559,15 @@ struct AnalysisEventMixing {
 
   NoBinningPolicy<aod::dqanalysisflags::MixingHash> hashBin;
 
+  // Streaming mixing: the last events of each mixing category, kept across data frames, separately for barrel tracks and muons
+  MixingPool<MixingEventRecord, MixingTrackRecord> fMixingPoolEE;
+  MixingPool<MixingEventRecord, MixingTrackRecord> fMixingPoolMuMu;
+  std::vector<MixingTrackRecord> fCurrentEventTracks;
+
   void init(o2::framework::InitContext& context)
   {
+    fMixingPoolEE.Init(fConfigMixingDepth.value, fConfigMixingPoolMaxTracks.value);
+    fMixingPoolMuMu.Init(fConfigMixingDepth.value, fConfigMixingPoolMaxTracks.value);
     VarManager::SetDefaultVarNames();
     fHistMan = new HistogramManager("analysisHistos", "aa", VarManager::kNVars);
     fHistMan->SetUseDefaultVariableNames(kTRUE);
@@ -544,7 +575,7 @@ struct AnalysisEventMixing {
 
     // Keep track of all the histogram class names to avoid composing strings in the event mixing pairing
     TString histNames = "";
-    if (context.mOptions.get<bool>("processBarrelSkimmed") || context.mOptions.get<bool>("processBarrelVnSkimmed")) {
+    if (context.mOptions.get<bool>("processBarrelSkimmed") || context.mOptions.get<bool>("processBarrelVnSkimmed") || context.mOptions.get<bool>("processBarrelSkimmedStreaming")) {
       TString cutNames = fConfigTrackCuts.value;
       if (!cutNames.IsNull()) {
         std::unique_ptr<TObjArray> objArray(cutNames.Tokenize(","));
@@ -559,7 +590,7 @@ struct AnalysisEventMixing {
         }
       }
     }
-    if (context.mOptions.get<bool>("processMuonSkimmed") || context.mOptions.get<bool>("processMuonVnSkimmed")) {
+    if (context.mOptions.get<bool>("processMuonSkimmed") || context.mOptions.get<bool>("processMuonVnSkimmed") || context.mOptions.get<bool>("processMuonSkimmedStreaming")) {
       TString cutNames = fConfigMuonCuts.value;
       if (!cutNames.IsNull()) {
         std::unique_ptr<TObjArray> objArray(cutNames.Tokenize(","));
@@ -604,15 +635,20 @@ struct AnalysisEventMixing {
   void runMixedPairing(TTracks1 const& tracks1, TTracks2 const& tracks2)
   {
 
-    unsigned int ncuts = fTrackHistNames.size();
-    std::vector<std::vector<TString>> histNames = fTrackHistNames;
+    const std::vector<std::vector<TString>>* histNames = &fTrackHistNames;
     if constexpr (TPairType == pairTypeMuMu) {
-      ncuts = fMuonHistNames.size();
-      histNames = fMuonHistNames;
+      histNames = &fMuonHistNames;
     }
     if constexpr (TPairType == pairTypeEMu) {
-      ncuts = fTrackMuonHistNames.size();
-      histNames = fTrackMuonHistNames;
+      histNames = &fTrackMuonHistNames;
+    }
+    unsigned int ncuts = histNames->size();
+    // resolve the histogram classes once, such that the pair loop fills through the precompiled plans
+    std::vector<std::array<int, 3>> histHandles(ncuts);
+    for (unsigned int icut = 0; icut < ncuts; icut++) {
+      for (int i = 0; i < 3; i++) {
+        histHandles[icut][i] = fHistMan->GetHistClassHandle((*histNames)[icut][i].Data());
+      }
     }
 
     uint32_t twoTrackFilter = 0;
@@ -641,12 +677,12 @@ struct AnalysisEventMixing {
         for (unsigned int icut = 0; icut < ncuts; icut++) {
           if (twoTrackFilter & (uint32_t(1) << icut)) {
             if (track1.sign() * track2.sign() < 0) {
-              fHistMan->FillHistClass(histNames[icut][0].Data(), VarManager::fgValues);
+              fHistMan->FillHistClass(histHandles[icut][0], VarManager::fgValues);
             } else {
               if (track1.sign() > 0) {
-                fHistMan->FillHistClass(histNames[icut][1].Data(), VarManager::fgValues);
+                fHistMan->FillHistClass(histHandles[icut][1], VarManager::fgValues);
               } else {
-                fHistMan->FillHistClass(histNames[icut][2].Data(), VarManager::fgValues);
+                fHistMan->FillHistClass(histHandles[icut][2], VarManager::fgValues);
               }
             }
           } // end if (filter bits)
@@ -676,6 +712,54 @@ struct AnalysisEventMixing {
     } // end event loop
   }
 
+  // barrel-barrel and muon-muon event mixing in streaming mode
+  // Each event is mixed with the events of its category kept in the mixing pools, then added to the pool.
+  // This needs a single pass over the events and the memory is bounded by the pool depth.
+  // NOTE: the event-wise variables are those of the current event, which shares the mixing category with the pooled events
+  template <int TPairType, uint32_t TEventFillMap, typename TEvents, typename TTracks>
+  void runSameSideStreaming(MixingPool<MixingEventRecord, MixingTrackRecord>& pool, TEvents const& events, TTracks const& tracks, Preslice<TTracks>& preSlice)
+  {
+    for (auto& event : events) {
+      const int category = event.mixingHash();
+      if (category < 0) {
+        continue;
+      }
+
+      fCurrentEventTracks.clear();
+      auto eventTracks = tracks.sliceBy(preSlice, event.globalIndex());
+      for (auto& track : eventTracks) {
+        MixingTrackRecord record;
+        record.fPt = track.pt();
+        record.fEta = track.eta();
+        record.fPhi = track.phi();
+        record.fSign = track.sign();
+        if constexpr (TPairType == VarManager::kDecayToMuMu) {
+          record.fFilterMap = uint32_t(track.isMuonSelected());
+        } else {
+          record.fFilterMap = uint32_t(track.isBarrelSelected());
+        }
+        fCurrentEventTracks.push_back(record);
+      }
+      MixingEventRecord eventRecord;
+      eventRecord.fPosX = event.posX();
+      eventRecord.fPosY = event.posY();
+      eventRecord.fPosZ = event.posZ();
+      eventRecord.fNumContrib = event.numContrib();
+
+      VarManager::ResetValues(0, VarManager::kNVars);
+      VarManager::FillEvent<TEventFillMap>(event, VarManager::fgValues);
+      pool.ForEachEvent(category, [&](const MixingEventRecord& pooledEvent, const std::vector<MixingTrackRecord>& pooledTracks) {
+        VarManager::FillTwoMixEvents<TEventFillMap>(pooledEvent, eventRecord, pooledTracks, fCurrentEventTracks);
+        runMixedPairing<TPairType>(pooledTracks, fCurrentEventTracks);
+      });
+
+      pool.StartEvent(category, eventRecord);
+      for (const auto& record : fCurrentEventTracks) {
+        pool.AddRecord(record);
+      }
+    } // end event loop
+  }
+
   // barrel-muon event mixing
   template <uint32_t TEventFillMap, typename TEvents, typename TTracks, typename TMuons>
   void runBarrelMuon(TEvents& events, TTracks const& tracks, TMuons const& muons)
@@ -707,6 +791,14 @@ struct AnalysisEventMixing {
   {
     runSameSide<pairTypeMuMu, gkEventFillMap>(events, muons, perEventsSelectedM);
   }
+  void processBarrelSkimmedStreaming(soa::Filtered<MyEventsHashSelected> const& events, soa::Filtered<MyBarrelTracksSelected> const& tracks)
+  {
+    runSameSideStreaming<pairTypeEE, gkEventFillMap>(fMixingPoolEE, events, tracks, perEventsSelectedT);
+  }
+  void processMuonSkimmedStreaming(soa::Filtered<MyEventsHashSelected> const& events, soa::Filtered<MyMuonTracksSelected> const& muons)
+  {
+    runSameSideStreaming<pairTypeMuMu, gkEventFillMap>(fMixingPoolMuMu, events, muons, perEventsSelectedM);
+  }
   void processBarrelMuonSkimmed(soa::Filtered<MyEventsHashSelected>& events, soa::Filtered<MyBarrelTracksSelected> const& tracks, soa::Filtered<MyMuonTracksSelected> const& muons)
   {
     runBarrelMuon<gkEventFillMap>(events, tracks, muons);
@@ -728,6 +820,8 @@ struct AnalysisEventMixing {
 
   PROCESS_SWITCH(AnalysisEventMixing, processBarrelSkimmed, "Run barrel-barrel mixing on skimmed tracks", false);
   PROCESS_SWITCH(AnalysisEventMixing, processMuonSkimmed, "Run muon-muon mixing on skimmed muons", false);
+  PROCESS_SWITCH(AnalysisEventMixing, processBarrelSkimmedStreaming, "Run barrel-barrel mixing on skimmed tracks using the streaming mixing pools", false);
+  PROCESS_SWITCH(AnalysisEventMixing, processMuonSkimmedStreaming, "Run muon-muon mixing on skimmed muons using the streaming mixing pools", false);
   PROCESS_SWITCH(AnalysisEventMixing, processBarrelMuonSkimmed, "Run barrel-muon mixing on skimmed tracks/muons", false);
   PROCESS_SWITCH(AnalysisEventMixing, processBarrelVnSkimmed, "Run barrel-barrel vn mixing on skimmed tracks", false);
   PROCESS_SWITCH(AnalysisEventMixing, processMuonVnSkimmed, "Run muon-muon vn mixing on skimmed tracks", false);
@@ -931,6 +1025,11 @@ struct AnalysisSameEventPairing {
 
     DefineHistograms(fHistMan, histNames.Data(), fConfigAddSEPHistogram); // define all histograms
     VarManager::SetUseVars(fHistMan->GetUsedVars());                      // provide the list of required variables so that VarManager knows what to fill
+    // the dilepton extra tables are filled directly from the vertexing variables, and the flat tables also from the cumulants
+    VarManager::SetUseVars(std::vector<int>{VarManager::kVertexingTauz, VarManager::kVertexingLz, VarManager::kVertexingLxy});
+    if (fConfigFlatTables.value) {
+      VarManager::SetUseVars(std::vector<int>{VarManager::kCORR2REF, VarManager::kCORR2POI, VarManager::kCORR4REF, VarManager::kCORR4POI, VarManager::kC4REF, VarManager::kC4POI, VarManager::kV4});
+    }
     fOutputList.setObject(fHistMan->GetMainHistogramList());
   }
 
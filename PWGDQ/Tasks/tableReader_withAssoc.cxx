@@ -1028,6 +1028,11 @@ struct AnalysisSameEventPairing {
 
     DefineHistograms(fHistMan, histNames.Data(), fConfigAddSEPHistogram.value.data()); // define all histograms
     VarManager::SetUseVars(fHistMan->GetUsedVars());                                   // provide the list of required variables so that VarManager knows what to fill
+    // the dilepton extra tables are filled directly from the vertexing variables, and the flat tables also from the cumulants
+    VarManager::SetUseVars(std::vector<int>{VarManager::kVertexingTauz, VarManager::kVertexingLz, VarManager::kVertexingLxy});
+    if (fConfigFlatTables.value) {
+      VarManager::SetUseVars(std::vector<int>{VarManager::kCORR2REF, VarManager::kCORR2POI, VarManager::kCORR4REF, VarManager::kCORR4POI, VarManager::kC4REF, VarManager::kC4POI, VarManager::kV4});
+    }
     fOutputList.setObject(fHistMan->GetMainHistogramList());
   }
 
@@ -1536,6 +1541,8 @@ struct AnalysisDileptonTrack {
     }
 
     VarManager::SetUseVars(fHistMan->GetUsedVars());
+    // the B meson table is filled directly from the vertexing variables
+    VarManager::SetUseVars(std::vector<int>{VarManager::kVertexingLxy, VarManager::kVertexingLxyz, VarManager::kVertexingLz, VarManager::kVertexingTauxy, VarManager::kVertexingTauz, VarManager::kCosPointingAngle, VarManager::kVertexingChi2PCA});
     fOutputList.setObject(fHistMan->GetMainHistogramList());
   }
 
@@ -249,32 +249,39 @@ struct HfCandidateSelectorD0 {
 
     return true;
   }
+  /// Selection status of a candidate, stored between the selection pass and the batched ML inference
+  struct CandidateStatus {
+    int statusD0 = 0;
+    int statusD0bar = 0;
+    int statusHFFlag = 0;
+    int statusTopol = 0;
+    int statusCand = 0;
+    int statusPID = 0;
+    int mlIndexD0 = -1;    // index of the D0 hypothesis in the ML batch (-1 if not evaluated)
+    int mlIndexD0bar = -1; // index of the D0bar hypothesis in the ML batch (-1 if not evaluated)
+  };
+  std::vector<CandidateStatus> candidateStatuses;
+
   template <int reconstructionType, typename CandType>
   void processSel(CandType const& candidates,
                   TracksSel const&)
   {
+    candidateStatuses.clear();
+    candidateStatuses.reserve(candidates.size());
+    if (applyMl) {
+      hfMlResponse.clearBatch();
+    }
+
     // looping over 2-prong candidates
     for (const auto& candidate : candidates) {
 
       // final selection flag: 0 - rejected, 1 - accepted
-      int statusD0 = 0;
-      int statusD0bar = 0;
-      int statusHFFlag = 0;
-      int statusTopol = 0;
-      int statusCand = 0;
-      int statusPID = 0;
-
-      outputMlD0.clear();
-      outputMlD0bar.clear();
+      auto& status = candidateStatuses.emplace_back();
 
       if (!(candidate.hfflag() & 1 << aod::hf_cand_2prong::DecayType::D0ToPiK)) {
-        hfSelD0Candidate(statusD0, statusD0bar, statusHFFlag, statusTopol, statusCand, statusPID);
-        if (applyMl) {
-          hfMlD0Candidate(outputMlD0, outputMlD0bar);
-        }
         continue;
       }
-      statusHFFlag = 1;
+      status.statusHFFlag = 1;
 
       auto ptCand = candidate.pt();
       auto trackPos = candidate.template prong0_as<TracksSel>(); // positive daughter
@@ -282,13 +289,9 @@ struct HfCandidateSelectorD0 {
 
       // conjugate-independent topological selection
       if (!selectionTopol<reconstructionType>(candidate)) {
-        hfSelD0Candidate(statusD0, statusD0bar, statusHFFlag, statusTopol, statusCand, statusPID);
-        if (applyMl) {
-          hfMlD0Candidate(outputMlD0, outputMlD0bar);
-        }
         continue;
       }
-      statusTopol = 1;
+      status.statusTopol = 1;
 
       // implement filter bit 4 cut - should be done before this task at the track selection level
       // need to add special cuts (additional cuts on decay length and d0 norm)
@@ -299,13 +302,9 @@ struct HfCandidateSelectorD0 {
       bool topolD0bar = selectionTopolConjugate<reconstructionType>(candidate, trackNeg, trackPos);
 
       if (!topolD0 && !topolD0bar) {
-        hfSelD0Candidate(statusD0, statusD0bar, statusHFFlag, statusTopol, statusCand, statusPID);
-        if (applyMl) {
-          hfMlD0Candidate(outputMlD0, outputMlD0bar);
-        }
         continue;
       }
-      statusCand = 1;
+      status.statusCand = 1;
 
       // track-level PID selection
       int pidTrackPosKaon = -1;
@@ -347,60 +346,81 @@ struct HfCandidateSelectorD0 {
       }
 
       if (pidD0 == 0 && pidD0bar == 0) {
-        hfSelD0Candidate(statusD0, statusD0bar, statusHFFlag, statusTopol, statusCand, statusPID);
-        if (applyMl) {
-          hfMlD0Candidate(outputMlD0, outputMlD0bar);
-        }
         continue;
       }
 
       if ((pidD0 == -1 || pidD0 == 1) && topolD0) {
-        statusD0 = 1; // identified as D0
+        status.statusD0 = 1; // identified as D0
       }
       if ((pidD0bar == -1 || pidD0bar == 1) && topolD0bar) {
-        statusD0bar = 1; // identified as D0bar
+        status.statusD0bar = 1; // identified as D0bar
       }
-      statusPID = 1;
+      status.statusPID = 1;
 
       if (applyMl) {
-        // ML selections
+        // collect the ML inputs, the models are evaluated once per pT bin after the loop
+        if (status.statusD0 > 0) {
+          std::vector<float> inputFeaturesD0 = hfMlResponse.getInputFeatures(candidate, trackPos, trackNeg, o2::constants::physics::kD0);
+          status.mlIndexD0 = hfMlResponse.addToBatch(inputFeaturesD0, ptCand);
+        }
+        if (status.statusD0bar > 0) {
+          std::vector<float> inputFeaturesD0bar = hfMlResponse.getInputFeatures(candidate, trackPos, trackNeg, o2::constants::physics::kD0Bar);
+          status.mlIndexD0bar = hfMlResponse.addToBatch(inputFeaturesD0bar, ptCand);
+        }
+      }
+    }
+
+    if (!applyMl) {
+      for (const auto& status : candidateStatuses) {
+        hfSelD0Candidate(status.statusD0, status.statusD0bar, status.statusHFFlag, status.statusTopol, status.statusCand, status.statusPID);
+      }
+      return;
+    }
+
+    // ML selections
+    hfMlResponse.evalBatch();
+
+    auto status = candidateStatuses.begin();
+    for (const auto& candidate : candidates) {
+      outputMlD0.clear();
+      outputMlD0bar.clear();
+
+      if (status->statusPID > 0) {
         bool isSelectedMlD0 = false;
         bool isSelectedMlD0bar = false;
 
-        if (statusD0 > 0) {
-          std::vector<float> inputFeaturesD0 = hfMlResponse.getInputFeatures(candidate, trackPos, trackNeg, o2::constants::physics::kD0);
-          isSelectedMlD0 = hfMlResponse.isSelectedMl(inputFeaturesD0, ptCand, outputMlD0);
+        if (status->mlIndexD0 >= 0) {
+          isSelectedMlD0 = hfMlResponse.isSelectedMlBatch(status->mlIndexD0, outputMlD0);
         }
-        if (statusD0bar > 0) {
-          std::vector<float> inputFeaturesD0bar = hfMlResponse.getInputFeatures(candidate, trackPos, trackNeg, o2::constants::physics::kD0Bar);
-          isSelectedMlD0bar = hfMlResponse.isSelectedMl(inputFeaturesD0bar, ptCand, outputMlD0bar);
+        if (status->mlIndexD0bar >= 0) {
+          isSelectedMlD0bar = hfMlResponse.isSelectedMlBatch(status->mlIndexD0bar, outputMlD0bar);
         }
 
         if (!isSelectedMlD0) {
-          statusD0 = 0;
+          status->statusD0 = 0;
         }
         if (!isSelectedMlD0bar) {
-          statusD0bar = 0;
+          status->statusD0bar = 0;
         }
 
-        hfMlD0Candidate(outputMlD0, outputMlD0bar);
-
         if (enableDebugMl) {
           if (isSelectedMlD0) {
-            registry.fill(HIST("DebugBdt/hBdtScore1VsStatus"), outputMlD0[0], statusD0);
-            registry.fill(HIST("DebugBdt/hBdtScore2VsStatus"), outputMlD0[1], statusD0);
-            registry.fill(HIST("DebugBdt/hBdtScore3VsStatus"), outputMlD0[2], statusD0);
+            registry.fill(HIST("DebugBdt/hBdtScore1VsStatus"), outputMlD0[0], status->statusD0);
+            registry.fill(HIST("DebugBdt/hBdtScore2VsStatus"), outputMlD0[1], status->statusD0);
+            registry.fill(HIST("DebugBdt/hBdtScore3VsStatus"), outputMlD0[2], status->statusD0);
             registry.fill(HIST("DebugBdt/hMassDmesonSel"), hfHelper.invMassD0ToPiK(candidate));
           }
           if (isSelectedMlD0bar) {
-            registry.fill(HIST("DebugBdt/hBdtScore1VsStatus"), outputMlD0bar[0], statusD0bar);
-            registry.fill(HIST("DebugBdt/hBdtScore2VsStatus"), outputMlD0bar[1], statusD0bar);
-            registry.fill(HIST("DebugBdt/hBdtScore3VsStatus"), outputMlD0bar[2], statusD0bar);
+            registry.fill(HIST("DebugBdt/hBdtScore1VsStatus"), outputMlD0bar[0], status->statusD0bar);
+            registry.fill(HIST("DebugBdt/hBdtScore2VsStatus"), outputMlD0bar[1], status->statusD0bar);
+            registry.fill(HIST("DebugBdt/hBdtScore3VsStatus"), outputMlD0bar[2], status->statusD0bar);
             registry.fill(HIST("DebugBdt/hMassDmesonSel"), hfHelper.invMassD0barToKPi(candidate));
           }
         }
       }
-      hfSelD0Candidate(statusD0, statusD0bar, statusHFFlag, statusTopol, statusCand, statusPID);
+      hfSelD0Candidate(status->statusD0, status->statusD0bar, status->statusHFFlag, status->statusTopol, status->statusCand, status->statusPID);
+      hfMlD0Candidate(outputMlD0, outputMlD0bar);
+      ++status;
     }
   }
 
@@ -60,3 +60,36 @@ fastjet::ClusterSequenceArea JetFinder::findJets(std::vector<fastjet::PseudoJet>
   }
   return clusterSeq;
 }
+
+/// Prepares one set of ghosts for the jet areas, to be shared by the jet finding of all the radii of an event
+void JetFinder::prepareGhosts()
+{
+  ghostAreaSpec = fastjet::GhostedAreaSpec(ghostEtaMax, ghostRepeatN, ghostArea, gridScatter, ktScatter, ghostktMean);
+  ghosts.clear();
+  ghostAreaSpec.add_ghosts(ghosts);
+  ghostAreaActual = ghostAreaSpec.actual_ghost_area();
+}
+
+/// Performs jet finding for the current jetR, reusing the ghosts of prepareGhosts for the jet areas
+/// \param inputParticles vector of input particles/tracks
+/// \param jets vector of jets to be filled
+/// \param doAreas whether the jet areas are calculated
+/// \return cluster sequence needed to access constituents, owned by the JetFinder until the next call
+const fastjet::ClusterSequence& JetFinder::findJetsPrepared(std::vector<fastjet::PseudoJet>& inputParticles, std::vector<fastjet::PseudoJet>& jets, bool doAreas)
+{
+  setParams();
+  jets.clear();
+  if (doAreas) {
+    clusterSeqPrepared = std::make_shared<fastjet::ClusterSequenceActiveAreaExplicitGhosts>(inputParticles, jetDef, ghosts, ghostAreaActual);
+    jets = (!fastjet::SelectorIsPureGhost())(clusterSeqPrepared->inclusive_jets());
+  } else {
+    clusterSeqPrepared = std::make_shared<fastjet::ClusterSequence>(inputParticles, jetDef);
+    jets = clusterSeqPrepared->inclusive_jets();
+  }
+  jets = selJets(jets);
+  jets = fastjet::sorted_by_pt(jets);
+  if (isReclustering) {
+    jetR = jetR / 5.0;
+  }
+  return *clusterSeqPrepared;
+}
@@ -27,6 +27,7 @@
 
 #include "fastjet/PseudoJet.hh"
 #include "fastjet/ClusterSequenceArea.hh"
+#include "fastjet/ClusterSequenceActiveAreaExplicitGhosts.hh"
 #include "fastjet/AreaDefinition.hh"
 #include "fastjet/JetDefinition.hh"
 #include "fastjet/tools/Subtractor.hh"
@@ -93,7 +94,34 @@ class JetFinder
   /// \return ClusterSequenceArea object needed to access constituents
   fastjet::ClusterSequenceArea findJets(std::vector<fastjet::PseudoJet>& inputParticles, std::vector<fastjet::PseudoJet>& jets); // ideally find a way of passing the cluster sequence as a reeference
 
+  /// Prepares one set of ghosts for the jet areas, to be shared by the jet finding of all the radii of an event with findJetsPrepared
+  void prepareGhosts();
+
+  /// Moves the prepared ghosts in or out of the JetFinder, e.g. to generate them in one thread and use them in the JetFinder of another one
+  void takeGhosts(std::vector<fastjet::PseudoJet>& ghostsOut, double& ghostAreaOut)
+  {
+    ghostsOut.swap(ghosts);
+    ghostAreaOut = ghostAreaActual;
+  }
+  void setGhosts(std::vector<fastjet::PseudoJet>& ghostsIn, double ghostAreaIn)
+  {
+    ghosts.swap(ghostsIn);
+    ghostAreaActual = ghostAreaIn;
+  }
+
+  /// Performs jet finding for the current jetR, reusing the ghosts of prepareGhosts for the jet areas
+  /// \note the input particles are not copied to a new list of particles and ghosts
+  /// \param inputParticles vector of input particles/tracks
+  /// \param jets vector of jets to be filled, without pure ghost jets
+  /// \param doAreas whether the jet areas are calculated. If not, the jets are found without ghosts and have no area
+  /// \return cluster sequence needed to access constituents, owned by the JetFinder until the next call
+  const fastjet::ClusterSequence& findJetsPrepared(std::vector<fastjet::PseudoJet>& inputParticles, std::vector<fastjet::PseudoJet>& jets, bool doAreas = true);
+
  private:
+  std::vector<fastjet::PseudoJet> ghosts;                        //! ghosts shared by the jet finding of all the radii
+  double ghostAreaActual = 0.;                                   //! actual area of each ghost
+  std::shared_ptr<fastjet::ClusterSequence> clusterSeqPrepared; //! cluster sequence of the last findJetsPrepared call
+
   ClassDefNV(JetFinder, 1);
 };
 
@@ -17,7 +17,11 @@
 #ifndef PWGJE_CORE_JETFINDINGUTILITIES_H_
 #define PWGJE_CORE_JETFINDINGUTILITIES_H_
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <exception>
+#include <thread>
 #include <vector>
 #include <string>
 #include <optional>
@@ -138,31 +142,87 @@ bool analyseCandidateMC(std::vector<fastjet::PseudoJet>& inputParticles, T const
 }
 
 /**
- * Performs jet finding and fills jet tables
+ * Jets found in one collision, with their constituents, before being filled in the jet tables
+ */
+struct FoundJets {
+  std::vector<float> pt;
+  std::vector<float> eta;
+  std::vector<float> phi;
+  std::vector<float> energy;
+  std::vector<float> mass;
+  std::vector<float> area;
+  std::vector<int> r;
+  // constituent indices of jet i are in [offsets[i], offsets[i + 1]) of the corresponding constituent vector
+  std::vector<int> trackOffsets{0};
+  std::vector<int> clusterOffsets{0};
+  std::vector<int> candOffsets{0};
+  std::vector<int> tracks;
+  std::vector<int> clusters;
+  std::vector<int> cands;
+
+  std::size_t size() const { return pt.size(); }
+  void clear()
+  {
+    for (auto* column : {&pt, &eta, &phi, &energy, &mass, &area}) {
+      column->clear();
+    }
+    r.clear();
+    for (auto* constituents : {&trackOffsets, &clusterOffsets, &candOffsets}) {
+      constituents->assign(1, 0);
+    }
+    for (auto* constituents : {&tracks, &clusters, &cands}) {
+      constituents->clear();
+    }
+  }
+};
+
+/**
+ * Performs jet finding for one collision and stores the jets in a FoundJets buffer
+ *
+ * The input particles are prepared once for all the radii: the constituent status and index are decoded from the
+ * user info into flat arrays and, with one ghost repetition, one set of ghosts is shared by the jet finding of all
+ * the radii. Without ghost repetitions and jet area cut, the jets are found without ghosts and have no area.
+ * Other ghost repetitions use a new area cluster sequence for each radius.
  *
  * @param jetFinder JetFinder object which carries jet finding parameters
  * @param inputParticles fastjet container
  * @param jetRadius jet finding radii
- * @param collision the collision within which jets are being found
- * @param jetsTable output table of jets
- * @param constituentsTable output table of jet constituents
+ * @param foundJets output buffer of jets and constituents
  * @param doHFJetFinding set whether only jets containing a HF candidate are saved
+ * @param ghostsPrepared set whether the shared ghosts were already given to the jetFinder
  */
-template <typename T, typename U, typename V>
-void findJets(JetFinder& jetFinder, std::vector<fastjet::PseudoJet>& inputParticles, float jetPtMin, float jetPtMax, std::vector<double> jetRadius, float jetAreaFractionMin, T const& collision, U& jetsTable, V& constituentsTable, bool doHFJetFinding = false)
+inline void clusterJets(JetFinder& jetFinder, std::vector<fastjet::PseudoJet>& inputParticles, float jetPtMin, float jetPtMax, std::vector<double> const& jetRadius, float jetAreaFractionMin, FoundJets& foundJets, bool doHFJetFinding = false, bool ghostsPrepared = false)
 {
-  auto jetRValues = static_cast<std::vector<double>>(jetRadius);
+  foundJets.clear();
   jetFinder.jetPtMin = jetPtMin;
   jetFinder.jetPtMax = jetPtMax;
-  for (auto R : jetRValues) {
-    jetFinder.jetR = R;
-    std::vector<fastjet::PseudoJet> jets;
-    fastjet::ClusterSequenceArea clusterSeq(jetFinder.findJets(inputParticles, jets));
+
+  // constituent status and index per input particle, indexed by the cluster history index of the constituents
+  const std::size_t nInputParticles = inputParticles.size();
+  std::vector<int> constituentStatus(nInputParticles);
+  std::vector<int> constituentIndex(nInputParticles);
+  for (std::size_t iParticle = 0; iParticle < nInputParticles; iParticle++) {
+    const auto& userInfo = inputParticles[iParticle].template user_info<fastjetutilities::fastjet_user_info>();
+    constituentStatus[iParticle] = userInfo.getStatus();
+    constituentIndex[iParticle] = userInfo.getIndex();
+  }
+
+  const bool useAreaCut = jetAreaFractionMin > 0.;
+  const bool shareGhosts = jetFinder.ghostRepeatN == 1;
+  const bool noAreas = jetFinder.ghostRepeatN == 0 && !useAreaCut;
+  if (shareGhosts && !ghostsPrepared) {
+    jetFinder.prepareGhosts();
+  }
+
+  std::vector<fastjet::PseudoJet> jets;
+  auto storeJets = [&](double R) {
     for (const auto& jet : jets) {
-      bool isHFJet = false;
+      auto constituents = sorted_by_pt(jet.constituents());
       if (doHFJetFinding) {
-        for (const auto& constituent : jet.constituents()) {
-          if (constituent.template user_info<fastjetutilities::fastjet_user_info>().getStatus() == static_cast<int>(JetConstituentStatus::candidateHF)) {
+        bool isHFJet = false;
+        for (const auto& constituent : constituents) {
+          const auto iParticle = static_cast<std::size_t>(constituent.cluster_hist_index());
+          if (iParticle < nInputParticles && constituentStatus[iParticle] == static_cast<int>(JetConstituentStatus::candidateHF)) {
             isHFJet = true;
             break;
           }
@@ -174,24 +234,208 @@ void findJets(JetFinder& jetFinder, std::vector<fastjet::PseudoJet>& inputPartic
       if (jet.has_area() && jet.area() < jetAreaFractionMin * M_PI * R * R) {
         continue;
       }
-      std::vector<int> trackconst;
-      std::vector<int> candconst;
-      std::vector<int> clusterconst;
-      jetsTable(collision.globalIndex(), jet.pt(), jet.eta(), jet.phi(),
-                jet.E(), jet.m(), jet.has_area() ? jet.area() : 0., std::round(R * 100));
-      for (const auto& constituent : sorted_by_pt(jet.constituents())) {
-        if (constituent.template user_info<fastjetutilities::fastjet_user_info>().getStatus() == static_cast<int>(JetConstituentStatus::track)) {
-          trackconst.push_back(constituent.template user_info<fastjetutilities::fastjet_user_info>().getIndex());
+      foundJets.pt.push_back(jet.pt());
+      foundJets.eta.push_back(jet.eta());
+      foundJets.phi.push_back(jet.phi());
+      foundJets.energy.push_back(jet.E());
+      foundJets.mass.push_back(jet.m());
+      foundJets.area.push_back(jet.has_area() ? jet.area() : 0.);
+      foundJets.r.push_back(static_cast<int>(std::round(R * 100)));
+      for (const auto& constituent : constituents) {
+        const auto iParticle = static_cast<std::size_t>(constituent.cluster_hist_index());
+        if (iParticle >= nInputParticles) { // ghost
+          continue;
         }
-        if (constituent.template user_info<fastjetutilities::fastjet_user_info>().getStatus() == static_cast<int>(JetConstituentStatus::cluster)) {
-          clusterconst.push_back(constituent.template user_info<fastjetutilities::fastjet_user_info>().getIndex());
+        if (constituentStatus[iParticle] == static_cast<int>(JetConstituentStatus::track)) {
+          foundJets.tracks.push_back(constituentIndex[iParticle]);
+        } else if (constituentStatus[iParticle] == static_cast<int>(JetConstituentStatus::cluster)) {
+          foundJets.clusters.push_back(constituentIndex[iParticle]);
+        } else if (constituentStatus[iParticle] == static_cast<int>(JetConstituentStatus::candidateHF)) {
+          foundJets.cands.push_back(constituentIndex[iParticle]);
         }
-        if (constituent.template user_info<fastjetutilities::fastjet_user_info>().getStatus() == static_cast<int>(JetConstituentStatus::candidateHF)) {
-          candconst.push_back(constituent.template user_info<fastjetutilities::fastjet_user_info>().getIndex());
+      }
+      foundJets.trackOffsets.push_back(foundJets.tracks.size());
+      foundJets.clusterOffsets.push_back(foundJets.clusters.size());
+      foundJets.candOffsets.push_back(foundJets.cands.size());
+    }
+  };
+
+  for (auto R : jetRadius) {
+    jetFinder.jetR = R;
+    if (shareGhosts || noAreas) {
+      jetFinder.findJetsPrepared(inputParticles, jets, shareGhosts);
+      storeJets(R);
+    } else {
+      fastjet::ClusterSequenceArea clusterSeq(jetFinder.findJets(inputParticles, jets));
+      storeJets(R);
+    }
+  }
+}
+
+/**
+ * Fills the jet tables with the jets found in one collision
+ *
+ * @param foundJets jets and constituents found by clusterJets
+ * @param collisionIndex global index of the collision of the jets
+ * @param jetsTable output table of jets
+ * @param constituentsTable output table of jet constituents
+ */
+template <typename U, typename V>
+void fillJetTables(FoundJets const& foundJets, int64_t collisionIndex, U& jetsTable, V& constituentsTable)
+{
+  std::vector<int> trackconst;
+  std::vector<int> candconst;
+  std::vector<int> clusterconst;
+  for (std::size_t iJet = 0; iJet < foundJets.size(); iJet++) {
+    jetsTable(collisionIndex, foundJets.pt[iJet], foundJets.eta[iJet], foundJets.phi[iJet],
+              foundJets.energy[iJet], foundJets.mass[iJet], foundJets.area[iJet], foundJets.r[iJet]);
+    trackconst.assign(foundJets.tracks.begin() + foundJets.trackOffsets[iJet], foundJets.tracks.begin() + foundJets.trackOffsets[iJet + 1]);
+    clusterconst.assign(foundJets.clusters.begin() + foundJets.clusterOffsets[iJet], foundJets.clusters.begin() + foundJets.clusterOffsets[iJet + 1]);
+    candconst.assign(foundJets.cands.begin() + foundJets.candOffsets[iJet], foundJets.cands.begin() + foundJets.candOffsets[iJet + 1]);
+    constituentsTable(jetsTable.lastIndex(), trackconst, clusterconst, candconst);
+  }
+}
+
+/**
+ * Performs jet finding and fills jet tables
+ *
+ * @param jetFinder JetFinder object which carries jet finding parameters
+ * @param inputParticles fastjet container
+ * @param jetRadius jet finding radii
+ * @param collision the collision within which jets are being found
+ * @param jetsTable output table of jets
+ * @param constituentsTable output table of jet constituents
+ * @param doHFJetFinding set whether only jets containing a HF candidate are saved
+ */
+template <typename T, typename U, typename V>
+void findJets(JetFinder& jetFinder, std::vector<fastjet::PseudoJet>& inputParticles, float jetPtMin, float jetPtMax, std::vector<double> jetRadius, float jetAreaFractionMin, T const& collision, U& jetsTable, V& constituentsTable, bool doHFJetFinding = false)
+{
+  FoundJets foundJets;
+  clusterJets(jetFinder, inputParticles, jetPtMin, jetPtMax, jetRadius, jetAreaFractionMin, foundJets, doHFJetFinding);
+  fillJetTables(foundJets, collision.globalIndex(), jetsTable, constituentsTable);
+}
+
+/**
+ * Input particles and found jets of one collision for the collision-parallel jet finding
+ */
+struct JetFindingEvent {
+  int64_t collisionIndex = -1;
+  std::vector<fastjet::PseudoJet> inputParticles;
+  std::vector<fastjet::PseudoJet> ghosts;
+  double ghostArea = 0.;
+  FoundJets jets;
+};
+
+/**
+ * Adds a collision to the list of collisions for findJetsParallel, reusing the memory of the previous time frames
+ *
+ * @param events list of collisions, of which the first nEvents are in use
+ * @param nEvents number of collisions in use, incremented
+ * @param collisionIndex global index of the collision
+ * @return collision to which the input particles are to be added
+ */
+inline JetFindingEvent& addJetFindingEvent(std::vector<JetFindingEvent>& events, std::size_t& nEvents, int64_t collisionIndex)
+{
+  if (events.size() <= nEvents) {
+    events.emplace_back();
+  }
+  auto& event = events[nEvents++];
+  event.collisionIndex = collisionIndex;
+  event.inputParticles.clear();
+  return event;
+}
+
+/**
+ * Returns the number of threads findJetsParallel can use for the jet finding settings
+ *
+ * The shared pointers of fastjet are only thread safe in installations built with thread safety, otherwise a single
+ * thread is used. The ghosts of repeated area estimations (ghostRepeatN > 1, or ghostRepeatN = 0 with an area cut) are
+ * generated inside fastjet from its shared random generator, so these settings also run on a single thread.
+ *
+ * @param jetFinder JetFinder object which carries jet finding parameters
+ * @param nThreads requested number of threads
+ * @param jetAreaFractionMin minimum jet area fraction
+ */
+inline int getJetFindingNThreads(JetFinder const& jetFinder, int nThreads, float jetAreaFractionMin)
+{
+#ifdef FASTJET_HAVE_THREAD_SAFETY
+  const bool shareGhosts = jetFinder.ghostRepeatN == 1;
+  const bool noAreas = jetFinder.ghostRepeatN == 0 && !(jetAreaFractionMin > 0.);
+  if (shareGhosts || noAreas) {
+    return std::max(1, nThreads);
+  }
+#endif
+  return 1;
+}
+
+/**
+ * Performs jet finding for a list of collisions with several threads and fills the jet tables in collision order
+ *
+ * Each thread has its own copy of the JetFinder and takes the next collision of the list when done with the previous one.
+ * The ghosts are generated beforehand in collision order, as the fastjet random generator is shared, such that the
+ * output is identical for any number of threads. The number of threads is limited by getJetFindingNThreads.
+ *
+ * @param jetFinder JetFinder object which carries jet finding parameters
+ * @param nThreads number of threads
+ * @param events collisions with their input particles
+ * @param nEvents number of collisions in use in events
+ * @param jetRadius jet finding radii
+ * @param jetsTable output table of jets
+ * @param constituentsTable output table of jet constituents
+ * @param doHFJetFinding set whether only jets containing a HF candidate are saved
+ */
+template <typename U, typename V>
+void findJetsParallel(JetFinder& jetFinder, int nThreads, std::vector<JetFindingEvent>& events, std::size_t nEvents, float jetPtMin, float jetPtMax, std::vector<double> jetRadius, float jetAreaFractionMin, U& jetsTable, V& constituentsTable, bool doHFJetFinding = false)
+{
+  const bool shareGhosts = jetFinder.ghostRepeatN == 1;
+  if (shareGhosts) {
+    for (std::size_t iEvent = 0; iEvent < nEvents; iEvent++) {
+      jetFinder.prepareGhosts();
+      jetFinder.takeGhosts(events[iEvent].ghosts, events[iEvent].ghostArea);
+    }
+  }
+  fastjet::ClusterSequence::print_banner(); // printed once before starting the threads
+
+  nThreads = std::max(1, std::min(getJetFindingNThreads(jetFinder, nThreads, jetAreaFractionMin), static_cast<int>(nEvents)));
+  std::vector<JetFinder> jetFinders(nThreads, jetFinder);
+  std::vector<std::exception_ptr> exceptions(nThreads);
+  std::atomic<std::size_t> nextEvent{0};
+  auto worker = [&](int iThread) {
+    try {
+      auto& threadJetFinder = jetFinders[iThread];
+      for (std::size_t iEvent = nextEvent++; iEvent < nEvents; iEvent = nextEvent++) {
+        auto& event = events[iEvent];
+        if (shareGhosts) {
+          threadJetFinder.setGhosts(event.ghosts, event.ghostArea);
+        }
+        clusterJets(threadJetFinder, event.inputParticles, jetPtMin, jetPtMax, jetRadius, jetAreaFractionMin, event.jets, doHFJetFinding, true);
+        if (shareGhosts) {
+          threadJetFinder.takeGhosts(event.ghosts, event.ghostArea); // keep the memory with the collision for the next time frame
         }
       }
-      constituentsTable(jetsTable.lastIndex(), trackconst, clusterconst, candconst);
+    } catch (...) {
+      exceptions[iThread] = std::current_exception();
+    }
+  };
+  if (nThreads == 1) {
+    worker(0);
+  } else {
+    std::vector<std::thread> threads;
+    for (int iThread = 0; iThread < nThreads; iThread++) {
+      threads.emplace_back(worker, iThread);
     }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+  for (auto& exception : exceptions) {
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+  }
+
+  for (std::size_t iEvent = 0; iEvent < nEvents; iEvent++) {
+    fillJetTables(events[iEvent].jets, events[iEvent].collisionIndex, jetsTable, constituentsTable);
   }
 }
 
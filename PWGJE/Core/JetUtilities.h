@@ -18,9 +18,11 @@
 #ifndef PWGJE_CORE_JETUTILITIES_H_
 #define PWGJE_CORE_JETUTILITIES_H_
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <numeric>
+#include <stdexcept>
 #include <tuple>
 #include <vector>
 
@@ -32,12 +34,204 @@
 namespace jetutilities
 {
 
+/**
+ * Matching of two object collections in (eta, phi) with a flat grid hash.
+ *
+ * The candidate collection is sorted into a grid of cells at least maxMatchingDistance wide in
+ * eta and phi, phi being treated as periodic, such that all candidates of an object are found in the
+ * 3x3 cells around it. For each object, the maxNumberMatches closest candidates with
+ * dR < maxMatchingDistance are stored ordered by distance in a flat array with a stride of
+ * maxNumberMatches, padded with -1. All buffers are kept between calls, so a matcher which is reused
+ * (e.g. for every BC) does not allocate memory once the buffers reached their largest size.
+ */
+template <typename T>
+class EtaPhiMatcher
+{
+ public:
+  EtaPhiMatcher() = default;
+  EtaPhiMatcher(double maxMatchingDistance, int maxNumberMatches)
+  {
+    setMaxMatchingDistance(maxMatchingDistance);
+    setMaxNumberMatches(maxNumberMatches);
+  }
+
+  void setMaxMatchingDistance(double maxMatchingDistance) { mMaxMatchingDistance = maxMatchingDistance; }
+  void setMaxNumberMatches(int maxNumberMatches) { mMaxNumberMatches = std::max(maxNumberMatches, 0); }
+  double getMaxMatchingDistance() const { return mMaxMatchingDistance; }
+  int getMaxNumberMatches() const { return mMaxNumberMatches; }
+
+  /**
+   * Match each object to the candidates.
+   *
+   * @param objectPhi object collection phi.
+   * @param objectEta object collection eta.
+   * @param candidatePhi candidate collection phi.
+   * @param candidateEta candidate collection eta.
+   */
+  void match(const std::vector<T>& objectPhi, const std::vector<T>& objectEta,
+             const std::vector<T>& candidatePhi, const std::vector<T>& candidateEta)
+  {
+    if (objectPhi.size() != objectEta.size()) {
+      throw std::invalid_argument("object collection eta and phi sizes don't match. Check the inputs.");
+    }
+    if (candidatePhi.size() != candidateEta.size()) {
+      throw std::invalid_argument("candidate collection eta and phi sizes don't match. Check the inputs.");
+    }
+    mNObjects = objectEta.size();
+    mMatches.assign(mNObjects * mMaxNumberMatches, -1);
+    if (!(mNObjects && candidateEta.size() && mMaxNumberMatches > 0 && mMaxMatchingDistance > 0.)) {
+      return;
+    }
+    mDistances.resize(mMaxNumberMatches);
+    buildGrid(candidatePhi, candidateEta);
+    for (std::size_t iObject = 0; iObject < mNObjects; iObject++) {
+      matchObject(objectPhi[iObject], objectEta[iObject], mMatches.data() + iObject * mMaxNumberMatches);
+    }
+  }
+
+  /// Number of objects of the last match() call
+  std::size_t getNObjects() const { return mNObjects; }
+  /// Candidate indices matched to the object, maxNumberMatches entries padded with -1
+  const int* getMatches(std::size_t iObject) const { return mMatches.data() + iObject * mMaxNumberMatches; }
+  int getMatch(std::size_t iObject, int iMatch) const { return mMatches[iObject * mMaxNumberMatches + iMatch]; }
+
+ private:
+  static T wrapPhi(T phi)
+  {
+    constexpr T twoPi = 2. * M_PI;
+    phi = std::fmod(phi, twoPi);
+    return phi < 0. ? phi + twoPi : phi;
+  }
+
+  void buildGrid(const std::vector<T>& candidatePhi, const std::vector<T>& candidateEta)
+  {
+    const std::size_t nCandidates = candidateEta.size();
+    T etaMin = std::numeric_limits<T>::max(), etaMax = std::numeric_limits<T>::lowest();
+    for (std::size_t iCandidate = 0; iCandidate < nCandidates; iCandidate++) {
+      if (std::isfinite(candidateEta[iCandidate])) {
+        etaMin = std::min(etaMin, candidateEta[iCandidate]);
+        etaMax = std::max(etaMax, candidateEta[iCandidate]);
+      }
+    }
+    if (etaMin > etaMax) {
+      etaMin = etaMax = 0.;
+    }
+    // cells are never narrower than the matching distance, and made wider for small distances such
+    // that the grid does not hold many more cells than candidates
+    const double etaRange = std::max(static_cast<double>(etaMax - etaMin), mMaxMatchingDistance);
+    const double cellSize = std::max(mMaxMatchingDistance, std::sqrt(2. * M_PI * etaRange / nCandidates));
+    mNPhiCells = std::max(static_cast<int>(2. * M_PI / cellSize), 1);
+    mPhiCellSize = 2. * M_PI / mNPhiCells;
+    mEtaCellSize = cellSize;
+    mEtaMin = etaMin;
+    mNEtaCells = static_cast<int>((etaMax - etaMin) / mEtaCellSize) + 1;
+
+    // counting sort of the candidates into the cells, keeping the index order within a cell
+    mCandidateCells.resize(nCandidates);
+    mCellOffsets.assign(mNEtaCells * mNPhiCells + 1, 0);
+    for (std::size_t iCandidate = 0; iCandidate < nCandidates; iCandidate++) {
+      const T eta = candidateEta[iCandidate], phi = candidatePhi[iCandidate];
+      if (!(std::isfinite(eta) && std::isfinite(phi))) {
+        mCandidateCells[iCandidate] = -1;
+        continue;
+      }
+      const int etaCell = std::min(static_cast<int>((eta - mEtaMin) / mEtaCellSize), mNEtaCells - 1);
+      const int phiCell = std::min(static_cast<int>(wrapPhi(phi) / mPhiCellSize), mNPhiCells - 1);
+      mCandidateCells[iCandidate] = etaCell * mNPhiCells + phiCell;
+      mCellOffsets[mCandidateCells[iCandidate] + 1]++;
+    }
+    std::partial_sum(mCellOffsets.begin(), mCellOffsets.end(), mCellOffsets.begin());
+    mCellEntries.resize(mCellOffsets.back());
+    mCellFill.assign(mCellOffsets.begin(), mCellOffsets.end() - 1);
+    for (std::size_t iCandidate = 0; iCandidate < nCandidates; iCandidate++) {
+      if (mCandidateCells[iCandidate] >= 0) {
+        mCellEntries[mCellFill[mCandidateCells[iCandidate]]++] = {static_cast<int>(iCandidate), candidateEta[iCandidate], wrapPhi(candidatePhi[iCandidate])};
+      }
+    }
+  }
+
+  void matchObject(T phi, T eta, int* matches)
+  {
+    if (!(std::isfinite(eta) && std::isfinite(phi))) {
+      return;
+    }
+    phi = wrapPhi(phi);
+    // clamp before the conversion, objects far outside of the candidate eta range have no neighbouring cells
+    const double etaPos = std::clamp((eta - mEtaMin) / mEtaCellSize, -2., mNEtaCells + 1.);
+    const int etaCell = static_cast<int>(std::floor(etaPos));
+    const int phiCell = std::min(static_cast<int>(phi / mPhiCellSize), mNPhiCells - 1);
+    // with fewer than three phi cells, every phi cell is a neighbour
+    const int nPhiNeighbours = std::min(mNPhiCells, 3);
+    const int firstPhiCell = mNPhiCells < 3 ? 0 : phiCell - 1 + mNPhiCells;
+    const double maxDistance2 = mMaxMatchingDistance * mMaxMatchingDistance;
+    int nMatches = 0;
+    for (int iEtaCell = std::max(etaCell - 1, 0); iEtaCell <= std::min(etaCell + 1, mNEtaCells - 1); iEtaCell++) {
+      for (int iPhi = 0; iPhi < nPhiNeighbours; iPhi++) {
+        const int cell = iEtaCell * mNPhiCells + (firstPhiCell + iPhi) % mNPhiCells;
+        for (int iEntry = mCellOffsets[cell]; iEntry < mCellOffsets[cell + 1]; iEntry++) {
+          const auto& entry = mCellEntries[iEntry];
+          const double dEta = entry.eta - eta;
+          double dPhi = std::abs(entry.phi - phi);
+          if (dPhi > M_PI) {
+            dPhi = 2. * M_PI - dPhi;
+          }
+          const double distance2 = dEta * dEta + dPhi * dPhi;
+          if (!(distance2 < maxDistance2)) {
+            continue;
+          }
+          // insert into the list of the closest candidates, ties are ordered by candidate index
+          int position = nMatches;
+          while (position > 0 && (distance2 < mDistances[position - 1] || (distance2 == mDistances[position - 1] && entry.index < matches[position - 1]))) {
+            if (position < mMaxNumberMatches) {
+              mDistances[position] = mDistances[position - 1];
+              matches[position] = matches[position - 1];
+            }
+            position--;
+          }
+          if (position < mMaxNumberMatches) {
+            mDistances[position] = distance2;
+            matches[position] = entry.index;
+            nMatches = std::min(nMatches + 1, mMaxNumberMatches);
+          }
+        }
+      }
+    }
+  }
+
+  struct CellEntry {
+    int index;
+    T eta;
+    T phi;
+  };
+
+  double mMaxMatchingDistance = 0.4;
+  int mMaxNumberMatches = 1;
+
+  // grid of the candidates
+  T mEtaMin = 0.;
+  double mEtaCellSize = 1.;
+  double mPhiCellSize = 1.;
+  int mNEtaCells = 0;
+  int mNPhiCells = 0;
+  std::vector<int> mCellOffsets;          // first entry of each cell, CSR layout
+  std::vector<CellEntry> mCellEntries;    // candidates ordered by cell
+  std::vector<int> mCandidateCells;       // cell of each candidate
+  std::vector<int> mCellFill;             // fill position of each cell while sorting
+  std::vector<double> mDistances;         // squared distances of the matches of the current object
+
+  // results
+  std::size_t mNObjects = 0;
+  std::vector<int> mMatches; // nObjects x maxNumberMatches
+};
+
 /**
  * Match clusters and tracks.
  *
  * Match cluster with tracks, where maxNumberMatches are considered in dR=maxMatchingDistance.
  * If no unique match was found for a jet, an index of -1 is stored.
  * The same map is created for clusters matched to tracks e.g. for electron analyses.
+ * The distance takes into account the periodicity in phi. Tasks calling this for every BC should
+ * rather keep an EtaPhiMatcher, which reuses its buffers and avoids the nested vectors.
  *
  * @param clusterPhi cluster collection phi.
  * @param clusterEta cluster collection eta.
@@ -57,84 +251,18 @@ std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>> MatchCl
   double maxMatchingDistance,
   int maxNumberMatches)
 {
-  // test
-  // Validation
-  const std::size_t nClusters = clusterEta.size();
-  const std::size_t nTracks = trackEta.size();
-  if (!(nClusters && nTracks)) {
-    // There are no jets, so nothing to be done.
-    return std::make_tuple(std::vector<std::vector<int>>(nClusters, std::vector<int>(maxNumberMatches, -1)), std::vector<std::vector<int>>(nTracks, std::vector<int>(maxNumberMatches, -1)));
-  }
-  // Input sizes must match
-  if (clusterPhi.size() != clusterEta.size()) {
-    throw std::invalid_argument("cluster collection eta and phi sizes don't match. Check the inputs.");
-  }
-  if (trackPhi.size() != trackEta.size()) {
-    throw std::invalid_argument("track collection eta and phi sizes don't match. Check the inputs.");
-  }
-
-  // for (std::size_t iTrack = 0; iTrack < nTracks; iTrack++) {
-  //   if (trackEta[iTrack] == 0)
-  //     LOG(warning) << "Track eta is 0!";
-  // }
-
-  // Build the KD-trees using vectors
-  // We build two trees:
-  // treeBase, which contains the base collection.
-  // treeTag, which contains the tag collection.
-  // The trees are built to match in two dimensions (eta, phi)
-  TKDTree<int, T> treeCluster(clusterEta.size(), 2, 1), treeTrack(trackEta.size(), 2, 1);
-  // By utilizing SetData, we can avoid having to copy the data again.
-  treeCluster.SetData(0, clusterEta.data());
-  treeCluster.SetData(1, clusterPhi.data());
-  treeCluster.Build();
-  treeTrack.SetData(0, trackEta.data());
-  treeTrack.SetData(1, trackPhi.data());
-  treeTrack.Build();
-
-  // Storage for the cluster matching indices.
-  std::vector<std::vector<int>> matchIndexTrack(nClusters, std::vector<int>(maxNumberMatches, -1));
-  std::vector<std::vector<int>> matchIndexCluster(nTracks, std::vector<int>(maxNumberMatches, -1));
-
-  // Find the track closest to each cluster.
-  for (std::size_t iCluster = 0; iCluster < nClusters; iCluster++) {
-    T point[2] = {clusterEta[iCluster], clusterPhi[iCluster]};
-    int index[50];  // size 50 for safety
-    T distance[50]; // size 50 for safery
-    std::fill_n(index, 50, -1);
-    std::fill_n(distance, 50, std::numeric_limits<T>::max());
-    treeTrack.FindNearestNeighbors(point, maxNumberMatches, index, distance);
-    // test whether indices are matching:
-    matchIndexTrack[iCluster] = std::vector<int>(maxNumberMatches);
-    for (int m = 0; m < maxNumberMatches; m++) {
-      if (index[m] >= 0 && distance[m] < maxMatchingDistance) {
-        matchIndexTrack[iCluster][m] = index[m];
-      } else {
-        // no match or no more matches found, fill -1
-        matchIndexTrack[iCluster][m] = -1;
-      }
+  EtaPhiMatcher<T> matcher(maxMatchingDistance, maxNumberMatches);
+  auto toIndexMap = [&matcher, maxNumberMatches]() {
+    std::vector<std::vector<int>> indexMap(matcher.getNObjects());
+    for (std::size_t iObject = 0; iObject < indexMap.size(); iObject++) {
+      indexMap[iObject].assign(matcher.getMatches(iObject), matcher.getMatches(iObject) + maxNumberMatches);
     }
-  }
-
-  // Find the base jet closest to each tag jet
-  for (std::size_t iTrack = 0; iTrack < nTracks; iTrack++) {
-    T point[2] = {trackEta[iTrack], trackPhi[iTrack]};
-    int index[50];  // size 50 for safety
-    T distance[50]; // size 50 for safery
-    std::fill_n(index, 50, -1);
-    std::fill_n(distance, 50, std::numeric_limits<T>::max());
-    treeCluster.FindNearestNeighbors(point, maxNumberMatches, index, distance);
-    matchIndexCluster[iTrack] = std::vector<int>(maxNumberMatches);
-    // loop over maxNumberMatches closest matches
-    for (int m = 0; m < maxNumberMatches; m++) {
-      if (index[m] >= 0 && distance[m] < maxMatchingDistance) {
-        matchIndexCluster[iTrack][m] = index[m];
-      } else {
-        // no match jet or no more matches found, fill -1
-        matchIndexCluster[iTrack][m] = -1;
-      }
-    }
-  }
+    return indexMap;
+  };
+  matcher.match(clusterPhi, clusterEta, trackPhi, trackEta);
+  auto matchIndexTrack = toIndexMap();
+  matcher.match(trackPhi, trackEta, clusterPhi, clusterEta);
+  auto matchIndexCluster = toIndexMap();
   return std::make_tuple(matchIndexTrack, matchIndexCluster);
 }
 
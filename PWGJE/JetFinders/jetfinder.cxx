@@ -71,6 +71,7 @@ struct JetFinderTask {
   Configurable<int> ghostRepeat{"ghostRepeat", 1, "set to 0 to gain speed if you dont need area calculation"};
   Configurable<bool> DoTriggering{"DoTriggering", false, "used for the charged jet trigger to remove the eta constraint on the jet axis"};
   Configurable<float> jetAreaFractionMin{"jetAreaFractionMin", -99.0, "used to make a cut on the jet areas"};
+  Configurable<int> jetFinderNThreads{"jetFinderNThreads", 1, "number of threads for the collision-parallel jet finding of the process...Parallel functions (needs fastjet built with thread safety)"};
 
   Service<o2::framework::O2DatabasePDG> pdgDatabase;
   int trackSelection = -1;
@@ -79,6 +80,10 @@ struct JetFinderTask {
 
   JetFinder jetFinder;
   std::vector<fastjet::PseudoJet> inputParticles;
+  std::vector<jetfindingutilities::JetFindingEvent> jetFindingEvents;
+
+  PresliceOptional<soa::Filtered<JetTracks>> perCollisionTracks = aod::jtrack::collisionId;
+  PresliceOptional<soa::Filtered<JetClusters>> perCollisionClusters = aod::jcluster::collisionId;
 
   void init(InitContext const&)
   {
@@ -100,6 +105,9 @@ struct JetFinderTask {
     if (DoTriggering) {
       jetFinder.isTriggering = true;
     }
+    if (jetFinderNThreads > 1 && jetfindingutilities::getJetFindingNThreads(jetFinder, jetFinderNThreads, jetAreaFractionMin) == 1) {
+      LOGF(warning, "The parallel jet finding runs on a single thread, as fastjet is not built with thread safety or the ghosts are generated inside fastjet (ghostRepeat = %d)", static_cast<int>(ghostRepeat));
+    }
   }
 
   aod::EMCALClusterDefinition clusterDefinition = aod::emcalcluster::getClusterDefinitionFromString(clusterDefinitionS.value);
@@ -123,6 +131,23 @@ struct JetFinderTask {
 
   PROCESS_SWITCH(JetFinderTask, processChargedJets, "Data and reco level jet finding for charged jets", false);
 
+  void processChargedJetsParallel(soa::Filtered<JetCollisions> const& collisions,
+                                  soa::Filtered<JetTracks> const& tracks)
+  {
+    std::size_t nEvents = 0;
+    for (auto const& collision : collisions) {
+      if (!jetderiveddatautilities::selectCollision(collision, eventSelection)) {
+        continue;
+      }
+      auto& event = jetfindingutilities::addJetFindingEvent(jetFindingEvents, nEvents, collision.globalIndex());
+      auto tracksThisCollision = tracks.sliceBy(perCollisionTracks, collision.globalIndex());
+      jetfindingutilities::analyseTracks<decltype(tracksThisCollision), typename decltype(tracksThisCollision)::iterator>(event.inputParticles, tracksThisCollision, trackSelection);
+    }
+    jetfindingutilities::findJetsParallel(jetFinder, jetFinderNThreads, jetFindingEvents, nEvents, jetPtMin, jetPtMax, jetRadius, jetAreaFractionMin, jetsTable, constituentsTable);
+  }
+
+  PROCESS_SWITCH(JetFinderTask, processChargedJetsParallel, "Data and reco level jet finding for charged jets, with the collisions of a time frame distributed over jetFinderNThreads threads", false);
+
   void processChargedEvtWiseSubJets(soa::Filtered<JetCollisions>::iterator const& collision,
                                     soa::Filtered<JetTracksSub> const& tracks)
   {
@@ -162,6 +187,25 @@ struct JetFinderTask {
   }
   PROCESS_SWITCH(JetFinderTask, processFullJets, "Data and reco level jet finding for full and neutral jets", false);
 
+  void processFullJetsParallel(soa::Filtered<JetCollisions> const& collisions,
+                               soa::Filtered<JetTracks> const& tracks,
+                               soa::Filtered<JetClusters> const& clusters)
+  {
+    std::size_t nEvents = 0;
+    for (auto const& collision : collisions) {
+      if (!jetderiveddatautilities::eventEMCAL(collision)) {
+        continue;
+      }
+      auto& event = jetfindingutilities::addJetFindingEvent(jetFindingEvents, nEvents, collision.globalIndex());
+      auto tracksThisCollision = tracks.sliceBy(perCollisionTracks, collision.globalIndex());
+      auto clustersThisCollision = clusters.sliceBy(perCollisionClusters, collision.globalIndex());
+      jetfindingutilities::analyseTracks<decltype(tracksThisCollision), typename decltype(tracksThisCollision)::iterator>(event.inputParticles, tracksThisCollision, trackSelection);
+      jetfindingutilities::analyseClusters(event.inputParticles, &clustersThisCollision);
+    }
+    jetfindingutilities::findJetsParallel(jetFinder, jetFinderNThreads, jetFindingEvents, nEvents, jetPtMin, jetPtMax, jetRadius, jetAreaFractionMin, jetsTable, constituentsTable);
+  }
+  PROCESS_SWITCH(JetFinderTask, processFullJetsParallel, "Data and reco level jet finding for full and neutral jets, with the collisions of a time frame distributed over jetFinderNThreads threads", false);
+
   void processParticleLevelChargedJets(JetMcCollision const& collision, soa::Filtered<JetParticles> const& particles)
   {
     // TODO: MC event selection?
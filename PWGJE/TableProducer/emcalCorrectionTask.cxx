@@ -106,6 +106,13 @@ struct EmcalCorrectionTask {
   std::vector<o2::emcal::ClusterLabel> mClusterLabels;
 
   std::vector<o2::aod::EMCALClusterDefinition> mClusterDefinitions;
+  // Cluster-track matching, the buffers are reused for every collision
+  jetutilities::EtaPhiMatcher<double> mClusterTrackMatcher;
+  std::vector<double> mTrackPhi;
+  std::vector<double> mTrackEta;
+  std::vector<int64_t> mTrackGlobalIndex;
+  std::vector<double> mClusterPhi;
+  std::vector<double> mClusterEta;
   // QA
   o2::framework::HistogramRegistry mHistManager{"EMCALCorrectionTaskQAHistograms"};
 
@@ -169,6 +176,10 @@ struct EmcalCorrectionTask {
     LOG(info) << "Using nonlinearity parameterisation: " << nonlinearityFunction.value;
     LOG(info) << "Apply shaper saturation correction:  " << (hasShaperCorrection.value ? "yes" : "no");
 
+    // up to 20 closest tracks are matched to each cluster
+    mClusterTrackMatcher.setMaxMatchingDistance(maxMatchingDistance);
+    mClusterTrackMatcher.setMaxNumberMatches(20);
+
     LOG(debug) << "Completed init!";
 
     // Setup QA hists.
@@ -288,15 +299,11 @@ struct EmcalCorrectionTask {
               mHistManager.fill(HIST("hCollisionType"), 1);
               math_utils::Point3D<float> vertex_pos = {col.posX(), col.posY(), col.posZ()};
 
-              std::vector<std::vector<int>> clusterToTrackIndexMap;
-              std::vector<std::vector<int>> trackToClusterIndexMap;
-              std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>> IndexMapPair{clusterToTrackIndexMap, trackToClusterIndexMap};
-              std::vector<int64_t> trackGlobalIndex;
-              doTrackMatching<collEventSels::filtered_iterator>(col, tracks, IndexMapPair, vertex_pos, trackGlobalIndex);
+              doTrackMatching<collEventSels::filtered_iterator>(col, tracks, vertex_pos);
 
               // Store the clusters in the table where a matching collision could
               // be identified.
-              FillClusterTable<collEventSels::filtered_iterator>(col, vertex_pos, iClusterizer, cellIndicesBC, IndexMapPair, trackGlobalIndex);
+              FillClusterTable<collEventSels::filtered_iterator>(col, vertex_pos, iClusterizer, cellIndicesBC, true);
             }
           }
         } else { // ambiguous
@@ -402,15 +409,11 @@ struct EmcalCorrectionTask {
               mHistManager.fill(HIST("hCollisionType"), 1);
               math_utils::Point3D<float> vertex_pos = {col.posX(), col.posY(), col.posZ()};
 
-              std::vector<std::vector<int>> clusterToTrackIndexMap;
-              std::vector<std::vector<int>> trackToClusterIndexMap;
-              std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>> IndexMapPair{clusterToTrackIndexMap, trackToClusterIndexMap};
-              std::vector<int64_t> trackGlobalIndex;
-              doTrackMatching<collEventSels::filtered_iterator>(col, tracks, IndexMapPair, vertex_pos, trackGlobalIndex);
+              doTrackMatching<collEventSels::filtered_iterator>(col, tracks, vertex_pos);
 
               // Store the clusters in the table where a matching collision could
               // be identified.
-              FillClusterTable<collEventSels::filtered_iterator>(col, vertex_pos, iClusterizer, cellIndicesBC, IndexMapPair, trackGlobalIndex);
+              FillClusterTable<collEventSels::filtered_iterator>(col, vertex_pos, iClusterizer, cellIndicesBC, true);
             }
           }
         } else { // ambiguous
@@ -550,7 +553,7 @@ struct EmcalCorrectionTask {
   }
 
   template <typename Collision>
-  void FillClusterTable(Collision const& col, math_utils::Point3D<float> const& vertex_pos, size_t iClusterizer, const gsl::span<int64_t> cellIndicesBC, std::optional<std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>>> const& IndexMapPair = std::nullopt, std::optional<std::vector<int64_t>> const& trackGlobalIndex = std::nullopt)
+  void FillClusterTable(Collision const& col, math_utils::Point3D<float> const& vertex_pos, size_t iClusterizer, const gsl::span<int64_t> cellIndicesBC, bool hasTrackMatches = false)
   {
     // we found a collision, put the clusters into the none ambiguous table
     clusters.reserve(mAnalysisClusters.size());
@@ -600,12 +603,12 @@ struct EmcalCorrectionTask {
       // fill histograms
       mHistManager.fill(HIST("hClusterE"), cluster.E());
       mHistManager.fill(HIST("hClusterEtaPhi"), pos.Eta(), TVector2::Phi_0_2pi(pos.Phi()));
-      if (IndexMapPair && trackGlobalIndex) {
-        for (unsigned int iTrack = 0; iTrack < std::get<0>(*IndexMapPair)[iCluster].size(); iTrack++) {
-          if (std::get<0>(*IndexMapPair)[iCluster][iTrack] >= 0) {
-            LOG(debug) << "Found track " << (*trackGlobalIndex)[std::get<0>(*IndexMapPair)[iCluster][iTrack]] << " in cluster " << cluster.getID();
-            matchedTracks(clusters.lastIndex(), (*trackGlobalIndex)[std::get<0>(*IndexMapPair)[iCluster][iTrack]]);
-          }
+      if (hasTrackMatches) {
+        // matches are ordered by distance, unused entries are -1
+        const int* matchedTrackIndices = mClusterTrackMatcher.getMatches(iCluster);
+        for (int iTrack = 0; iTrack < mClusterTrackMatcher.getMaxNumberMatches() && matchedTrackIndices[iTrack] >= 0; iTrack++) {
+          LOG(debug) << "Found track " << mTrackGlobalIndex[matchedTrackIndices[iTrack]] << " in cluster " << cluster.getID();
+          matchedTracks(clusters.lastIndex(), mTrackGlobalIndex[matchedTrackIndices[iTrack]]);
         }
       }
       iCluster++;
@@ -655,24 +658,16 @@ struct EmcalCorrectionTask {
   }
 
   template <typename Collision>
-  void doTrackMatching(Collision const& col, myGlobTracks const& tracks, std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>>& IndexMapPair, math_utils::Point3D<float>& vertex_pos, std::vector<int64_t>& trackGlobalIndex)
+  void doTrackMatching(Collision const& col, myGlobTracks const& tracks, math_utils::Point3D<float>& vertex_pos)
   {
     auto groupedTracks = tracks.sliceBy(perCollision, col.globalIndex());
-    int NTracksInCol = groupedTracks.size();
-    std::vector<double> trackPhi;
-    std::vector<double> trackEta;
-    // reserve memory to reduce on the fly memory allocation
-    trackPhi.reserve(NTracksInCol);
-    trackEta.reserve(NTracksInCol);
-    trackGlobalIndex.reserve(NTracksInCol);
-    FillTrackInfo<decltype(groupedTracks)>(groupedTracks, trackPhi, trackEta, trackGlobalIndex);
-
-    int NClusterInCol = mAnalysisClusters.size();
-    std::vector<double> clusterPhi;
-    std::vector<double> clusterEta;
-    clusterPhi.reserve(NClusterInCol);
-    clusterEta.reserve(NClusterInCol);
+    mTrackPhi.clear();
+    mTrackEta.clear();
+    mTrackGlobalIndex.clear();
+    FillTrackInfo<decltype(groupedTracks)>(groupedTracks, mTrackPhi, mTrackEta, mTrackGlobalIndex);
 
+    mClusterPhi.clear();
+    mClusterEta.clear();
     // TODO one loop that could in principle be combined with the other
     // loop to improve performance
     for (const auto& cluster : mAnalysisClusters) {
@@ -682,13 +677,10 @@ struct EmcalCorrectionTask {
       pos = pos - vertex_pos;
       // Normalize the vector and rescale by energy.
       pos *= (cluster.E() / std::sqrt(pos.Mag2()));
-      clusterPhi.emplace_back(TVector2::Phi_0_2pi(pos.Phi()));
-      clusterEta.emplace_back(pos.Eta());
+      mClusterPhi.emplace_back(TVector2::Phi_0_2pi(pos.Phi()));
+      mClusterEta.emplace_back(pos.Eta());
     }
-    IndexMapPair =
-      jetutilities::MatchClustersAndTracks(clusterPhi, clusterEta,
-                                           trackPhi, trackEta,
-                                           maxMatchingDistance, 20);
+    mClusterTrackMatcher.match(mClusterPhi, mClusterEta, mTrackPhi, mTrackEta);
   }
 
   template <typename Tracks>
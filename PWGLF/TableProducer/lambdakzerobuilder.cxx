@@ -42,6 +42,7 @@
 #include <map>
 #include <iterator>
 #include <utility>
+#include <vector>
 
 #include "Framework/runDataProcessing.h"
 #include "Framework/RunningWorkflowInfo.h"
@@ -50,6 +51,7 @@
 #include "Framework/ASoAHelpers.h"
 #include "DCAFitter/DCAFitterN.h"
 #include "ReconstructionDataFormats/Track.h"
+#include "Common/Core/ParallelFor.h"
 #include "Common/Core/RecoDecay.h"
 #include "Common/Core/trackUtilities.h"
 #include "PWGLF/DataModel/LFStrangenessTables.h"
@@ -144,6 +146,13 @@ struct lambdakzeroBuilder {
   Configurable<bool> d_QA_checkMC{"d_QA_checkMC", true, "check MC truth in QA"};
   Configurable<bool> d_QA_checkdEdx{"d_QA_checkdEdx", false, "check dEdx in QA"};
 
+  // Two-stage building: pre-filter on the daughter helices, then fit of the survivors on several threads
+  Configurable<bool> d_usePrefilter{"d_usePrefilter", true, "pre-filter V0s on daughter helices before propagating and fitting them"};
+  Configurable<float> d_prefilterMargin{"d_prefilterMargin", 0.05, "pre-filter margin on the daughter DCAs to PV and on the distance between daughter circles (cm)"};
+  Configurable<float> d_prefilterCurvatureTolerance{"d_prefilterCurvatureTolerance", 0.05, "pre-filter relative curvature change allowed between the innermost update and the PV, e.g. by energy loss"};
+  Configurable<int> nThreads{"nThreads", 1, "number of threads fitting the V0s, 0 for the hardware concurrency"};
+  Configurable<int> fitChunkSize{"fitChunkSize", 64, "number of consecutive V0s fitted by a thread at once"};
+
   // CCDB options
   Configurable<std::string> ccdburl{"ccdb-url", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
   Configurable<std::string> grpPath{"grpPath", "GLO/GRP/GRP", "Path of the grp file"};
@@ -210,8 +219,37 @@ struct lambdakzeroBuilder {
   o2::base::MatLayerCylSet* lut = nullptr;
   o2::dataformats::MeanVertexObject* mVtx = nullptr;
 
-  // Define o2 fitter, 2-prong, active memory (no need to redefine per event)
-  o2::vertexing::DCAFitterN<2> fitter;
+  // Define o2 fitters, 2-prong, one per thread, active memory (no need to redefine per event)
+  std::vector<o2::vertexing::DCAFitterN<2>> fitters;
+  o2::base::Propagator::MatCorrType matCorr = o2::base::Propagator::MatCorrType::USEMatCorrNONE;
+
+  // V0s of the time frame in building, in the order of the V0 table
+  struct V0Fit {
+    bool toFit = false;              // passes the TPC refit requirement and the pre-filter
+    bool dcaOK = false;              // passes the daughter DCA to PV selections
+    bool fitOK = false;              // the fitter found a candidate
+    bool exception = false;          // the fitter threw
+    std::array<float, 3> pv;         // position of the PV
+    o2::track::TrackParCov posTrack; // at the innermost update, then at the PCA
+    o2::track::TrackParCov negTrack;
+    o2::track::TrackPar posTrackPar; // propagated to the PV
+    o2::track::TrackPar negTrackPar;
+    gpu::gpustd::array<float, 2> negDcaInfo = {0.f, 0.f};
+    float posDCAxy = 0.f;
+    float negDCAxy = 0.f;
+    std::array<float, 3> pca;
+    float chi2PCA = 0.f;
+    std::array<float, 6> pcaCov; // if createV0CovMats
+  };
+  std::vector<V0Fit> v0Fits;
+
+  // Circles of the daughters in the transverse plane at the nominal field, flat arrays for the pre-filter loop
+  struct {
+    std::vector<float> posXC, posYC, posR, posX;
+    std::vector<float> negXC, negYC, negR, negX;
+    std::vector<float> pvX, pvY;
+    std::vector<uint8_t> pass;
+  } prefilter;
 
   // provision to repeat mass selections while doing AND with PID selections
   // fixme : this could be done more uniformly svertexer with reconstruction
@@ -533,24 +571,33 @@ struct lambdakzeroBuilder {
     }
     //*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*
 
-    // initialize O2 2-prong fitter (only once)
-    fitter.setPropagateToPCA(true);
-    fitter.setMaxR(200.);
-    fitter.setMinParamChange(1e-3);
-    fitter.setMinRelChi2Change(0.9);
-    fitter.setMaxDZIni(d_maxDZIni);
-    fitter.setMaxDXYIni(d_maxDXYIni);
-    fitter.setMaxChi2(1e9);
-    fitter.setUseAbsDCA(d_UseAbsDCA);
-    fitter.setWeightedFinalPCA(d_UseWeightedPCA);
-
     // Material correction in the DCA fitter
-    o2::base::Propagator::MatCorrType matCorr = o2::base::Propagator::MatCorrType::USEMatCorrNONE;
     if (useMatCorrType == 1)
       matCorr = o2::base::Propagator::MatCorrType::USEMatCorrTGeo;
     if (useMatCorrType == 2)
       matCorr = o2::base::Propagator::MatCorrType::USEMatCorrLUT;
-    fitter.setMatCorrType(matCorr);
+
+    // the TGeo navigation is not shared between threads
+    if (useMatCorrType == 1 && o2::analysis::getNThreads(nThreads) > 1) {
+      LOGF(warn, "TGeo material correction requested, V0s will be fitted on a single thread");
+      nThreads.value = 1;
+    }
+    LOGF(info, " ---+*> V0s will be fitted on %d thread(s)", o2::analysis::getNThreads(nThreads));
+
+    // initialize O2 2-prong fitters (only once)
+    fitters.resize(o2::analysis::getNThreads(nThreads));
+    for (auto& fitter : fitters) {
+      fitter.setPropagateToPCA(true);
+      fitter.setMaxR(200.);
+      fitter.setMinParamChange(1e-3);
+      fitter.setMinRelChi2Change(0.9);
+      fitter.setMaxDZIni(d_maxDZIni);
+      fitter.setMaxDXYIni(d_maxDXYIni);
+      fitter.setMaxChi2(1e9);
+      fitter.setUseAbsDCA(d_UseAbsDCA);
+      fitter.setWeightedFinalPCA(d_UseWeightedPCA);
+      fitter.setMatCorrType(matCorr);
+    }
   }
 
   void initCCDB(aod::BCsWithTimestamps::iterator const& bc)
@@ -562,7 +609,9 @@ struct lambdakzeroBuilder {
     // In case override, don't proceed, please - no CCDB access required
     if (d_bz_input > -990) {
       d_bz = d_bz_input;
-      fitter.setBz(d_bz);
+      for (auto& fitter : fitters) {
+        fitter.setBz(d_bz);
+      }
       o2::parameters::GRPMagField grpmag;
       if (fabs(d_bz) > 1e-5) {
         grpmag.setL3Current(30000.f / (d_bz / 5.0f));
@@ -595,7 +644,9 @@ struct lambdakzeroBuilder {
     mVtx = ccdb->getForTimeStamp<o2::dataformats::MeanVertexObject>(mVtxPath, bc.timestamp());
     mRunNumber = bc.runNumber();
     // Set magnetic field value once known
-    fitter.setBz(d_bz);
+    for (auto& fitter : fitters) {
+      fitter.setBz(d_bz);
+    }
 
     if (useMatCorrType == 2) {
       // setMatLUT only after magfield has been initalized
@@ -604,8 +655,158 @@ struct lambdakzeroBuilder {
     }
   }
 
+  // Stage 1: V0s of the table to be built, with their daughters at the innermost update and their PV.
+  // The downscaling stops at the first rejected V0.
+  template <class TTrackTo, typename TV0Table>
+  void gatherV0s(TV0Table const& V0s)
+  {
+    v0Fits.clear();
+    for (auto& V0 : V0s) {
+      // downscale some V0s if requested to do so
+      if (downscaleFactor < 1.f && (static_cast<float>(rand_r(&randomSeed)) / static_cast<float>(RAND_MAX)) > downscaleFactor) {
+        return;
+      }
+      auto const& posTrack = V0.template posTrack_as<TTrackTo>();
+      auto const& negTrack = V0.template negTrack_as<TTrackTo>();
+      auto& v0Fit = v0Fits.emplace_back();
+      if (V0.has_collision()) {
+        auto const& collision = V0.collision();
+        v0Fit.pv = {collision.posX(), collision.posY(), collision.posZ()};
+      } else {
+        v0Fit.pv = {mVtx->getX(), mVtx->getY(), mVtx->getZ()};
+      }
+      v0Fit.toFit = !tpcrefit || ((posTrack.trackType() & o2::aod::track::TPCrefit) && (negTrack.trackType() & o2::aod::track::TPCrefit));
+      v0Fit.posTrack = getTrackParCov(posTrack);
+      v0Fit.negTrack = getTrackParCov(negTrack);
+    }
+  }
+
+  // Stage 1: rejection of the V0s which cannot pass the daughter DCA to PV selections or for which the
+  // fitter cannot find a seed, using the daughter circles at the nominal field. The daughter DCAs are
+  // estimated on the circles, with a tolerance for the curvature change up to the PV growing with the
+  // square of the distance to it. The seeds are looked for by the fitter on the same circles, such that
+  // the second rejection only needs a margin for rounding.
+  void prefilterV0s()
+  {
+    const int nV0s = v0Fits.size();
+    if (!d_usePrefilter || std::abs(d_bz) < 1e-3) {
+      return; // no circles without field
+    }
+    auto& pf = prefilter;
+    for (auto* v : {&pf.posXC, &pf.posYC, &pf.posR, &pf.posX, &pf.negXC, &pf.negYC, &pf.negR, &pf.negX, &pf.pvX, &pf.pvY}) {
+      v->resize(nV0s);
+    }
+    pf.pass.resize(nV0s);
+    o2::math_utils::CircleXYf_t circle;
+    float sna, csa;
+    for (int i = 0; i < nV0s; i++) {
+      v0Fits[i].posTrack.getCircleParams(d_bz, circle, sna, csa);
+      pf.posXC[i] = circle.xC;
+      pf.posYC[i] = circle.yC;
+      pf.posR[i] = circle.rC;
+      pf.posX[i] = v0Fits[i].posTrack.getX();
+      v0Fits[i].negTrack.getCircleParams(d_bz, circle, sna, csa);
+      pf.negXC[i] = circle.xC;
+      pf.negYC[i] = circle.yC;
+      pf.negR[i] = circle.rC;
+      pf.negX[i] = v0Fits[i].negTrack.getX();
+      pf.pvX[i] = v0Fits[i].pv[0];
+      pf.pvY[i] = v0Fits[i].pv[1];
+    }
+
+    // branch-free loop on the flat arrays, vectorised by the compiler
+    // (written as rejections such that a NaN keeps the V0)
+    const float minDCAPos = dcapostopv - d_prefilterMargin;
+    const float minDCANeg = dcanegtopv - d_prefilterMargin;
+    const float maxDXY = d_maxDXYIni + d_prefilterMargin;
+    const float curvatureTolerance = d_prefilterCurvatureTolerance;
+    for (int i = 0; i < nV0s; i++) {
+      float posDX = pf.posXC[i] - pf.pvX[i];
+      float posDY = pf.posYC[i] - pf.pvY[i];
+      float posDCA = std::abs(std::sqrt(posDX * posDX + posDY * posDY) - pf.posR[i]);
+      float posTolerance = curvatureTolerance * pf.posX[i] * pf.posX[i] / (2.f * pf.posR[i]);
+      float negDX = pf.negXC[i] - pf.pvX[i];
+      float negDY = pf.negYC[i] - pf.pvY[i];
+      float negDCA = std::abs(std::sqrt(negDX * negDX + negDY * negDY) - pf.negR[i]);
+      float negTolerance = curvatureTolerance * pf.negX[i] * pf.negX[i] / (2.f * pf.negR[i]);
+      float dXC = pf.posXC[i] - pf.negXC[i];
+      float dYC = pf.posYC[i] - pf.negYC[i];
+      float centerDistance = std::sqrt(dXC * dXC + dYC * dYC);
+      float rMax = std::max(pf.posR[i], pf.negR[i]);
+      float rMin = std::min(pf.posR[i], pf.negR[i]);
+      bool reject = (posDCA + posTolerance < minDCAPos) | (negDCA + negTolerance < minDCANeg) |
+                    (centerDistance - rMax - rMin > maxDXY) | (rMax - rMin - centerDistance > maxDXY);
+      pf.pass[i] = !reject;
+    }
+    for (int i = 0; i < nV0s; i++) {
+      v0Fits[i].toFit &= static_cast<bool>(pf.pass[i]);
+    }
+  }
+
+  // Stage 2: propagation of the daughters to the PV and fit of a V0, thread-safe with a fitter per thread
+  void fitV0(V0Fit& v0Fit, o2::vertexing::DCAFitterN<2>& fitter)
+  {
+    // Calculate DCA with respect to the collision associated to the V0, not individual tracks
+    gpu::gpustd::array<float, 2> dcaInfo = {0.f, 0.f};
+
+    v0Fit.posTrackPar = v0Fit.posTrack;
+    o2::base::Propagator::Instance()->propagateToDCABxByBz({v0Fit.pv[0], v0Fit.pv[1], v0Fit.pv[2]}, v0Fit.posTrackPar, 2.f, matCorr, &dcaInfo);
+    v0Fit.posDCAxy = dcaInfo[0];
+
+    v0Fit.negTrackPar = v0Fit.negTrack;
+    o2::base::Propagator::Instance()->propagateToDCABxByBz({v0Fit.pv[0], v0Fit.pv[1], v0Fit.pv[2]}, v0Fit.negTrackPar, 2.f, matCorr, &dcaInfo);
+    v0Fit.negDCAxy = dcaInfo[0];
+    v0Fit.negDcaInfo = dcaInfo;
+
+    if (fabs(v0Fit.posDCAxy) < dcapostopv || fabs(v0Fit.negDCAxy) < dcanegtopv) {
+      return;
+    }
+    v0Fit.dcaOK = true;
+
+    //---/---/---/
+    // Move close to minima
+    int nCand = 0;
+    try {
+      nCand = fitter.process(v0Fit.posTrack, v0Fit.negTrack);
+    } catch (...) {
+      v0Fit.exception = true;
+      return;
+    }
+    if (nCand == 0) {
+      return;
+    }
+    v0Fit.fitOK = true;
+
+    v0Fit.posTrack = fitter.getTrack(0);
+    v0Fit.negTrack = fitter.getTrack(1);
+    const auto& vtx = fitter.getPCACandidate();
+    for (int i = 0; i < 3; i++) {
+      v0Fit.pca[i] = vtx[i];
+    }
+    v0Fit.chi2PCA = fitter.getChi2AtPCACandidate();
+    if (createV0CovMats) {
+      // Calculate position covariance matrix
+      auto covVtxV = fitter.calcPCACovMatrix(0);
+      v0Fit.pcaCov = {static_cast<float>(covVtxV(0, 0)), static_cast<float>(covVtxV(1, 0)), static_cast<float>(covVtxV(1, 1)),
+                      static_cast<float>(covVtxV(2, 0)), static_cast<float>(covVtxV(2, 1)), static_cast<float>(covVtxV(2, 2))};
+    }
+  }
+
+  // Stage 2: fit of the V0s passing the pre-filter, in chunks handed out to the threads
+  void fitV0s()
+  {
+    o2::analysis::parallelForChunks(v0Fits.size(), fitters.size(), fitChunkSize, [&](int first, int last, int iThread) {
+      for (int i = first; i < last; i++) {
+        if (v0Fits[i].toFit) {
+          fitV0(v0Fits[i], fitters[iThread]);
+        }
+      }
+    });
+  }
+
+  // Stage 3: selections of a fitted V0, in the order of the table
   template <class TTrackTo, typename TV0Object>
-  bool buildV0Candidate(TV0Object const& V0)
+  bool buildV0Candidate(TV0Object const& V0, V0Fit const& v0Fit)
   {
     // Get tracks
     auto const& posTrack = V0.template posTrack_as<TTrackTo>();
@@ -613,13 +814,7 @@ struct lambdakzeroBuilder {
 
     // for storing whatever is the relevant quantity for the PV
     o2::dataformats::VertexBase primaryVertex;
-    if (V0.has_collision()) {
-      auto const& collision = V0.collision();
-      primaryVertex.setPos({collision.posX(), collision.posY(), collision.posZ()});
-      primaryVertex.setCov(collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ());
-    } else {
-      primaryVertex.setPos({mVtx->getX(), mVtx->getY(), mVtx->getZ()});
-    }
+    primaryVertex.setPos({v0Fit.pv[0], v0Fit.pv[1], v0Fit.pv[2]});
 
     // value 0.5: any considered V0
     statisticsRegistry.v0stats[kV0All]++;
@@ -635,63 +830,47 @@ struct lambdakzeroBuilder {
     // Passes TPC refit
     statisticsRegistry.v0stats[kV0TPCrefit]++;
 
-    // Calculate DCA with respect to the collision associated to the V0, not individual tracks
-    gpu::gpustd::array<float, 2> dcaInfo;
-
-    auto posTrackPar = getTrackPar(posTrack);
-    o2::base::Propagator::Instance()->propagateToDCABxByBz({primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ()}, posTrackPar, 2.f, fitter.getMatCorrType(), &dcaInfo);
-    auto posTrackdcaXY = dcaInfo[0];
-
-    auto negTrackPar = getTrackPar(negTrack);
-    o2::base::Propagator::Instance()->propagateToDCABxByBz({primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ()}, negTrackPar, 2.f, fitter.getMatCorrType(), &dcaInfo);
-    auto negTrackdcaXY = dcaInfo[0];
-
-    if (fabs(posTrackdcaXY) < dcapostopv || fabs(negTrackdcaXY) < dcanegtopv) {
+    // rejected by the pre-filter or by the DCAs to the PV
+    if (!v0Fit.dcaOK) {
       return false;
     }
 
     // Initialize properly, please
-    v0candidate.posDCAxy = posTrackdcaXY;
-    v0candidate.negDCAxy = negTrackdcaXY;
+    v0candidate.posDCAxy = v0Fit.posDCAxy;
+    v0candidate.negDCAxy = v0Fit.negDCAxy;
+    auto const& posTrackPar = v0Fit.posTrackPar;
+    auto const& negTrackPar = v0Fit.negTrackPar;
+    auto const& dcaInfo = v0Fit.negDcaInfo;
 
     // passes DCAxy
     statisticsRegistry.v0stats[kV0DCAxy]++;
 
-    // Change strangenessBuilder tracks
-    lPositiveTrack = getTrackParCov(posTrack);
-    lNegativeTrack = getTrackParCov(negTrack);
-
-    //---/---/---/
-    // Move close to minima
-    int nCand = 0;
-    try {
-      nCand = fitter.process(lPositiveTrack, lNegativeTrack);
-    } catch (...) {
+    if (v0Fit.exception) {
       statisticsRegistry.exceptions++;
       LOG(error) << "Exception caught in DCA fitter process call!";
       return false;
     }
-    if (nCand == 0) {
+    if (!v0Fit.fitOK) {
       return false;
     }
 
-    v0candidate.posTrackX = fitter.getTrack(0).getX();
-    v0candidate.negTrackX = fitter.getTrack(1).getX();
+    // Change strangenessBuilder tracks
+    lPositiveTrack = v0Fit.posTrack;
+    lNegativeTrack = v0Fit.negTrack;
+    v0candidate.posTrackX = lPositiveTrack.getX();
+    v0candidate.negTrackX = lNegativeTrack.getX();
 
-    lPositiveTrack = fitter.getTrack(0);
-    lNegativeTrack = fitter.getTrack(1);
     lPositiveTrack.getPxPyPzGlo(v0candidate.posP);
     lNegativeTrack.getPxPyPzGlo(v0candidate.negP);
     lPositiveTrack.getXYZGlo(v0candidate.posPosition);
     lNegativeTrack.getXYZGlo(v0candidate.negPosition);
 
     // get decay vertex coordinates
-    const auto& vtx = fitter.getPCACandidate();
     for (int i = 0; i < 3; i++) {
-      v0candidate.pos[i] = vtx[i];
+      v0candidate.pos[i] = v0Fit.pca[i];
     }
 
-    v0candidate.dcaV0dau = TMath::Sqrt(fitter.getChi2AtPCACandidate());
+    v0candidate.dcaV0dau = TMath::Sqrt(v0Fit.chi2PCA);
 
     // Apply selections so a skimmed table is created only
     if (v0candidate.dcaV0dau > dcav0dau) {
@@ -883,14 +1062,14 @@ struct lambdakzeroBuilder {
       if (!posTrack.hasITS() && !posTrack.hasTRD() && !posTrack.hasTOF() && !negTrack.hasITS() && !negTrack.hasTRD() && !negTrack.hasTOF()) {
         if (V0.isTrueGamma()) {
           registry.fill(HIST("h2d_pcm_DCAXY_True"), lPt, std::hypot(dcaInfo[0], dcaInfo[1]));
-          registry.fill(HIST("h2d_pcm_DCACHI2_True"), lPt, fitter.getChi2AtPCACandidate());
+          registry.fill(HIST("h2d_pcm_DCACHI2_True"), lPt, v0Fit.chi2PCA);
           registry.fill(HIST("h2d_pcm_DeltaDistanceRadii_True"), lPt, centerDistance - trcCircle1.rC - trcCircle2.rC);
           registry.fill(HIST("h2d_pcm_PositionGuess_True"), lPt, delta2);
           registry.fill(HIST("h2d_pcm_RadiallyOutgoingAtThisRadius1_True"), lPt, delta3_track1);
           registry.fill(HIST("h2d_pcm_RadiallyOutgoingAtThisRadius2_True"), lPt, delta3_track2);
         } else {
           registry.fill(HIST("h2d_pcm_DCAXY_Bg"), lPt, std::hypot(dcaInfo[0], dcaInfo[1]));
-          registry.fill(HIST("h2d_pcm_DCACHI2_Bg"), lPt, fitter.getChi2AtPCACandidate());
+          registry.fill(HIST("h2d_pcm_DCACHI2_Bg"), lPt, v0Fit.chi2PCA);
           registry.fill(HIST("h2d_pcm_DeltaDistanceRadii_Bg"), lPt, centerDistance - trcCircle1.rC - trcCircle2.rC);
           registry.fill(HIST("h2d_pcm_PositionGuess_Bg"), lPt, delta2);
           registry.fill(HIST("h2d_pcm_RadiallyOutgoingAtThisRadius1_Bg"), lPt, delta3_track1);
@@ -905,15 +1084,21 @@ struct lambdakzeroBuilder {
   template <class TTrackTo, typename TV0Table>
   void buildStrangenessTables(TV0Table const& V0s)
   {
+    // Pre-filters and fits all V0s in the time frame
+    gatherV0s<TTrackTo>(V0s);
+    prefilterV0s();
+    fitV0s();
+
     // Loops over all V0s in the time frame
+    size_t iV0 = 0;
     for (auto& V0 : V0s) {
-      // downscale some V0s if requested to do so
-      if (downscaleFactor < 1.f && (static_cast<float>(rand_r(&randomSeed)) / static_cast<float>(RAND_MAX)) > downscaleFactor) {
-        return;
+      if (iV0 == v0Fits.size()) {
+        return; // downscaled
       }
+      auto const& v0Fit = v0Fits[iV0++];
 
       // populates v0candidate struct declared inside strangenessbuilder
-      bool validCandidate = buildV0Candidate<TTrackTo>(V0);
+      bool validCandidate = buildV0Candidate<TTrackTo>(V0, v0Fit);
 
       if (!validCandidate) {
         continue; // doesn't pass selections
@@ -968,16 +1153,11 @@ struct lambdakzeroBuilder {
 
       // populate V0 covariance matrices if required by any other task
       if (createV0CovMats) {
-        // Calculate position covariance matrix
-        auto covVtxV = fitter.calcPCACovMatrix(0);
-        // std::array<float, 6> positionCovariance;
+        // position covariance matrix, calculated with the fit
         float positionCovariance[6];
-        positionCovariance[0] = covVtxV(0, 0);
-        positionCovariance[1] = covVtxV(1, 0);
-        positionCovariance[2] = covVtxV(1, 1);
-        positionCovariance[3] = covVtxV(2, 0);
-        positionCovariance[4] = covVtxV(2, 1);
-        positionCovariance[5] = covVtxV(2, 2);
+        for (int i = 0; i < 6; i++) {
+          positionCovariance[i] = v0Fit.pcaCov[i];
+        }
         std::array<float, 21> covTpositive = {0.};
         std::array<float, 21> covTnegative = {0.};
         // std::array<float, 6> momentumCovariance;
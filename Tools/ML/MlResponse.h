@@ -19,7 +19,9 @@
 
 #include <onnxruntime/core/session/experimental_onnxruntime_cxx_api.h>
 
+#include <algorithm>
 #include <map>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -43,7 +45,8 @@ enum CutDirection {
 namespace analysis
 {
 // TypeOutputScore is the type of the output score from o2::ml::OnnxModel (float by default)
-template <typename TypeOutputScore = float>
+// TypeInputFeature is the type of the input features fed to the batched inference (float by default)
+template <typename TypeOutputScore = float, typename TypeInputFeature = float>
 class MlResponse
 {
  public:
@@ -70,6 +73,7 @@ class MlResponse
     mNModels = binsLimits.size() - 1;
     mModels = std::vector<o2::ml::OnnxModel>(mNModels);
     mPaths = std::vector<std::string>(mNModels);
+    clearBatch();
   }
 
   /// Set model paths to CCDB
@@ -158,20 +162,7 @@ class MlResponse
   {
     int nModel = findBin(candVar);
     auto output = getModelOutput(input, nModel);
-    uint8_t iClass{0};
-    for (const auto& outputValue : output) {
-      uint8_t dir = mCutDir.at(iClass);
-      if (dir != o2::cuts_ml::CutDirection::CutNot) {
-        if (dir == o2::cuts_ml::CutDirection::CutGreater && outputValue > mCuts.get(nModel, iClass)) {
-          return false;
-        }
-        if (dir == o2::cuts_ml::CutDirection::CutSmaller && outputValue < mCuts.get(nModel, iClass)) {
-          return false;
-        }
-      }
-      ++iClass;
-    }
-    return true;
+    return isPassingCuts(output.data(), nModel);
   }
 
   /// ML selections
@@ -184,20 +175,91 @@ class MlResponse
   {
     int nModel = findBin(candVar);
     output = getModelOutput(input, nModel);
-    uint8_t iClass{0};
-    for (const auto& outputValue : output) {
-      uint8_t dir = mCutDir.at(iClass);
-      if (dir != o2::cuts_ml::CutDirection::CutNot) {
-        if (dir == o2::cuts_ml::CutDirection::CutGreater && outputValue > mCuts.get(nModel, iClass)) {
-          return false;
-        }
-        if (dir == o2::cuts_ml::CutDirection::CutSmaller && outputValue < mCuts.get(nModel, iClass)) {
-          return false;
-        }
+    return isPassingCuts(output.data(), nModel);
+  }
+
+  /// Batched inference: rows are collected per model (bin) in contiguous arenas and each model is
+  /// evaluated with a single session call in evalBatch(). Typical usage:
+  ///   clearBatch(); for (...) { idx = addToBatch(features, pt); } evalBatch(); isSelectedMlBatch(idx, output);
+
+  /// Reset the batch arenas (keeps the allocated capacity)
+  void clearBatch()
+  {
+    mBatchInputs.resize(mNModels);
+    mBatchOutputs.resize(mNModels);
+    mBatchOutputStrides.assign(mNModels, 0);
+    mBatchRows.assign(mNModels, 0);
+    for (auto iModel{0}; iModel < mNModels; ++iModel) {
+      mBatchInputs[iModel].clear();
+      mBatchOutputs[iModel].clear();
+    }
+    mBatchEntries.clear();
+  }
+
+  /// Add a candidate to the batch
+  /// \param input is the input features
+  /// \param candVar is the variable value (e.g. pT) used to select which model to use
+  /// \return index of the candidate in the batch, to be used to retrieve the model output after evalBatch()
+  template <typename T1, typename T2>
+  int addToBatch(const T1& input, const T2& candVar)
+  {
+    int nModel = findBin(candVar);
+    if (nModel < 0 || static_cast<std::size_t>(nModel) >= mModels.size()) {
+      LOG(fatal) << "Model index " << nModel << " is out of range! The number of initialised models is " << mModels.size() << ". Please check your configurables.";
+    }
+    if (static_cast<int64_t>(input.size()) != mModels[nModel].getNumInputNodes()) {
+      LOG(fatal) << "Candidate has " << input.size() << " input features, but model " << nModel << " expects " << mModels[nModel].getNumInputNodes() << "! Please check your configurables.";
+    }
+    auto& arena = mBatchInputs[nModel];
+    const int64_t row = mBatchRows[nModel]++;
+    arena.insert(arena.end(), input.begin(), input.end());
+    mBatchEntries.push_back({static_cast<int16_t>(nModel), row});
+    return static_cast<int>(mBatchEntries.size()) - 1;
+  }
+
+  /// Run one inference per model on all the rows collected since the last clearBatch()
+  void evalBatch()
+  {
+    for (auto iModel{0}; iModel < mNModels; ++iModel) {
+      auto& arena = mBatchInputs[iModel];
+      const int64_t nRows = mBatchRows[iModel];
+      if (nRows == 0) {
+        continue;
+      }
+      auto& scores = mBatchOutputs[iModel];
+      if (!mModels[iModel].evalModelBatch(arena.data(), nRows, scores)) {
+        LOG(fatal) << "Batched inference failed for model " << iModel << "!";
+      }
+      // number of values per row of the output tensor, which can exceed the number of classes (e.g. probabilities and label)
+      if (scores.size() % nRows != 0) {
+        LOG(fatal) << "Output of model " << iModel << " has " << scores.size() << " values, not a multiple of the number of rows (" << nRows << ")!";
+      }
+      mBatchOutputStrides[iModel] = static_cast<int64_t>(scores.size()) / nRows;
+      if (mBatchOutputStrides[iModel] < mNClasses) {
+        LOG(fatal) << "Model " << iModel << " returns " << mBatchOutputStrides[iModel] << " values per candidate, less than the number of classes (" << static_cast<int>(mNClasses) << ")! Please check your configurables.";
       }
-      ++iClass;
     }
-    return true;
+  }
+
+  /// Get the model output of a candidate in the batch
+  /// \param iCand is the index returned by addToBatch()
+  /// \return span over the scores of each class
+  std::span<const TypeOutputScore> getBatchOutput(int iCand) const
+  {
+    const auto& entry = mBatchEntries[iCand];
+    const auto& scores = mBatchOutputs[entry.nModel];
+    return std::span<const TypeOutputScore>(scores.data() + entry.row * mBatchOutputStrides[entry.nModel], mNClasses);
+  }
+
+  /// ML selections for a candidate in the batch
+  /// \param iCand is the index returned by addToBatch()
+  /// \param output is a container to be filled with model output
+  /// \return boolean telling if model predictions pass the cuts
+  bool isSelectedMlBatch(int iCand, std::vector<TypeOutputScore>& output) const
+  {
+    auto scores = getBatchOutput(iCand);
+    output.assign(scores.begin(), scores.end());
+    return isPassingCuts(scores.data(), mBatchEntries[iCand].nModel);
   }
 
  protected:
@@ -214,6 +276,36 @@ class MlResponse
   virtual void setAvailableInputFeatures() { return; } // method to fill the map of available input features
 
  private:
+  struct BatchEntry {
+    int16_t nModel; // model (bin) index
+    int64_t row;    // row of the candidate in the model arena
+  };
+  std::vector<std::vector<TypeInputFeature>> mBatchInputs; // contiguous input features, one arena for each model
+  std::vector<std::vector<TypeOutputScore>> mBatchOutputs; // model outputs, one block for each model
+  std::vector<int64_t> mBatchOutputStrides;                // number of output values per row, one for each model
+  std::vector<int64_t> mBatchRows;                         // number of batched candidates, one for each model
+  std::vector<BatchEntry> mBatchEntries;                   // position of each batched candidate in the arenas
+
+  /// Apply the cuts on the model scores
+  /// \param scores pointer to mNClasses scores
+  /// \param nModel is the model index
+  /// \return boolean telling if model predictions pass the cuts
+  bool isPassingCuts(const TypeOutputScore* scores, int nModel) const
+  {
+    for (uint8_t iClass{0}; iClass < mNClasses; ++iClass) {
+      uint8_t dir = mCutDir.at(iClass);
+      if (dir != o2::cuts_ml::CutDirection::CutNot) {
+        if (dir == o2::cuts_ml::CutDirection::CutGreater && scores[iClass] > mCuts.get(nModel, iClass)) {
+          return false;
+        }
+        if (dir == o2::cuts_ml::CutDirection::CutSmaller && scores[iClass] < mCuts.get(nModel, iClass)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
   /// Finds matching bin in mBinsLimits
   /// \param value e.g. pT
   /// \return index of the matching bin, used to access mModels
@@ -88,6 +88,40 @@ class OnnxModel
     return evalModel<T>(inputTensors);
   }
 
+  /// Evaluate the model on a contiguous block of feature rows with a single session call
+  /// \param input pointer to nRows * getNumInputNodes() values, row-major
+  /// \param nRows number of rows (candidates) in the block
+  /// \param output buffer filled with the last output tensor, all its values for the nRows rows
+  /// \return true if the inference succeeded
+  template <typename TInput, typename TOutput>
+  bool evalModelBatch(TInput* input, int64_t nRows, std::vector<TOutput>& output)
+  {
+    output.clear();
+    if (nRows <= 0) {
+      return true;
+    }
+    const int64_t nFeatures = mInputShapes[0][1];
+    std::vector<int64_t> inputShape{nRows, nFeatures};
+    std::vector<Ort::Value> inputTensors;
+    inputTensors.emplace_back(Ort::Experimental::Value::CreateTensor<TInput>(input, nRows * nFeatures, inputShape));
+    LOG(debug) << "Batch input shape: " << printShape(inputShape);
+
+    try {
+      auto outputTensors = mSession->Run(mInputNames, inputTensors, mOutputNames);
+      if (outputTensors.size() != mOutputNames.size()) {
+        LOG(fatal) << "Number of output tensors: " << outputTensors.size() << " does not agree with the model specified size: " << mOutputNames.size();
+      }
+      // copy out the values, the output tensors only live within this scope
+      const std::size_t nValues = outputTensors.back().GetTensorTypeAndShapeInfo().GetElementCount();
+      const TOutput* outputValues = outputTensors.back().GetTensorMutableData<TOutput>();
+      output.assign(outputValues, outputValues + nValues);
+      return true;
+    } catch (const Ort::Exception& exception) {
+      LOG(error) << "Error running batched model inference: " << exception.what();
+    }
+    return false;
+  }
+
   // Reset session
   void resetSession() { mSession.reset(new Ort::Experimental::Session{*mEnv, modelPath, sessionOptions}); }
 